@@ -0,0 +1,177 @@
+#include "BindlessTable.h"
+#include <algorithm>
+
+namespace one {
+	BindlessTable::BindlessTable(Device* pDevice) : pDevice(pDevice), _device(pDevice->getDevice()) {
+		initialize();
+	}
+
+	void BindlessTable::initialize() {
+		//*************************************************************************************
+		//the arrays have to fit the set and every stage, a combined image sampler counts as a sampled image and a sampler
+		const VkPhysicalDeviceDescriptorIndexingPropertiesEXT& limits = pDevice->getDescriptorIndexingProperties();
+		textureCapacity = std::min({ MAX_TEXTURES, limits.maxDescriptorSetUpdateAfterBindSampledImages, limits.maxDescriptorSetUpdateAfterBindSamplers,
+			limits.maxPerStageDescriptorUpdateAfterBindSampledImages, limits.maxPerStageDescriptorUpdateAfterBindSamplers });
+		bufferCapacity = std::min({ MAX_BUFFERS, limits.maxDescriptorSetUpdateAfterBindStorageBuffers,
+			limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers });
+		//both arrays count against the resources of a stage, buffers(the world's data) are kept first
+		uint32_t resources = limits.maxPerStageUpdateAfterBindResources > RESERVED_RESOURCES ? limits.maxPerStageUpdateAfterBindResources - RESERVED_RESOURCES : 0;
+		bufferCapacity = std::min(bufferCapacity, resources);
+		textureCapacity = std::min(textureCapacity, resources - bufferCapacity);
+		if (bufferCapacity == 0) {
+			throw std::runtime_error("failed to fit the bindless table in the descriptor limits of the device!");
+		}
+
+		//*************************************************************************************
+		//both arrays are seen by every graphics stage, the pipeline layout decides nothing per draw
+		VkDescriptorSetLayoutBinding bindings[2]{};
+		bindings[TEXTURE_BINDING].binding = TEXTURE_BINDING;
+		bindings[TEXTURE_BINDING].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		bindings[TEXTURE_BINDING].descriptorCount = textureCapacity;
+		bindings[TEXTURE_BINDING].stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS;
+		bindings[BUFFER_BINDING].binding = BUFFER_BINDING;
+		bindings[BUFFER_BINDING].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[BUFFER_BINDING].descriptorCount = bufferCapacity;
+		bindings[BUFFER_BINDING].stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS;
+
+		//written while command buffers using the set are recorded or pending, empty slots are never read
+		VkDescriptorBindingFlagsEXT bindingFlags[2];
+		for (VkDescriptorBindingFlagsEXT& flags : bindingFlags) {
+			flags = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT |
+				VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT;
+		}
+		VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo{};
+		bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+		bindingFlagsInfo.bindingCount = 2;
+		bindingFlagsInfo.pBindingFlags = bindingFlags;
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.pNext = &bindingFlagsInfo;
+		layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+		layoutInfo.bindingCount = 2;
+		layoutInfo.pBindings = bindings;
+
+		if (vkCreateDescriptorSetLayout(_device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create bindless descriptor set layout!");
+		}
+
+		//*************************************************************************************
+		//a single set for the whole program
+		VkDescriptorPoolSize poolSizes[] = {
+			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, textureCapacity },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, bufferCapacity }
+		};
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+		poolInfo.maxSets = 1;
+		//a pool size of 0 is not allowed
+		poolInfo.poolSizeCount = textureCapacity > 0 ? 2 : 1;
+		poolInfo.pPoolSizes = poolSizes;
+
+		if (vkCreateDescriptorPool(_device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create bindless descriptor pool!");
+		}
+
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = descriptorPool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &descriptorSetLayout;
+
+		if (vkAllocateDescriptorSets(_device, &allocInfo, &descriptorSet) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate bindless descriptor set!");
+		}
+
+		std::cerr << "bindless table has initiated with " << textureCapacity << " textures and " << bufferCapacity << " buffers \n";
+	}
+
+	uint32_t BindlessTable::allocateSlot(Slots& slots, uint32_t capacity) {
+		if (!slots.freeIndices.empty()) {
+			uint32_t index = slots.freeIndices.back();
+			slots.freeIndices.pop_back();
+			return index;
+		}
+		if (slots.next == capacity) {
+			throw std::runtime_error("failed to find a free bindless table slot!");
+		}
+		return slots.next++;
+	}
+
+	uint32_t BindlessTable::addTexture(VkImageView imageView, VkSampler sampler) {
+		std::lock_guard<std::mutex> lock(mutex);
+		uint32_t index = allocateSlot(textureSlots, textureCapacity);
+
+		VkDescriptorImageInfo imageInfo{};
+		imageInfo.sampler = sampler;
+		imageInfo.imageView = imageView;
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = descriptorSet;
+		write.dstBinding = TEXTURE_BINDING;
+		write.dstArrayElement = index;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		write.pImageInfo = &imageInfo;
+		vkUpdateDescriptorSets(_device, 1, &write, 0, nullptr);
+		return index;
+	}
+
+	uint32_t BindlessTable::addBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+		std::lock_guard<std::mutex> lock(mutex);
+		uint32_t index = allocateSlot(bufferSlots, bufferCapacity);
+
+		VkDescriptorBufferInfo bufferInfo{};
+		bufferInfo.buffer = buffer;
+		bufferInfo.offset = offset;
+		bufferInfo.range = range;
+
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = descriptorSet;
+		write.dstBinding = BUFFER_BINDING;
+		write.dstArrayElement = index;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		write.pBufferInfo = &bufferInfo;
+		vkUpdateDescriptorSets(_device, 1, &write, 0, nullptr);
+		return index;
+	}
+
+	//the descriptor is left as it is, partially bound slots only have to be valid when a shader picks them
+	void BindlessTable::removeTexture(uint32_t index) {
+		std::lock_guard<std::mutex> lock(mutex);
+		assert(index < textureSlots.next);
+		textureSlots.freeIndices.push_back(index);
+	}
+
+	void BindlessTable::removeBuffer(uint32_t index) {
+		std::lock_guard<std::mutex> lock(mutex);
+		assert(index < bufferSlots.next);
+		bufferSlots.freeIndices.push_back(index);
+	}
+
+	void BindlessTable::bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout) const {
+		vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+	}
+
+	void BindlessTable::destroy() {
+		//frees the set
+		if (descriptorPool != VK_NULL_HANDLE) {
+			vkDestroyDescriptorPool(_device, descriptorPool, nullptr);
+			descriptorPool = VK_NULL_HANDLE;
+			descriptorSet = VK_NULL_HANDLE;
+		}
+		if (descriptorSetLayout != VK_NULL_HANDLE) {
+			vkDestroyDescriptorSetLayout(_device, descriptorSetLayout, nullptr);
+			descriptorSetLayout = VK_NULL_HANDLE;
+		}
+	}
+
+	BindlessTable::~BindlessTable() {
+		destroy();
+	}
+}
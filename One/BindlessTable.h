@@ -0,0 +1,87 @@
+#pragma once
+#include "UtilHeader.h"
+#include <mutex>
+#include "Device.h"
+
+namespace one {
+	//one descriptor set with every texture and buffer the graphics shaders can read, bound once per command buffer
+	//shaders pick resources by their index in the table(passed in push constants), draws never bind descriptors
+	//built on VK_EXT_descriptor_indexing: slots are written while the set is bound(update after bind)
+	//and slots nothing has been written to are allowed as long as no shader picks them(partially bound)
+	class BindlessTable : NonCopyable
+	{
+	public:
+
+		//bindings of set 0 in the shaders, each an array indexed by the table index
+		static const uint32_t TEXTURE_BINDING = 0;
+		static const uint32_t BUFFER_BINDING = 1;
+
+		//most the arrays hold, initialize cuts them down to the device's update after bind limits
+		static const uint32_t MAX_TEXTURES = 4096;
+		static const uint32_t MAX_BUFFERS = 1024;
+		//resources of every stage kept out of the table for the other sets and the attachments
+		static const uint32_t RESERVED_RESOURCES = 16;
+
+		BindlessTable(Device* pDevice);
+		~BindlessTable();
+
+		void initialize();
+		void destroy();
+
+		//combined image sampler read in SHADER_READ_ONLY_OPTIMAL, returns its index in the texture array
+		uint32_t addTexture(VkImageView imageView, VkSampler sampler);
+		//storage buffer range, returns its index in the buffer array
+		uint32_t addBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range);
+		//the index is given out again by the next add, no submitted work may still pick it
+		void removeTexture(uint32_t index);
+		void removeBuffer(uint32_t index);
+
+		//binds the table as set 0 of pipelineLayout
+		void bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout) const;
+
+		inline VkDescriptorSetLayout getDescriptorSetLayout(void) const {
+			return descriptorSetLayout;
+		}
+
+		inline VkDescriptorSet getDescriptorSet(void) const {
+			return descriptorSet;
+		}
+
+		//slots of each array on this device
+		inline uint32_t getTextureCapacity(void) const {
+			return textureCapacity;
+		}
+
+		inline uint32_t getBufferCapacity(void) const {
+			return bufferCapacity;
+		}
+
+	private:
+
+		//indices handed out in order, removed ones are reused first
+		struct Slots {
+			uint32_t next = 0;
+			std::vector<uint32_t> freeIndices;
+		};
+
+		uint32_t allocateSlot(Slots& slots, uint32_t capacity);
+
+		Device* pDevice;
+
+		VkDevice _device;
+
+		uint32_t textureCapacity = 0;
+		uint32_t bufferCapacity = 0;
+
+		VkDescriptorSetLayout descriptorSetLayout{ VK_NULL_HANDLE };
+		VkDescriptorPool descriptorPool{ VK_NULL_HANDLE };
+		VkDescriptorSet descriptorSet{ VK_NULL_HANDLE };
+
+		Slots textureSlots;
+		Slots bufferSlots;
+
+		//resources may be added from loading threads
+		std::mutex mutex;
+
+	};
+}
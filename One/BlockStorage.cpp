@@ -0,0 +1,194 @@
+#include "BlockStorage.h"
+#include <algorithm>
+#include <cassert>
+
+namespace one {
+	BlockStorage::BlockStorage(uint32_t blockCount) {
+		initialize(blockCount);
+	}
+
+	void BlockStorage::initialize(uint32_t count) {
+		blockCount = count;
+		fill(BLOCK_AIR);
+	}
+
+	uint32_t BlockStorage::getBitsFor(size_t paletteSize) {
+		if (paletteSize <= 1) {
+			return 0;
+		}
+		uint32_t bits = 1;
+		while ((static_cast<size_t>(1) << bits) < paletteSize) {
+			bits *= 2;
+		}
+		return bits;
+	}
+
+	uint32_t BlockStorage::findOrAdd(BlockId block) {
+		//a chunk has a handful of blocks, a linear search beats a map
+		for (size_t i = 0; i < palette.size(); i++) {
+			if (palette[i] == block) {
+				return static_cast<uint32_t>(i);
+			}
+		}
+		palette.push_back(block);
+		uint32_t bits = getBitsFor(palette.size());
+		if (bits > bitsPerIndex) {
+			repack(bits);
+		}
+		return static_cast<uint32_t>(palette.size() - 1);
+	}
+
+	void BlockStorage::repack(uint32_t bits) {
+		assert(bits <= 16);
+		std::vector<uint64_t> newWords((static_cast<uint64_t>(blockCount) * bits + 63) / 64, 0);
+		uint32_t newShift = 0;
+		while ((1u << newShift) < bits) {
+			newShift++;
+		}
+		//a uniform storage has nothing to move, every index is 0
+		if (bitsPerIndex != 0) {
+			for (uint32_t i = 0; i < blockCount; i++) {
+				uint32_t bit = i << newShift;
+				newWords[bit >> 6] |= static_cast<uint64_t>(getIndex(i)) << (bit & 63);
+			}
+		}
+		words.swap(newWords);
+		bitsPerIndex = bits;
+		indexShift = newShift;
+		indexMask = bits == 0 ? 0 : (static_cast<uint64_t>(1) << bits) - 1;
+	}
+
+	void BlockStorage::set(uint32_t index, BlockId block) {
+		assert(index < blockCount);
+		if (bitsPerIndex == 0 && palette[0] == block) {
+			return;
+		}
+		uint32_t paletteIndex = findOrAdd(block);
+		setIndex(index, paletteIndex);
+	}
+
+	void BlockStorage::getRange(uint32_t first, uint32_t count, BlockId* pBlocks) const {
+		assert(first + count <= blockCount);
+		if (bitsPerIndex == 0) {
+			std::fill(pBlocks, pBlocks + count, palette[0]);
+			return;
+		}
+		uint32_t indicesPerWord = 64 >> indexShift;
+		uint32_t i = 0;
+		//one by one up to the first word boundary
+		for (; i < count && ((first + i) & (indicesPerWord - 1)) != 0; i++) {
+			pBlocks[i] = palette[getIndex(first + i)];
+		}
+		//whole words, no per block address math
+		for (; i + indicesPerWord <= count; i += indicesPerWord) {
+			uint64_t word = words[(first + i) >> (6 - indexShift)];
+			for (uint32_t k = 0; k < indicesPerWord; k++) {
+				pBlocks[i + k] = palette[word & indexMask];
+				word >>= bitsPerIndex;
+			}
+		}
+		for (; i < count; i++) {
+			pBlocks[i] = palette[getIndex(first + i)];
+		}
+	}
+
+	void BlockStorage::setRange(uint32_t first, uint32_t count, const BlockId* pBlocks) {
+		assert(first + count <= blockCount);
+		BlockId runBlock = BLOCK_AIR;
+		uint32_t runIndex = 0;
+		for (uint32_t i = 0; i < count; i++) {
+			if (i == 0 || pBlocks[i] != runBlock) {
+				runBlock = pBlocks[i];
+				//may widen the indices, palette indices stay the same when it does
+				runIndex = findOrAdd(runBlock);
+			}
+			if (bitsPerIndex != 0) {
+				setIndex(first + i, runIndex);
+			}
+		}
+	}
+
+	void BlockStorage::assign(const BlockId* pBlocks) {
+		palette.clear();
+		BlockId runBlock = BLOCK_AIR;
+		for (uint32_t i = 0; i < blockCount; i++) {
+			if ((i == 0 || pBlocks[i] != runBlock) && std::find(palette.begin(), palette.end(), pBlocks[i]) == palette.end()) {
+				palette.push_back(pBlocks[i]);
+			}
+			runBlock = pBlocks[i];
+		}
+		palette.shrink_to_fit();
+
+		//sized once for the final palette, nothing is repacked on the way
+		bitsPerIndex = 0;
+		words.clear();
+		repack(getBitsFor(palette.size()));
+		if (bitsPerIndex == 0) {
+			return;
+		}
+		uint32_t runIndex = 0;
+		for (uint32_t i = 0; i < blockCount; i++) {
+			if (i == 0 || pBlocks[i] != pBlocks[i - 1]) {
+				runIndex = static_cast<uint32_t>(std::find(palette.begin(), palette.end(), pBlocks[i]) - palette.begin());
+			}
+			setIndex(i, runIndex);
+		}
+	}
+
+	void BlockStorage::fill(BlockId block) {
+		palette.assign(1, block);
+		palette.shrink_to_fit();
+		words.clear();
+		words.shrink_to_fit();
+		bitsPerIndex = 0;
+		indexShift = 0;
+		indexMask = 0;
+	}
+
+	bool BlockStorage::isFilledWith(BlockId block) const {
+		if (bitsPerIndex == 0) {
+			return palette[0] == block;
+		}
+		auto entry = std::find(palette.begin(), palette.end(), block);
+		if (entry == palette.end()) {
+			return false;
+		}
+		//every index of a word set to the block's
+		uint64_t paletteIndex = static_cast<uint64_t>(entry - palette.begin());
+		uint64_t pattern = 0;
+		for (uint32_t bit = 0; bit < 64; bit += bitsPerIndex) {
+			pattern |= paletteIndex << bit;
+		}
+		uint64_t bitCount = static_cast<uint64_t>(blockCount) * bitsPerIndex;
+		size_t wholeWords = static_cast<size_t>(bitCount / 64);
+		for (size_t i = 0; i < wholeWords; i++) {
+			if (words[i] != pattern) {
+				return false;
+			}
+		}
+		uint64_t remainingBits = bitCount & 63;
+		if (remainingBits != 0) {
+			uint64_t mask = (static_cast<uint64_t>(1) << remainingBits) - 1;
+			return (words[wholeWords] & mask) == (pattern & mask);
+		}
+		return true;
+	}
+
+	size_t BlockStorage::getByteSize(void) const {
+		return palette.capacity() * sizeof(BlockId) + words.capacity() * sizeof(uint64_t);
+	}
+
+	void BlockStorage::destroy() {
+		palette.clear();
+		palette.shrink_to_fit();
+		words.clear();
+		words.shrink_to_fit();
+		bitsPerIndex = 0;
+		indexShift = 0;
+		indexMask = 0;
+	}
+
+	BlockStorage::~BlockStorage() {
+		destroy();
+	}
+}
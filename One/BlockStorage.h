@@ -0,0 +1,99 @@
+#pragma once
+#include "NonCopyable.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace one {
+	//block type stored per voxel, 0 is air(empty)
+	typedef uint8_t BlockId;
+
+	enum Blocks : BlockId {
+		BLOCK_AIR = 0,
+		BLOCK_GRASS = 1,
+		BLOCK_DIRT = 2,
+		BLOCK_STONE = 3
+	};
+
+	//palette compressed blocks: every distinct block once in a palette, and a bit packed palette index per block
+	//indices take 1, 2, 4, 8 or 16 bits(a power of two, so none straddles two words) and are widened and repacked when the palette outgrows them
+	//a storage of one block only keeps that block, no indices at all
+	//terrain has a handful of blocks, so a chunk takes 2 bits per block instead of 8(and a few bytes if it is all air or all stone)
+	//not thread safe, reads from several threads are fine while nothing writes
+	class BlockStorage : NonCopyable
+	{
+	public:
+
+		//all air
+		BlockStorage(uint32_t blockCount);
+		~BlockStorage();
+
+		void initialize(uint32_t blockCount);
+		void destroy();
+
+		inline BlockId get(uint32_t index) const {
+			if (bitsPerIndex == 0) {
+				return palette[0];
+			}
+			return palette[getIndex(index)];
+		}
+
+		void set(uint32_t index, BlockId block);
+
+		//decodes count blocks from first on, a whole word of indices at a time
+		void getRange(uint32_t first, uint32_t count, BlockId* pBlocks) const;
+		//looks the palette up once per run of the same block
+		void setRange(uint32_t first, uint32_t count, const BlockId* pBlocks);
+		//replaces every block, the palette only keeps the blocks that are used and the indices are as narrow as they can be
+		void assign(const BlockId* pBlocks);
+		//sets every block to one and frees the indices
+		void fill(BlockId block);
+
+		//compares whole words of indices, no block is decoded
+		bool isFilledWith(BlockId block) const;
+
+		inline uint32_t getBitsPerIndex(void) const {
+			return bitsPerIndex;
+		}
+
+		//can hold blocks that are no longer used after set, assign drops them
+		inline size_t getPaletteSize(void) const {
+			return palette.size();
+		}
+
+		//memory the palette and the indices take
+		size_t getByteSize(void) const;
+
+	private:
+
+		//power of two bits that can index paletteSize entries, 0 for a single entry
+		static uint32_t getBitsFor(size_t paletteSize);
+
+		inline uint32_t getIndex(uint32_t index) const {
+			uint32_t bit = index << indexShift;
+			return static_cast<uint32_t>((words[bit >> 6] >> (bit & 63)) & indexMask);
+		}
+
+		inline void setIndex(uint32_t index, uint32_t paletteIndex) {
+			uint32_t bit = index << indexShift;
+			uint64_t& word = words[bit >> 6];
+			word = (word & ~(indexMask << (bit & 63))) | (static_cast<uint64_t>(paletteIndex) << (bit & 63));
+		}
+
+		//palette index of block, a new block is added(and the indices widened when they have to be)
+		uint32_t findOrAdd(BlockId block);
+		//packs every index again with bits per index
+		void repack(uint32_t bits);
+
+		uint32_t blockCount = 0;
+
+		std::vector<BlockId> palette;
+		std::vector<uint64_t> words;
+
+		uint32_t bitsPerIndex = 0;
+		//log2 of bitsPerIndex, a block's first bit is its index shifted by it
+		uint32_t indexShift = 0;
+		uint64_t indexMask = 0;
+
+	};
+}
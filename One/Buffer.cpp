@@ -0,0 +1,48 @@
+#include "Buffer.h"
+#include <set>
+
+namespace one {
+	Buffer::Buffer(Device* pDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred,
+		const std::vector<uint32_t>& queueFamilies) :
+		_device(pDevice->getDevice()), pDevice(pDevice) {
+		initialize(size, usage, required, preferred, queueFamilies);
+	}
+
+	void Buffer::initialize(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred,
+		const std::vector<uint32_t>& queueFamilies) {
+		Buffer::size = size;
+
+		VkBufferCreateInfo bufferInfo{};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = size;
+		bufferInfo.usage = usage;
+		//used by one queue family at a time, uploads on a transfer queue hand it over with an ownership transfer
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		//written on one queue and read on another every frame(async compute), transfers would cost a barrier on both sides
+		std::set<uint32_t> uniqueQueueFamilies(queueFamilies.begin(), queueFamilies.end());
+		std::vector<uint32_t> sharingQueueFamilies(uniqueQueueFamilies.begin(), uniqueQueueFamilies.end());
+		if (sharingQueueFamilies.size() > 1) {
+			bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+			bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(sharingQueueFamilies.size());
+			bufferInfo.pQueueFamilyIndices = sharingQueueFamilies.data();
+		}
+
+		if (vkCreateBuffer(_device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create buffer!");
+		}
+
+		allocation = pDevice->getMemoryAllocator()->allocateBuffer(buffer, required, preferred, MemoryAllocator::STRATEGY_BUDDY);
+	}
+
+	void Buffer::destroy() {
+		if (buffer != VK_NULL_HANDLE) {
+			vkDestroyBuffer(_device, buffer, nullptr);
+			buffer = VK_NULL_HANDLE;
+		}
+		pDevice->getMemoryAllocator()->free(allocation);
+	}
+
+	Buffer::~Buffer() {
+		destroy();
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "UtilHeader.h"
+#include "Device.h"
+
+namespace one {
+	//VkBuffer with memory from the device allocator
+	class Buffer : NonCopyable
+	{
+	public:
+
+		//queueFamilies: families that use the buffer at the same time(concurrent sharing, no ownership transfers)
+		//empty or a single family keeps it exclusive
+		Buffer(Device* pDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred,
+			const std::vector<uint32_t>& queueFamilies = {});
+		~Buffer();
+
+		void initialize(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred,
+			const std::vector<uint32_t>& queueFamilies);
+		void destroy();
+
+		inline VkBuffer getBuffer(void) const {
+			return buffer;
+		}
+
+		inline VkDeviceSize getSize(void) const {
+			return size;
+		}
+
+		//nullptr unless the memory is host visible
+		inline void* getMapped(void) const {
+			return allocation.pMapped;
+		}
+
+	private:
+
+		VkDevice _device;
+
+		Device* pDevice;
+
+		VkBuffer buffer{ VK_NULL_HANDLE };
+
+		VkDeviceSize size = 0;
+
+		MemoryAllocator::Allocation allocation;
+
+	};
+}
@@ -0,0 +1,32 @@
+#include "Camera.h"
+
+namespace one {
+	Camera::Camera(glm::vec3 position, glm::vec3 target, float fieldOfView) : position(position), target(target), fieldOfView(fieldOfView) {
+
+	}
+
+	glm::mat4 Camera::getViewProjection(float aspectRatio) const {
+		glm::mat4 view = glm::lookAt(position, target, glm::vec3(0.0f, 1.0f, 0.0f));
+		//swapping near and far reverses depth
+		glm::mat4 projection = glm::perspective(fieldOfView, aspectRatio, farPlane, nearPlane);
+		projection[1][1] *= -1.0f;
+		return projection * view;
+	}
+
+	std::array<glm::vec4, 6> Camera::getFrustumPlanes(const glm::mat4& viewProjection) {
+		//planes are sums of the clip matrix rows(glm is column major, row i is m[0][i]..m[3][i])
+		glm::vec4 rows[4];
+		for (int i = 0; i < 4; i++) {
+			rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+		}
+		//vulkan clip depth goes from 0 to w, reversed the far plane is the z row alone
+		return {
+			rows[3] + rows[0],
+			rows[3] - rows[0],
+			rows[3] + rows[1],
+			rows[3] - rows[1],
+			rows[3] - rows[2],
+			rows[2]
+		};
+	}
+}
\ No newline at end of file
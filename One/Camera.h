@@ -0,0 +1,54 @@
+#pragma once
+#include "UtilHeader.h"
+#include <array>
+#include <cmath>
+
+namespace one {
+	//perspective camera looking from position at target
+	class Camera
+	{
+	public:
+
+		Camera(glm::vec3 position, glm::vec3 target, float fieldOfView);
+
+		//projection is flipped on y, vulkan clip space points y down
+		//depth is reversed: 1 at the near plane and 0 at the far plane, float depth keeps its precision far away that way
+		glm::mat4 getViewProjection(float aspectRatio) const;
+
+		//left, right, bottom, top, near, far planes of a reverse depth view projection(xyz points inside, w distance)
+		//a point p is inside a plane when dot(plane.xyz, p) + plane.w >= 0
+		static std::array<glm::vec4, 6> getFrustumPlanes(const glm::mat4& viewProjection);
+
+		inline glm::vec3 getPosition(void) const {
+			return position;
+		}
+
+		inline void setPosition(glm::vec3 newPosition) {
+			position = newPosition;
+		}
+
+		inline void setTarget(glm::vec3 newTarget) {
+			target = newTarget;
+		}
+
+		//vertical, in radians
+		inline float getFieldOfView(void) const {
+			return fieldOfView;
+		}
+
+		//height of a pixel one block in front of the camera, for a view imageHeight pixels high
+		inline float getPixelSpread(uint32_t imageHeight) const {
+			return 2.0f * std::tan(fieldOfView * 0.5f) / static_cast<float>(imageHeight);
+		}
+
+	private:
+
+		glm::vec3 position;
+		glm::vec3 target;
+		//vertical, in radians
+		float fieldOfView;
+		float nearPlane = 0.1f;
+		float farPlane = 1000.0f;
+
+	};
+}
@@ -0,0 +1,54 @@
+#include "Chunk.h"
+#include <cmath>
+#include <algorithm>
+
+namespace one {
+	Chunk::Chunk(ChunkCoordinate coordinate) : coordinate(coordinate), blocks(BLOCK_COUNT) {
+		initialize();
+	}
+
+	void Chunk::initialize() {
+		blocks.initialize(BLOCK_COUNT);
+	}
+
+	//rolling hills, height in blocks at world column (x, z)
+	static int32_t terrainHeight(int32_t x, int32_t z) {
+		float height = 24.0f
+			+ 8.0f * std::sin(x * 0.07f)
+			+ 6.0f * std::cos(z * 0.05f)
+			+ 3.0f * std::sin((x + z) * 0.13f);
+		return static_cast<int32_t>(std::floor(height));
+	}
+
+	void Chunk::generateTerrain() {
+		//written densely and packed once, setBlock would repack every time the palette grows
+		static thread_local std::vector<BlockId> dense(BLOCK_COUNT);
+		std::fill(dense.begin(), dense.end(), BLOCK_AIR);
+		glm::ivec3 origin = getOrigin();
+		for (int32_t z = 0; z < SIZE; z++) {
+			for (int32_t x = 0; x < SIZE; x++) {
+				int32_t height = terrainHeight(origin.x + x, origin.z + z);
+				//only the part of the column that falls inside this chunk
+				int32_t top = std::min(height - origin.y, SIZE);
+				for (int32_t y = 0; y < top; y++) {
+					int32_t depth = height - (origin.y + y);
+					BlockId block = depth == 1 ? BLOCK_GRASS : (depth <= 4 ? BLOCK_DIRT : BLOCK_STONE);
+					dense[index(x, y, z)] = block;
+				}
+			}
+		}
+		blocks.assign(dense.data());
+	}
+
+	bool Chunk::isEmpty(void) const {
+		return blocks.isFilledWith(BLOCK_AIR);
+	}
+
+	void Chunk::destroy() {
+		blocks.destroy();
+	}
+
+	Chunk::~Chunk() {
+		destroy();
+	}
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "UtilHeader.h"
+#include <cstdint>
+#include "BlockStorage.h"
+
+namespace one {
+	//position of a chunk in chunk units(world block position / Chunk::SIZE)
+	struct ChunkCoordinate {
+		int32_t x;
+		int32_t y;
+		int32_t z;
+
+		bool operator==(const ChunkCoordinate& other) const {
+			return x == other.x && y == other.y && z == other.z;
+		}
+	};
+
+	struct ChunkCoordinateHash {
+		size_t operator()(const ChunkCoordinate& coordinate) const {
+			//large primes spread neighbouring chunks over the buckets, multiplied unsigned so overflowing wraps instead of being undefined
+			return static_cast<size_t>(static_cast<uint32_t>(coordinate.x) * 73856093u) ^ static_cast<size_t>(static_cast<uint32_t>(coordinate.y) * 19349663u) ^
+				static_cast<size_t>(static_cast<uint32_t>(coordinate.z) * 83492791u);
+		}
+	};
+
+	//cube of SIZE^3 blocks, the unit the world is generated, meshed and drawn in
+	class Chunk : NonCopyable
+	{
+	public:
+
+		static const int32_t SIZE = 32;
+		static const uint32_t BLOCK_COUNT = SIZE * SIZE * SIZE;
+
+		Chunk(ChunkCoordinate coordinate);
+		~Chunk();
+
+		void initialize();
+		void destroy();
+
+		//fills the chunk from the world height function(same input always gives the same chunk)
+		void generateTerrain();
+
+		//x, y, z are local to the chunk(0 to SIZE - 1)
+		inline BlockId getBlock(int32_t x, int32_t y, int32_t z) const {
+			return blocks.get(index(x, y, z));
+		}
+
+		inline void setBlock(int32_t x, int32_t y, int32_t z, BlockId block) {
+			blocks.set(index(x, y, z), block);
+		}
+
+		//count blocks in index order from (x, y, z) on(x fastest, then z, then y), a row along x is SIZE blocks
+		//decodes them in bulk, much cheaper than a getBlock per block
+		inline void getBlocks(int32_t x, int32_t y, int32_t z, uint32_t count, BlockId* pBlocks) const {
+			blocks.getRange(index(x, y, z), count, pBlocks);
+		}
+
+		inline void setBlocks(int32_t x, int32_t y, int32_t z, uint32_t count, const BlockId* pBlocks) {
+			blocks.setRange(index(x, y, z), count, pBlocks);
+		}
+
+		//replaces all BLOCK_COUNT blocks at once and packs them as tightly as they go
+		inline void assignBlocks(const BlockId* pBlocks) {
+			blocks.assign(pBlocks);
+		}
+
+		inline void fillBlocks(BlockId block) {
+			blocks.fill(block);
+		}
+
+		inline ChunkCoordinate getCoordinate(void) const {
+			return coordinate;
+		}
+
+		//world position of block (0, 0, 0)
+		inline glm::ivec3 getOrigin(void) const {
+			return glm::ivec3(coordinate.x, coordinate.y, coordinate.z) * SIZE;
+		}
+
+		//true if every block is air(nothing to mesh)
+		bool isEmpty(void) const;
+
+		//memory the blocks take(palette and indices)
+		inline size_t getByteSize(void) const {
+			return blocks.getByteSize();
+		}
+
+	private:
+
+		//x fastest so rows along x are contiguous
+		static inline uint32_t index(int32_t x, int32_t y, int32_t z) {
+			return static_cast<uint32_t>((y * SIZE + z) * SIZE + x);
+		}
+
+		ChunkCoordinate coordinate;
+
+		BlockStorage blocks;
+
+	};
+}
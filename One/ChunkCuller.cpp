@@ -0,0 +1,265 @@
+#include "ChunkCuller.h"
+#include "ChunkMesh.h"
+#include "Chunk.h"
+#include "Camera.h"
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+
+namespace one {
+	//chunks the buffers of a target start with, they double when the world outgrows them
+	static const uint32_t INITIAL_CAPACITY = 64;
+
+	ChunkCuller::ChunkCuller(Device* pDevice, Queue* pComputeQueue, Queue* pGraphicsQueue, PipelineCache* pPipelineCache, const MeshArena* pMeshArena, uint32_t targetCount) :
+		pDevice(pDevice), _device(pDevice->getDevice()), pComputeQueue(pComputeQueue), pGraphicsQueue(pGraphicsQueue), pMeshArena(pMeshArena) {
+		initialize(pPipelineCache, targetCount);
+	}
+
+	void ChunkCuller::initialize(PipelineCache* pPipelineCache, uint32_t targetCount) {
+		//a single indirect call needs every chunk to pick its own instance data through firstInstance
+		if (pDevice->hasMultiDrawIndirect() && pDevice->hasDrawIndirectFirstInstance()) {
+			drawMode = pDevice->getCmdDrawIndexedIndirectCount() != nullptr ? DRAW_MODE_INDIRECT_COUNT : DRAW_MODE_MULTI_INDIRECT;
+		}
+		else {
+			drawMode = DRAW_MODE_PER_CHUNK;
+		}
+
+		//bounds, draw commands, draw count, occlusion data and the Hi-Z pyramid
+		pCullPipeline = new ComputePipeline(_device, "cull.comp.spv",
+			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE },
+			sizeof(CullConstants), MAX_TARGETS, pPipelineCache);
+		resize(targetCount);
+
+		static const char* drawModeNames[] = { "indirect count", "multi draw indirect", "per chunk indirect" };
+		std::cerr << "chunk culler has initiated with " << drawModeNames[drawMode] << " draws" << (pDevice->hasAsyncCompute() ? " on async compute \n" : " \n");
+	}
+
+	void ChunkCuller::resize(uint32_t targetCount) {
+		if (targetCount > MAX_TARGETS) {
+			throw std::runtime_error("failed to resize chunk culler, too many targets!");
+		}
+		while (targets.size() < targetCount) {
+			Target target{};
+			target.descriptorSet = pCullPipeline->allocateDescriptorSet();
+			target.pCommandBuffer = new CommandBuffer(_device, pComputeQueue->getCommandPool());
+			//timeline waits take a value, binary semaphores need one signal per wait
+			target.pCullFinished = pComputeQueue->hasTimeline() ? nullptr : new Semaphore(_device);
+			//zeroed by the compute queue before every culling that compacts
+			target.pDrawCount = new Buffer(pDevice, sizeof(uint32_t),
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0,
+				{ pComputeQueue->getFamilyIndex(), pGraphicsQueue->getFamilyIndex() });
+			target.pOcclusion = new Buffer(pDevice, sizeof(OcclusionData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				{ pComputeQueue->getFamilyIndex(), pGraphicsQueue->getFamilyIndex() });
+			reserve(target, INITIAL_CAPACITY);
+			targets.push_back(target);
+		}
+	}
+
+	void ChunkCuller::reserve(Target& target, uint32_t chunkCount) {
+		if (target.pDrawCommands != nullptr && chunkCount <= target.capacity) {
+			return;
+		}
+		uint32_t capacity = std::max(target.capacity, INITIAL_CAPACITY);
+		while (capacity < chunkCount) {
+			capacity *= 2;
+		}
+
+		if (target.pBounds != nullptr) {
+			target.pBounds->destroy();
+			delete target.pBounds;
+		}
+		if (target.pDrawCommands != nullptr) {
+			target.pDrawCommands->destroy();
+			delete target.pDrawCommands;
+		}
+
+		//read by compute and by the vertex shader, small enough to be written in place every time the meshes change
+		target.pBounds = new Buffer(pDevice, capacity * sizeof(ChunkBounds), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			{ pComputeQueue->getFamilyIndex(), pGraphicsQueue->getFamilyIndex() });
+		//concurrent between compute and graphics, the semaphore between the queues orders the accesses
+		target.pDrawCommands = new Buffer(pDevice, capacity * sizeof(VkDrawIndexedIndirectCommand),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0,
+			{ pComputeQueue->getFamilyIndex(), pGraphicsQueue->getFamilyIndex() });
+		target.capacity = capacity;
+		//bounds have to be written into the new buffer
+		target.meshVersion = 0;
+
+		pCullPipeline->writeDescriptorSet(target.descriptorSet,
+			{ target.pBounds->getBuffer(), target.pDrawCommands->getBuffer(), target.pDrawCount->getBuffer(), target.pOcclusion->getBuffer() });
+	}
+
+	void ChunkCuller::writeBounds(Target& target, const std::vector<ChunkMesh*>& pMeshes) {
+		ChunkBounds* pBounds = static_cast<ChunkBounds*>(target.pBounds->getMapped());
+		for (size_t i = 0; i < pMeshes.size(); i++) {
+			//whole chunk cube, the mesh never leaves it
+			glm::vec3 origin = glm::vec3(pMeshes[i]->getOrigin());
+			pBounds[i].minimum = glm::vec4(origin, 1.0f);
+			pBounds[i].maximum = glm::vec4(origin + glm::vec3(static_cast<float>(Chunk::SIZE)), 1.0f);
+			pBounds[i].indexCount = pMeshes[i]->getIndexCount();
+			pBounds[i].firstIndex = pMeshes[i]->getFirstIndex();
+			pBounds[i].vertexOffset = pMeshes[i]->getVertexOffset();
+			//per chunk draws bind the chunk's bounds as the whole instance buffer instead
+			pBounds[i].firstInstance = drawMode == DRAW_MODE_PER_CHUNK ? 0 : static_cast<uint32_t>(i);
+		}
+	}
+
+	void ChunkCuller::setHiZPyramid(uint32_t target, const HiZPyramid* pHiZPyramid) {
+		//the descriptor set may still be read by a pending culling, it is written at the next one
+		targets[target].pPendingHiZPyramid = pHiZPyramid;
+	}
+
+	void ChunkCuller::writeOcclusion(Target& target, const glm::mat4& viewProjection) {
+		//a new pyramid(resize) holds nothing until a frame of this target builds it
+		if (target.pHiZPyramid != target.pPendingHiZPyramid) {
+			assert(target.pPendingHiZPyramid != nullptr);
+			pCullPipeline->writeImage(target.descriptorSet, 4, target.pPendingHiZPyramid->getImageView(), VK_IMAGE_LAYOUT_GENERAL);
+			target.pHiZPyramid = target.pPendingHiZPyramid;
+			target.hiZBuilt = false;
+		}
+
+		OcclusionData* pOcclusion = static_cast<OcclusionData*>(target.pOcclusion->getMapped());
+		pOcclusion->viewProjection = target.viewProjection;
+		VkExtent2D pyramidExtent = target.pHiZPyramid->getExtent();
+		pOcclusion->pyramidSize = glm::ivec2(pyramidExtent.width, pyramidExtent.height);
+		pOcclusion->levelCount = target.hiZBuilt ? target.pHiZPyramid->getLevelCount() : 0;
+
+		//this culling's frame builds the pyramid with this camera
+		target.viewProjection = viewProjection;
+		target.hiZBuilt = true;
+	}
+
+	void ChunkCuller::cull(uint32_t target, const std::vector<ChunkMesh*>& pMeshes, uint64_t meshVersion, const glm::mat4& viewProjection) {
+		Target& cullTarget = targets[target];
+		uint32_t chunkCount = static_cast<uint32_t>(pMeshes.size());
+		std::array<glm::vec4, 6> frustumPlanes = Camera::getFrustumPlanes(viewProjection);
+
+		//the graphics frame that waited on the last culling of this target is done, so is that culling
+		reserve(cullTarget, chunkCount);
+		if (cullTarget.meshVersion != meshVersion) {
+			writeBounds(cullTarget, pMeshes);
+			cullTarget.meshVersion = meshVersion;
+		}
+		cullTarget.chunkCount = chunkCount;
+		writeOcclusion(cullTarget, viewProjection);
+
+		CullConstants cullConstants{};
+		std::memcpy(cullConstants.frustumPlanes, frustumPlanes.data(), sizeof(cullConstants.frustumPlanes));
+		cullConstants.chunkCount = chunkCount;
+		cullConstants.compact = drawMode == DRAW_MODE_INDIRECT_COUNT ? 1 : 0;
+
+		cullTarget.pCommandBuffer->reset();
+		cullTarget.pCommandBuffer->recordDispatch(pCullPipeline, cullTarget.descriptorSet, &cullConstants,
+			(chunkCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, cullConstants.compact ? cullTarget.pDrawCount->getBuffer() : VK_NULL_HANDLE);
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = cullTarget.pCommandBuffer->getCommandBufferPointer();
+		VkSemaphore signalSemaphores[] = { VK_NULL_HANDLE };
+		if (cullTarget.pCullFinished != nullptr) {
+			signalSemaphores[0] = cullTarget.pCullFinished->getSemaphore();
+			submitInfo.signalSemaphoreCount = 1;
+			submitInfo.pSignalSemaphores = signalSemaphores;
+		}
+		cullTarget.value = pComputeQueue->submit(submitInfo);
+	}
+
+	uint32_t ChunkCuller::getDrawCallCount(uint32_t target) const {
+		uint32_t chunkCount = targets[target].chunkCount;
+		if (drawMode == DRAW_MODE_PER_CHUNK) {
+			return chunkCount;
+		}
+		return chunkCount > 0 ? 1 : 0;
+	}
+
+	void ChunkCuller::recordDraws(VkCommandBuffer commandBuffer, uint32_t target, uint32_t firstDraw, uint32_t drawCount) const {
+		//an empty batch or a world without meshes yet
+		if (drawCount == 0) {
+			return;
+		}
+
+		const Target& drawTarget = targets[target];
+		VkBuffer instanceBuffer = drawTarget.pBounds->getBuffer();
+		VkBuffer drawCommands = drawTarget.pDrawCommands->getBuffer();
+		const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+
+		pMeshArena->bind(commandBuffer);
+
+		if (drawMode == DRAW_MODE_PER_CHUNK) {
+			//firstInstance is 0, the instance buffer starts at the chunk's bounds instead
+			for (uint32_t draw = firstDraw; draw < firstDraw + drawCount; draw++) {
+				VkDeviceSize offset = draw * sizeof(ChunkBounds);
+				vkCmdBindVertexBuffers(commandBuffer, 1, 1, &instanceBuffer, &offset);
+				vkCmdDrawIndexedIndirect(commandBuffer, drawCommands, draw * stride, 1, stride);
+			}
+			return;
+		}
+
+		//every chunk of the target in one call
+		assert(firstDraw == 0 && drawCount == 1);
+		VkDeviceSize offset = 0;
+		vkCmdBindVertexBuffers(commandBuffer, 1, 1, &instanceBuffer, &offset);
+		if (drawMode == DRAW_MODE_INDIRECT_COUNT) {
+			pDevice->getCmdDrawIndexedIndirectCount()(commandBuffer, drawCommands, 0, drawTarget.pDrawCount->getBuffer(), 0,
+				drawTarget.chunkCount, stride);
+		}
+		else {
+			vkCmdDrawIndexedIndirect(commandBuffer, drawCommands, 0, drawTarget.chunkCount, stride);
+		}
+	}
+
+	VkVertexInputBindingDescription ChunkCuller::getInstanceBindingDescription() {
+		VkVertexInputBindingDescription bindingDescription{};
+		bindingDescription.binding = 1;
+		bindingDescription.stride = sizeof(ChunkBounds);
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+		return bindingDescription;
+	}
+
+	VkVertexInputAttributeDescription ChunkCuller::getInstanceAttributeDescription() {
+		//inChunkOrigin of shader.vert, the chunk's mesh is relative to the minimum of its bounds
+		VkVertexInputAttributeDescription attributeDescription{};
+		attributeDescription.binding = 1;
+		attributeDescription.location = 1;
+		attributeDescription.format = VK_FORMAT_R32G32B32_SFLOAT;
+		attributeDescription.offset = offsetof(ChunkBounds, minimum);
+		return attributeDescription;
+	}
+
+	void ChunkCuller::destroy() {
+		//owner waits for the device to be idle first
+		for (Target& target : targets) {
+			target.pBounds->destroy();
+			delete target.pBounds;
+			target.pDrawCommands->destroy();
+			delete target.pDrawCommands;
+			target.pDrawCount->destroy();
+			delete target.pDrawCount;
+			target.pOcclusion->destroy();
+			delete target.pOcclusion;
+			if (target.pCullFinished != nullptr) {
+				target.pCullFinished->destroy();
+				delete target.pCullFinished;
+			}
+			//freed with the command pool
+			delete target.pCommandBuffer;
+		}
+		targets.clear();
+
+		//descriptor sets are freed with its pool
+		if (pCullPipeline != nullptr) {
+			pCullPipeline->destroy();
+			delete pCullPipeline;
+			pCullPipeline = nullptr;
+		}
+	}
+
+	ChunkCuller::~ChunkCuller() {
+		destroy();
+	}
+}
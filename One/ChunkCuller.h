@@ -0,0 +1,165 @@
+#pragma once
+#include "UtilHeader.h"
+#include <array>
+#include "Buffer.h"
+#include "CommandBuffer.h"
+#include "ComputePipeline.h"
+#include "HiZPyramid.h"
+#include "MeshArena.h"
+#include "Queue.h"
+#include "Semaphore.h"
+
+namespace one {
+	class ChunkMesh;
+
+	//frustum culls the chunks on the compute queue and writes their VkDrawIndexedIndirectCommands,
+	//graphics draws every chunk in the mesh arena from them after waiting on the culling
+	//with a compute only family this runs next to the graphics queue drawing the previous frame
+	//every target(swapchain image or frame slot) has its own buffers, only one target is culled per frame
+	//chunks inside the frustum are also tested against the Hi-Z pyramid of the last frame drawn into the same target,
+	//reprojected with that frame's camera, so a chunk that just came out from behind something shows up a frame late
+	class ChunkCuller : NonCopyable
+	{
+	public:
+
+		//matches ChunkBounds in cull.comp, also the per instance vertex input of shader.vert(the origin is minimum)
+		struct ChunkBounds {
+			glm::vec4 minimum;
+			glm::vec4 maximum;
+			uint32_t indexCount;
+			//where the mesh lives in the arena
+			uint32_t firstIndex;
+			int32_t vertexOffset;
+			//bounds the draw reads its chunk origin from
+			uint32_t firstInstance;
+		};
+
+		//matches CullConstants in cull.comp
+		struct CullConstants {
+			glm::vec4 frustumPlanes[6];
+			uint32_t chunkCount;
+			//visible chunks are packed to the front and counted
+			uint32_t compact;
+		};
+
+		//matches Occlusion in cull.comp(std140)
+		struct OcclusionData {
+			//camera the pyramid was drawn with
+			glm::mat4 viewProjection;
+			glm::ivec2 pyramidSize;
+			//0 while the pyramid has not been built yet, occlusion is skipped
+			uint32_t levelCount;
+			uint32_t padding;
+		};
+
+		//how the culled commands are drawn, picked from what the device supports
+		enum DrawMode {
+			//one vkCmdDrawIndexedIndirectCount, only visible chunks have a command
+			DRAW_MODE_INDIRECT_COUNT,
+			//one vkCmdDrawIndexedIndirect over every chunk, culled ones draw 0 instances
+			DRAW_MODE_MULTI_INDIRECT,
+			//one vkCmdDrawIndexedIndirect per chunk with its bounds bound as the instance buffer,
+			//for gpus without multiDrawIndirect or drawIndirectFirstInstance
+			DRAW_MODE_PER_CHUNK
+		};
+
+		//local_size_x of cull.comp
+		static const uint32_t WORKGROUP_SIZE = 64;
+		//descriptor sets the pipeline pool holds, swapchains dont get close to this many images
+		static const uint32_t MAX_TARGETS = 16;
+
+		ChunkCuller(Device* pDevice, Queue* pComputeQueue, Queue* pGraphicsQueue, PipelineCache* pPipelineCache, const MeshArena* pMeshArena, uint32_t targetCount);
+		~ChunkCuller();
+
+		void initialize(PipelineCache* pPipelineCache, uint32_t targetCount);
+		void destroy();
+
+		//adds targets up to targetCount(a recreated swapchain can have more images), never shrinks
+		void resize(uint32_t targetCount);
+
+		//pyramid target's draws build after their render pass, used from the next culling of target on
+		//every target needs one before it is culled, it has to stay alive until another one replaces it and that culling finished
+		void setHiZPyramid(uint32_t target, const HiZPyramid* pHiZPyramid);
+
+		//culls pMeshes into target's draw commands for a frame drawn with viewProjection, every mesh has to live in the mesh arena
+		//meshVersion has to change whenever pMeshes does, bounds are only written again then
+		//graphics work that read target's commands before must be finished
+		void cull(uint32_t target, const std::vector<ChunkMesh*>& pMeshes, uint64_t meshVersion, const glm::mat4& viewProjection);
+
+		//draw calls recordDraws splits target's draws into, only the per chunk mode has more than one
+		uint32_t getDrawCallCount(uint32_t target) const;
+
+		//binds the arena and instance buffer and records draw calls firstDraw to firstDraw + drawCount of target
+		//the graphics pipeline and its push constants have to be bound already
+		void recordDraws(VkCommandBuffer commandBuffer, uint32_t target, uint32_t firstDraw, uint32_t drawCount) const;
+
+		//binding 1 of shader.vert, one ChunkBounds per instance
+		static VkVertexInputBindingDescription getInstanceBindingDescription();
+		static VkVertexInputAttributeDescription getInstanceAttributeDescription();
+
+		//the graphics submit drawing target has to wait on its culling
+		//timeline semaphores: a wait on the compute queue value
+		inline Queue::TimelineWait getTimelineWait(uint32_t target) const {
+			return { pComputeQueue, targets[target].value, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT };
+		}
+
+		//binary fallback: signaled by every cull of target, must be waited on exactly once after it
+		inline VkSemaphore getCullFinished(uint32_t target) const {
+			return targets[target].pCullFinished->getSemaphore();
+		}
+
+		inline DrawMode getDrawMode() const {
+			return drawMode;
+		}
+
+	private:
+
+		struct Target {
+			//host visible, written by the cpu when the meshes change, read by compute and as instance data
+			Buffer* pBounds;
+			//written by compute and read by graphics(shared by both families)
+			Buffer* pDrawCommands;
+			//visible chunks of the last culling when compacting
+			Buffer* pDrawCount;
+			//host visible OcclusionData, written before every culling
+			Buffer* pOcclusion;
+			//pyramid the descriptor set points at, and the one it will point at from the next culling
+			const HiZPyramid* pHiZPyramid;
+			const HiZPyramid* pPendingHiZPyramid;
+			//the frame of the last culling built the bound pyramid
+			bool hiZBuilt;
+			//camera of the last culling
+			glm::mat4 viewProjection;
+			uint32_t capacity;
+			uint32_t chunkCount;
+			uint64_t meshVersion;
+			VkDescriptorSet descriptorSet;
+			CommandBuffer* pCommandBuffer;
+			//nullptr with timeline semaphores
+			Semaphore* pCullFinished;
+			//compute queue value of the last culling
+			uint64_t value;
+		};
+
+		//makes room for chunkCount chunks, the target must be idle
+		void reserve(Target& target, uint32_t chunkCount);
+		void writeBounds(Target& target, const std::vector<ChunkMesh*>& pMeshes);
+		//points the target at its pending pyramid and writes the occlusion data of this culling
+		void writeOcclusion(Target& target, const glm::mat4& viewProjection);
+
+		Device* pDevice;
+		VkDevice _device;
+
+		Queue* pComputeQueue;
+		Queue* pGraphicsQueue;
+
+		const MeshArena* pMeshArena;
+
+		ComputePipeline* pCullPipeline{ nullptr };
+
+		DrawMode drawMode = DRAW_MODE_PER_CHUNK;
+
+		std::vector<Target> targets;
+
+	};
+}
@@ -0,0 +1,24 @@
+#include "ChunkMesh.h"
+
+namespace one {
+	ChunkMesh::ChunkMesh(MeshArena* pMeshArena, StagingRing* pStagingRing, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, glm::ivec3 origin) :
+		pMeshArena(pMeshArena), origin(origin) {
+		initialize(pStagingRing, vertices, indices);
+	}
+
+	void ChunkMesh::initialize(StagingRing* pStagingRing, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices) {
+		allocation = pMeshArena->allocate(pStagingRing, vertices, indices);
+		allocated = true;
+	}
+
+	void ChunkMesh::destroy() {
+		if (allocated) {
+			pMeshArena->free(allocation);
+			allocated = false;
+		}
+	}
+
+	ChunkMesh::~ChunkMesh() {
+		destroy();
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "UtilHeader.h"
+#include "MeshArena.h"
+
+namespace one {
+	//gpu side of a meshed chunk, its vertices and indices live in the shared mesh arena
+	//drawn by the chunk culler's indirect draws, not by itself
+	class ChunkMesh : NonCopyable
+	{
+	public:
+
+		ChunkMesh(MeshArena* pMeshArena, StagingRing* pStagingRing, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, glm::ivec3 origin);
+		~ChunkMesh();
+
+		void initialize(StagingRing* pStagingRing, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+		void destroy();
+
+		inline uint32_t getVertexCount(void) const {
+			return allocation.vertexCount;
+		}
+
+		inline uint32_t getIndexCount(void) const {
+			return allocation.indexCount;
+		}
+
+		inline uint32_t getFirstIndex(void) const {
+			return allocation.firstIndex;
+		}
+
+		//added to every index of the mesh by the draw
+		inline int32_t getVertexOffset(void) const {
+			return static_cast<int32_t>(allocation.firstVertex);
+		}
+
+		inline glm::ivec3 getOrigin(void) const {
+			return origin;
+		}
+
+	private:
+
+		MeshArena* pMeshArena;
+
+		MeshArena::Allocation allocation;
+		bool allocated = false;
+
+		glm::ivec3 origin;
+
+	};
+}
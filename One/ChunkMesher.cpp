@@ -0,0 +1,225 @@
+#include "ChunkMesher.h"
+#include <algorithm>
+
+namespace one {
+	ChunkMesher::ChunkMesher() {
+		mask.resize(static_cast<size_t>(Chunk::SIZE) * Chunk::SIZE);
+		blocks.resize(static_cast<size_t>(PADDED_SIZE) * PADDED_SIZE * PADDED_SIZE);
+		//level 1 has the most cells of the coarse levels
+		const size_t cellSide = Chunk::SIZE / 2 + 2;
+		cells.resize(cellSide * cellSide * cellSide);
+	}
+
+	void ChunkMesher::gatherBlocks(const Chunk& chunk, const std::array<const Chunk*, 6>& neighbours) {
+		const int32_t size = Chunk::SIZE;
+		//missing neighbours and the unused edges of the border stay air
+		std::fill(blocks.begin(), blocks.end(), BLOCK_AIR);
+
+		//rows along x are contiguous in both layouts, so they are decoded straight into place
+		for (int32_t y = 0; y < size; y++) {
+			for (int32_t z = 0; z < size; z++) {
+				chunk.getBlocks(0, y, z, size, &blocks[paddedIndex(0, y, z)]);
+			}
+		}
+
+		//the layer of each neighbour that touches the chunk
+		if (neighbours[FACE_NEGATIVE_Y] != nullptr) {
+			for (int32_t z = 0; z < size; z++) {
+				neighbours[FACE_NEGATIVE_Y]->getBlocks(0, size - 1, z, size, &blocks[paddedIndex(0, -1, z)]);
+			}
+		}
+		if (neighbours[FACE_POSITIVE_Y] != nullptr) {
+			for (int32_t z = 0; z < size; z++) {
+				neighbours[FACE_POSITIVE_Y]->getBlocks(0, 0, z, size, &blocks[paddedIndex(0, size, z)]);
+			}
+		}
+		for (int32_t y = 0; y < size; y++) {
+			if (neighbours[FACE_NEGATIVE_Z] != nullptr) {
+				neighbours[FACE_NEGATIVE_Z]->getBlocks(0, y, size - 1, size, &blocks[paddedIndex(0, y, -1)]);
+			}
+			if (neighbours[FACE_POSITIVE_Z] != nullptr) {
+				neighbours[FACE_POSITIVE_Z]->getBlocks(0, y, 0, size, &blocks[paddedIndex(0, y, size)]);
+			}
+			//a column across the rows, one block of each
+			for (int32_t z = 0; z < size; z++) {
+				if (neighbours[FACE_NEGATIVE_X] != nullptr) {
+					blocks[paddedIndex(-1, y, z)] = neighbours[FACE_NEGATIVE_X]->getBlock(size - 1, y, z);
+				}
+				if (neighbours[FACE_POSITIVE_X] != nullptr) {
+					blocks[paddedIndex(size, y, z)] = neighbours[FACE_POSITIVE_X]->getBlock(0, y, z);
+				}
+			}
+		}
+	}
+
+	void ChunkMesher::downsample(uint32_t level) {
+		const int32_t scale = 1 << level;
+		const int32_t size = Chunk::SIZE >> level;
+		for (int32_t y = -1; y <= size; y++) {
+			for (int32_t z = -1; z <= size; z++) {
+				for (int32_t x = -1; x <= size; x++) {
+					//blocks of the cell, a border cell only covers the one layer of the neighbour that touches the chunk
+					const int32_t cell[3] = { x, y, z };
+					int32_t first[3];
+					int32_t last[3];
+					int32_t borders = 0;
+					for (int32_t axis = 0; axis < 3; axis++) {
+						if (cell[axis] < 0 || cell[axis] >= size) {
+							first[axis] = cell[axis] < 0 ? -1 : Chunk::SIZE;
+							last[axis] = first[axis];
+							borders++;
+						}
+						else {
+							first[axis] = cell[axis] * scale;
+							last[axis] = first[axis] + scale - 1;
+						}
+					}
+					//the sweep never looks at the edges and corners of the border
+					cells[gridIndex(x, y, z, size)] = borders <= 1 ? sampleCell(first, last, borders == 1) : BLOCK_AIR;
+				}
+			}
+		}
+	}
+
+	BlockId ChunkMesher::sampleCell(const int32_t first[3], const int32_t last[3], bool border) const {
+		//inside the chunk the first solid block from the top stands for the cell and any solid block makes it solid,
+		//so a coarse chunk always covers at least its real blocks
+		//a border cell only hides the face next to it when the neighbour is solid across all of it: whatever level the neighbour
+		//is drawn at covers its real blocks, so the faces kept along the border close every gap between two levels(skirts)
+		BlockId representative = BLOCK_AIR;
+		for (int32_t y = last[1]; y >= first[1]; y--) {
+			for (int32_t z = first[2]; z <= last[2]; z++) {
+				for (int32_t x = first[0]; x <= last[0]; x++) {
+					BlockId block = blocks[paddedIndex(x, y, z)];
+					if (border && block == BLOCK_AIR) {
+						return BLOCK_AIR;
+					}
+					if (!border && block != BLOCK_AIR) {
+						return block;
+					}
+					representative = block;
+				}
+			}
+		}
+		return representative;
+	}
+
+	ChunkMesher::Statistics ChunkMesher::mesh(const Chunk& chunk, const std::array<const Chunk*, 6>& neighbours, uint32_t level,
+		std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+		assert(level < LEVELS);
+		Statistics statistics;
+		gatherBlocks(chunk, neighbours);
+		if (level == 0) {
+			sweep(blocks, Chunk::SIZE, 1, statistics, vertices, indices);
+		}
+		else {
+			downsample(level);
+			sweep(cells, Chunk::SIZE >> level, 1 << level, statistics, vertices, indices);
+		}
+		return statistics;
+	}
+
+	void ChunkMesher::sweep(const std::vector<BlockId>& grid, int32_t size, int32_t scale, Statistics& statistics,
+		std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+		//step in the grid along x, y and z
+		const int32_t gridWidth = size + 2;
+		const int32_t strides[3] = { 1, gridWidth * gridWidth, gridWidth };
+
+		//each axis d is swept slice by slice, u and v are the two axes of the slice plane
+		for (int32_t d = 0; d < 3; d++) {
+			int32_t u = (d + 1) % 3;
+			int32_t v = (d + 2) % 3;
+
+			for (int32_t side = 0; side < 2; side++) {
+				uint32_t face = static_cast<uint32_t>(d * 2 + side);
+				//the cell the face looks at, inside the border even at the chunk's edge
+				int32_t facing = side == 0 ? -strides[d] : strides[d];
+
+				for (int32_t slice = 0; slice < size; slice++) {
+					//mask of faces in this slice that point towards air
+					int32_t position[3];
+					position[d] = slice;
+					position[u] = 0;
+					for (int32_t j = 0; j < size; j++) {
+						position[v] = j;
+						int32_t index = gridIndex(position[0], position[1], position[2], size);
+						for (int32_t i = 0; i < size; i++, index += strides[u]) {
+							BlockId block = grid[index];
+							BlockId faceBlock = block != BLOCK_AIR && grid[index + facing] == BLOCK_AIR ? block : BLOCK_AIR;
+							statistics.visibleFaces += faceBlock != BLOCK_AIR;
+							mask[j * size + i] = faceBlock;
+						}
+					}
+
+					//greedy: grow each face along u, then grow that row along v while it stays the same block
+					for (int32_t j = 0; j < size; j++) {
+						for (int32_t i = 0; i < size;) {
+							BlockId block = mask[j * size + i];
+							if (block == BLOCK_AIR) {
+								i++;
+								continue;
+							}
+
+							int32_t width = 1;
+							while (i + width < size && mask[j * size + i + width] == block) {
+								width++;
+							}
+
+							int32_t height = 1;
+							bool rowMatches = true;
+							while (j + height < size && rowMatches) {
+								for (int32_t k = 0; k < width; k++) {
+									if (mask[(j + height) * size + i + k] != block) {
+										rowMatches = false;
+										break;
+									}
+								}
+								if (rowMatches) {
+									height++;
+								}
+							}
+
+							//face lies on the far side of the block for positive faces
+							int32_t corner[3];
+							corner[d] = slice + side;
+							Vertex quad[4];
+							const int32_t cornerOffsets[4][2] = { {0, 0}, {width, 0}, {width, height}, {0, height} };
+							for (int32_t c = 0; c < 4; c++) {
+								corner[u] = i + cornerOffsets[c][0];
+								corner[v] = j + cornerOffsets[c][1];
+								quad[c] = Vertex::pack(corner[0] * scale, corner[1] * scale, corner[2] * scale, face, block);
+							}
+
+							//u x v points along +d, so the corners go counter clockwise seen from +d
+							//front faces are clockwise(pipeline), so positive faces are written backwards
+							uint32_t base = static_cast<uint32_t>(vertices.size());
+							if (side == 1) {
+								vertices.push_back(quad[0]);
+								vertices.push_back(quad[3]);
+								vertices.push_back(quad[2]);
+								vertices.push_back(quad[1]);
+							}
+							else {
+								vertices.insert(vertices.end(), quad, quad + 4);
+							}
+							indices.insert(indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+							statistics.quads++;
+
+							//merged faces are consumed
+							for (int32_t h = 0; h < height; h++) {
+								for (int32_t k = 0; k < width; k++) {
+									mask[(j + h) * size + i + k] = BLOCK_AIR;
+								}
+							}
+							i += width;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	ChunkMesher::~ChunkMesher() {
+
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "UtilHeader.h"
+#include <array>
+#include "Chunk.h"
+#include "MeshArena.h"
+
+namespace one {
+	//faces in the order of Vertex face bits and mesher neighbours
+	enum Faces : uint32_t {
+		FACE_NEGATIVE_X = 0,
+		FACE_POSITIVE_X = 1,
+		FACE_NEGATIVE_Y = 2,
+		FACE_POSITIVE_Y = 3,
+		FACE_NEGATIVE_Z = 4,
+		FACE_POSITIVE_Z = 5
+	};
+
+	//turns chunk blocks into triangles
+	//faces between two solid blocks are never drawn and the visible ones are merged greedily
+	//into the largest rectangles of the same block, so a flat 32x32 floor is 1 quad instead of 1024
+	//coarser levels merge 2^level blocks per side into a cell and mesh the cells the same way, for chunks far enough away that
+	//their blocks are smaller than a few pixels
+	//keeps scratch memory between calls, use one mesher per thread
+	class ChunkMesher : NonCopyable
+	{
+	public:
+
+		//level 0 is the full chunk, the coarsest level has cells of 8 blocks
+		static const uint32_t LEVELS = 4;
+
+		struct Statistics {
+			//faces that would be drawn without merging(one quad per visible block side)
+			uint32_t visibleFaces = 0;
+			//quads actually written
+			uint32_t quads = 0;
+		};
+
+		ChunkMesher();
+		~ChunkMesher();
+
+		//neighbours are indexed by Faces(nullptr counts as air, so chunk borders get faces)
+		//level: below LEVELS, vertex positions stay in blocks at every level
+		//vertices and indices are appended to
+		Statistics mesh(const Chunk& chunk, const std::array<const Chunk*, 6>& neighbours, uint32_t level,
+			std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+	private:
+
+		//the chunk with a one block border on every side
+		static const int32_t PADDED_SIZE = Chunk::SIZE + 2;
+
+		//x, y, z local to a grid of size^3 cells with a one cell border, -1 and size are in the border
+		static inline int32_t gridIndex(int32_t x, int32_t y, int32_t z, int32_t size) {
+			return ((y + 1) * (size + 2) + (z + 1)) * (size + 2) + (x + 1);
+		}
+
+		//x, y, z local to the chunk, -1 and SIZE are in the border
+		static inline int32_t paddedIndex(int32_t x, int32_t y, int32_t z) {
+			return gridIndex(x, y, z, Chunk::SIZE);
+		}
+
+		//decodes the chunk and the layer of every neighbour that touches it into blocks
+		void gatherBlocks(const Chunk& chunk, const std::array<const Chunk*, 6>& neighbours);
+		//fills cells with the cells of level from blocks
+		void downsample(uint32_t level);
+		//block standing for the blocks from first to last(inclusive), see downsample
+		BlockId sampleCell(const int32_t first[3], const int32_t last[3], bool border) const;
+		//greedy meshes a grid of size^3 cells(with its border), a cell is scale blocks wide
+		void sweep(const std::vector<BlockId>& grid, int32_t size, int32_t scale, Statistics& statistics,
+			std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+		//one slice of faces, block id of the face or air
+		std::vector<BlockId> mask;
+		//decoded once per chunk so the sweeps read plain bytes, same order as the chunk(x fastest, then z, then y)
+		std::vector<BlockId> blocks;
+		//the chunk at a coarser level, same layout as blocks with fewer cells per side
+		std::vector<BlockId> cells;
+
+	};
+}
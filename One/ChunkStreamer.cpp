@@ -0,0 +1,166 @@
+#include "ChunkStreamer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace one {
+	ChunkStreamer::ChunkStreamer(World* pWorld, const Settings& settings) : pWorld(pWorld), settings(settings) {
+		initialize();
+	}
+
+	void ChunkStreamer::initialize() {
+		assert(settings.viewDistance >= 0);
+		//the outer ring is only generated, the meshes of the ring inside it need their neighbours
+		int32_t loadDistance = settings.viewDistance + 1;
+		for (int32_t z = -loadDistance; z <= loadDistance; z++) {
+			for (int32_t x = -loadDistance; x <= loadDistance; x++) {
+				offsets.push_back({ x, z, std::max(std::abs(x), std::abs(z)) });
+			}
+		}
+		//inner rings first, the columns of a ring nearest first
+		std::sort(offsets.begin(), offsets.end(), [](const ColumnOffset& a, const ColumnOffset& b) {
+			if (a.ring != b.ring) {
+				return a.ring < b.ring;
+			}
+			return a.x * a.x + a.z * a.z < b.x * b.x + b.z * b.z;
+		});
+
+		std::cerr << "chunk streamer has initiated with a view distance of " << settings.viewDistance << " chunks and a "
+			<< settings.cacheBudget / (1024 * 1024) << "MB cache \n";
+	}
+
+	uint32_t ChunkStreamer::update(glm::vec3 viewPosition, float viewPixelSpread) {
+		int32_t x = static_cast<int32_t>(std::floor(viewPosition.x / static_cast<float>(Chunk::SIZE)));
+		int32_t z = static_cast<int32_t>(std::floor(viewPosition.z / static_cast<float>(Chunk::SIZE)));
+		//crossing into another column only restarts the rings and refreshes the lru, the requests are still spread over the ticks
+		if (!centered || x != centerX || z != centerZ) {
+			centerX = x;
+			centerZ = z;
+			centered = true;
+			centerPosition = viewPosition;
+			pixelSpread = viewPixelSpread;
+			firstPending = 0;
+			overBudget = false;
+			for (const ColumnOffset& offset : offsets) {
+				for (int32_t y = 0; y < World::HEIGHT_IN_CHUNKS; y++) {
+					ChunkCoordinate coordinate{ centerX + offset.x, y, centerZ + offset.z };
+					if (pWorld->getChunk(coordinate) != nullptr) {
+						touch(coordinate);
+					}
+				}
+			}
+		}
+
+		//columns are requested in ring order until the tick's requests are used up
+		//the ones at the start that need nothing more are skipped from now on
+		uint32_t requests = 0;
+		bool leading = true;
+		for (size_t i = firstPending; i < offsets.size() && requests < settings.requestsPerTick; i++) {
+			bool complete = requestColumn(offsets[i], requests);
+			if (leading && complete) {
+				firstPending = i + 1;
+			}
+			leading = leading && complete;
+		}
+
+		//least recently used first, a chunk still read by a job is passed over until a later tick
+		uint32_t evicted = 0;
+		std::list<ChunkCoordinate>::iterator position = lru.end();
+		while (pWorld->getLoadedBytes() > settings.cacheBudget && evicted < settings.evictionsPerTick && position != lru.begin()) {
+			position--;
+			ChunkCoordinate coordinate = *position;
+			if (isInRange(coordinate)) {
+				if (!overBudget) {
+					std::cerr << "chunk streamer: the chunks in view take more than the cache budget \n";
+					overBudget = true;
+				}
+				break;
+			}
+			if (!pWorld->unloadChunk(coordinate)) {
+				continue;
+			}
+			lruPositions.erase(coordinate);
+			position = lru.erase(position);
+			evicted++;
+		}
+		return evicted;
+	}
+
+	bool ChunkStreamer::requestColumn(const ColumnOffset& offset, uint32_t& requests) {
+		bool complete = true;
+		//the whole column shares a level, a chunk is only next to another level across a column border
+		uint32_t level = selectLevel(offset);
+		for (int32_t y = 0; y < World::HEIGHT_IN_CHUNKS; y++) {
+			ChunkCoordinate coordinate{ centerX + offset.x, y, centerZ + offset.z };
+			if (pWorld->getChunk(coordinate) == nullptr) {
+				if (requests < settings.requestsPerTick && pWorld->loadChunk(coordinate)) {
+					touch(coordinate);
+					requests++;
+				}
+				//still has to be meshed(or was not requested at all)
+				complete = complete && offset.ring > settings.viewDistance && pWorld->getChunk(coordinate) != nullptr;
+				continue;
+			}
+			//the outer ring is never meshed
+			if (offset.ring > settings.viewDistance) {
+				continue;
+			}
+			//a meshed chunk at another level keeps its mesh until the new one is done
+			ChunkState state = pWorld->getChunkState(coordinate);
+			bool remesh = state == CHUNK_MESHED && pWorld->getChunkLevel(coordinate) != level;
+			if ((state == CHUNK_GENERATED || remesh) && requests < settings.requestsPerTick && pWorld->meshChunk(coordinate, level)) {
+				requests++;
+				state = CHUNK_MESHING;
+			}
+			//a chunk still meshing at its old level is looked at again once it is done
+			complete = complete && (state == CHUNK_MESHING || state == CHUNK_MESHED) && pWorld->getChunkLevel(coordinate) == level;
+		}
+		return complete;
+	}
+
+	uint32_t ChunkStreamer::selectLevel(const ColumnOffset& offset) const {
+		//nearest point of the column, the viewer's own column is always at full detail
+		const float size = static_cast<float>(Chunk::SIZE);
+		float minimumX = static_cast<float>(centerX + offset.x) * size;
+		float minimumZ = static_cast<float>(centerZ + offset.z) * size;
+		float height = static_cast<float>(World::HEIGHT_IN_CHUNKS) * size;
+		float dx = std::max(std::max(minimumX - centerPosition.x, centerPosition.x - minimumX - size), 0.0f);
+		float dy = std::max(std::max(-centerPosition.y, centerPosition.y - height), 0.0f);
+		float dz = std::max(std::max(minimumZ - centerPosition.z, centerPosition.z - minimumZ - size), 0.0f);
+		float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+		//a cell of level n is 2^n blocks, distance * pixelSpread blocks fit in a pixel that far away
+		float allowed = settings.maxPixelError * distance * pixelSpread;
+		uint32_t level = 0;
+		while (level + 1 < ChunkMesher::LEVELS && static_cast<float>(1u << (level + 1)) <= allowed) {
+			level++;
+		}
+		return level;
+	}
+
+	void ChunkStreamer::touch(ChunkCoordinate coordinate) {
+		auto position = lruPositions.find(coordinate);
+		if (position != lruPositions.end()) {
+			lru.splice(lru.begin(), lru, position->second);
+			return;
+		}
+		lru.push_front(coordinate);
+		lruPositions[coordinate] = lru.begin();
+	}
+
+	bool ChunkStreamer::isInRange(ChunkCoordinate coordinate) const {
+		int32_t loadDistance = settings.viewDistance + 1;
+		return std::abs(coordinate.x - centerX) <= loadDistance && std::abs(coordinate.z - centerZ) <= loadDistance;
+	}
+
+	void ChunkStreamer::destroy() {
+		//the chunks belong to the world, only the bookkeeping goes
+		lru.clear();
+		lruPositions.clear();
+		offsets.clear();
+		centered = false;
+	}
+
+	ChunkStreamer::~ChunkStreamer() {
+		destroy();
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "UtilHeader.h"
+#include <list>
+#include <unordered_map>
+#include "World.h"
+
+namespace one {
+	//loads the chunks around the viewer and unloads the ones it left behind
+	//columns are requested ring by ring from the viewer's column outwards(nearest first), a few per tick
+	//chunks that fell out of range stay cached until the loaded bytes go over the budget, then the least recently used go first
+	//each column is meshed at the coarsest level(see ChunkMesher) whose cells still look smaller than maxPixelError pixels from the viewer,
+	//so the triangles of a ring shrink as the rings get wider and the total barely grows with the view distance
+	//only queues jobs and unloads, generation and meshing run on the workers and World::update picks them up
+	class ChunkStreamer : NonCopyable
+	{
+	public:
+
+		struct Settings {
+			//columns meshed in each direction from the viewer's column, one more ring is generated for their neighbours
+			int32_t viewDistance = 8;
+			//world bytes(blocks and meshes, see World::getLoadedBytes) kept before chunks are evicted
+			uint64_t cacheBudget = 128ull * 1024 * 1024;
+			//chunk generations and meshings queued per tick
+			uint32_t requestsPerTick = 32;
+			//chunks unloaded per tick at most, the rest waits for the next ticks
+			uint32_t evictionsPerTick = 16;
+			//a coarser level is used once its cells are at most this many pixels on screen, 0 keeps every chunk at full detail
+			float maxPixelError = 4.0f;
+		};
+
+		ChunkStreamer(World* pWorld, const Settings& settings);
+		~ChunkStreamer();
+
+		void initialize();
+		void destroy();
+
+		//one tick, call on the render thread before World::update
+		//viewPixelSpread: how wide a pixel is one block away from the viewer(see Camera::getPixelSpread)
+		//levels are picked again every time the viewer enters another column
+		//returns how many chunks were unloaded(their meshes are no longer in World::getMeshes)
+		uint32_t update(glm::vec3 viewPosition, float viewPixelSpread);
+
+	private:
+
+		//column offset from the viewer, ring is the larger of |x| and |z|
+		struct ColumnOffset {
+			int32_t x;
+			int32_t z;
+			int32_t ring;
+		};
+
+		//queues what the column still needs, true once nothing is left to request for it
+		bool requestColumn(const ColumnOffset& offset, uint32_t& requests);
+		//coarsest level the column can be meshed at from where the viewer was when it entered its column
+		uint32_t selectLevel(const ColumnOffset& offset) const;
+		//moves a chunk to the front of the lru, adds it if it is not in it yet
+		void touch(ChunkCoordinate coordinate);
+		bool isInRange(ChunkCoordinate coordinate) const;
+
+		World* pWorld;
+
+		Settings settings;
+
+		//every column up to viewDistance + 1, nearest first
+		std::vector<ColumnOffset> offsets;
+		//offsets before this are fully requested for the current column
+		size_t firstPending = 0;
+
+		//column of the viewer
+		int32_t centerX = 0;
+		int32_t centerZ = 0;
+		bool centered = false;
+		//viewer when it entered the column
+		glm::vec3 centerPosition{ 0.0f, 0.0f, 0.0f };
+		float pixelSpread = 0.0f;
+
+		//loaded chunks, most recently in range first
+		std::list<ChunkCoordinate> lru;
+		std::unordered_map<ChunkCoordinate, std::list<ChunkCoordinate>::iterator, ChunkCoordinateHash> lruPositions;
+
+		//the budget is smaller than what is in range, reported once
+		bool overBudget = false;
+
+	};
+}
@@ -1,8 +1,15 @@
 #include "CommandBuffer.h"
+#include "ChunkCuller.h"
+#include "Pipeline.h"
+#include "ComputePipeline.h"
+#include "RenderGraph.h"
+#include "BindlessTable.h"
+#include "UniformRing.h"
 
 
 namespace one{
-	CommandBuffer::CommandBuffer(VkDevice _device, VkCommandPool _commandPool) : _device(_device), _commandPool(_commandPool){
+	CommandBuffer::CommandBuffer(VkDevice _device, VkCommandPool _commandPool, VkCommandBufferLevel level) :
+		_device(_device), _commandPool(_commandPool), level(level) {
 		initialize();
 	}
 
@@ -12,7 +19,7 @@ namespace one{
 		allocInfo.commandPool = _commandPool;
 		//primary can be go to queue execution, but cant get called from other buffers
 		//secondary can not go to queue execution, but can get called from other buffers
-		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.level = level;
 		allocInfo.commandBufferCount = 1;
 
 		if (vkAllocateCommandBuffers(_device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
@@ -23,9 +30,8 @@ namespace one{
 	}
 
 	//writes commands to execute in command buffer
-	//in this case write to image
-	void CommandBuffer::recordCommandBuffer(VkFramebuffer frameBuffer, VkRenderPass renderPass, VkPipeline graphicsPipeline, VkExtent2D swapChainExtent) {
-
+	//in this case the render graph's passes(render pass, Hi-Z build) with their barriers
+	void CommandBuffer::recordGraph(const RenderGraph* pRenderGraph, VkQueryPool timestampQueryPool, uint32_t firstQuery) {
 		//start by specifying details on usage of such
 		VkCommandBufferBeginInfo beginInfo{};
 		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -41,6 +47,112 @@ namespace one{
 			throw std::runtime_error("failed to begin recording command buffer!");
 		}
 
+		//queries have to be reset before being written again(outside of a render pass)
+		if (timestampQueryPool != VK_NULL_HANDLE) {
+			vkCmdResetQueryPool(commandBuffer, timestampQueryPool, firstQuery, 2);
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampQueryPool, firstQuery);
+		}
+
+		pRenderGraph->execute(commandBuffer);
+
+		//written once every command before it has finished
+		if (timestampQueryPool != VK_NULL_HANDLE) {
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampQueryPool, firstQuery + 1);
+		}
+
+		//finish command buffer
+		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to record command buffer!");
+		}
+	}
+
+	void CommandBuffer::recordScene(VkCommandBuffer commandBuffer, VkFramebuffer frameBuffer, VkRenderPass renderPass, VkPipeline depthPrepassPipeline,
+		VkPipeline graphicsPipeline, VkPipeline farFieldPipeline, VkPipelineLayout pipelineLayout, const BindlessTable* pBindlessTable, const UniformRing* pUniformRing,
+		uint32_t uniformRegion, uint32_t uniformOffset, VkExtent2D swapChainExtent, const PushConstants& pushConstants, const ChunkCuller* pChunkCuller,
+		uint32_t cullTarget) {
+
+		//last specifies commands are primary/other option sets them to come from secondary
+		beginRenderPass(commandBuffer, frameBuffer, renderPass, swapChainExtent, VK_SUBPASS_CONTENTS_INLINE);
+
+		recordDraws(commandBuffer, depthPrepassPipeline, graphicsPipeline, farFieldPipeline, pipelineLayout, pBindlessTable, pUniformRing, uniformRegion, uniformOffset, swapChainExtent,
+			pushConstants, pChunkCuller, cullTarget,
+			0, pChunkCuller->getDrawCallCount(cullTarget));
+
+		//the renderPass can now be ended
+		vkCmdEndRenderPass(commandBuffer);
+	}
+
+	void CommandBuffer::recordScene(VkCommandBuffer commandBuffer, VkFramebuffer frameBuffer, VkRenderPass renderPass, VkExtent2D swapChainExtent,
+		const std::vector<VkCommandBuffer>& secondaryCommandBuffers) {
+
+		//a subpass started this way may only contain vkCmdExecuteCommands
+		beginRenderPass(commandBuffer, frameBuffer, renderPass, swapChainExtent, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+		if (!secondaryCommandBuffers.empty()) {
+			vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(secondaryCommandBuffers.size()), secondaryCommandBuffers.data());
+		}
+
+		vkCmdEndRenderPass(commandBuffer);
+	}
+
+	void CommandBuffer::recordSecondary(VkFramebuffer frameBuffer, VkRenderPass renderPass, VkPipeline depthPrepassPipeline, VkPipeline graphicsPipeline, VkPipeline farFieldPipeline,
+		VkPipelineLayout pipelineLayout, const BindlessTable* pBindlessTable, const UniformRing* pUniformRing, uint32_t uniformRegion, uint32_t uniformOffset,
+		VkExtent2D swapChainExtent, const PushConstants& pushConstants, const ChunkCuller* pChunkCuller, uint32_t cullTarget, uint32_t firstDraw, uint32_t drawCount) {
+
+		//render pass state is inherited from the primary that executes it
+		VkCommandBufferInheritanceInfo inheritanceInfo{};
+		inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritanceInfo.renderPass = renderPass;
+		inheritanceInfo.subpass = 0;
+		//optional but lets the driver specialize for the exact attachments
+		inheritanceInfo.framebuffer = frameBuffer;
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		//recorded again every frame and only ever used inside the render pass
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+		beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+		if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+			throw std::runtime_error("failed to begin recording secondary command buffer!");
+		}
+
+		//nothing bound in the primary carries over, every secondary sets its own state
+		recordDraws(commandBuffer, depthPrepassPipeline, graphicsPipeline, farFieldPipeline, pipelineLayout, pBindlessTable, pUniformRing, uniformRegion, uniformOffset, swapChainExtent,
+			pushConstants, pChunkCuller, cullTarget,
+			firstDraw, drawCount);
+
+		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to record secondary command buffer!");
+		}
+	}
+
+	void CommandBuffer::recordDispatch(const ComputePipeline* pComputePipeline, VkDescriptorSet descriptorSet, const void* pPushConstants, uint32_t groupCount,
+		VkBuffer zeroedBuffer) {
+		begin();
+		if (zeroedBuffer != VK_NULL_HANDLE) {
+			vkCmdFillBuffer(commandBuffer, zeroedBuffer, 0, VK_WHOLE_SIZE, 0);
+
+			//the shader's atomics have to see the cleared value
+			VkBufferMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.buffer = zeroedBuffer;
+			barrier.offset = 0;
+			barrier.size = VK_WHOLE_SIZE;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+				0, nullptr, 1, &barrier, 0, nullptr);
+		}
+		pComputePipeline->dispatch(commandBuffer, descriptorSet, pPushConstants, groupCount);
+		end();
+	}
+
+	void CommandBuffer::beginRenderPass(VkCommandBuffer commandBuffer, VkFramebuffer frameBuffer, VkRenderPass renderPass, VkExtent2D swapChainExtent,
+		VkSubpassContents contents) {
+
 		//starting renderpass
 		VkRenderPassBeginInfo renderPassInfo{};
 		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -50,19 +162,23 @@ namespace one{
 		//shader loads and stores will take place in render area(should be same size as attchments)
 		renderPassInfo.renderArea.offset = { 0, 0 };
 		renderPassInfo.renderArea.extent = swapChainExtent;
-		//clear values for atachment LOAD_OP_CLEAR for color attchment
-		VkClearValue clearColor = { {{0.0f,0.0f,0.0f,1.0f}} };//black 100% opacity
-		renderPassInfo.clearValueCount = 1;
-		renderPassInfo.pClearValues = &clearColor;
+		//clear values for atachment LOAD_OP_CLEAR, in attachment order
+		VkClearValue clearValues[2]{};
+		clearValues[0].color = { {0.0f,0.0f,0.0f,1.0f} };//black 100% opacity
+		clearValues[1].depthStencil = { 0.0f, 0 };//farthest(reversed depth)
+		renderPassInfo.clearValueCount = 2;
+		renderPassInfo.pClearValues = clearValues;
 
 		//renderpass has begun
-		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);//last specifies commands are primary/other option sets them to come from secondary
+		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
+	}
 
-		//specifies its graphics and not compute 
-		//this just told vulkan wich operations to execute and which attachments to use(in fragment shader)
-		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+	void CommandBuffer::recordDraws(VkCommandBuffer commandBuffer, VkPipeline depthPrepassPipeline, VkPipeline graphicsPipeline, VkPipeline farFieldPipeline, VkPipelineLayout pipelineLayout,
+		const BindlessTable* pBindlessTable, const UniformRing* pUniformRing, uint32_t uniformRegion, uint32_t uniformOffset, VkExtent2D swapChainExtent,
+		const PushConstants& pushConstants, const ChunkCuller* pChunkCuller, uint32_t cullTarget, uint32_t firstDraw, uint32_t drawCount) {
 
 		//viewport and scissor are dynamic, need to specify before drawing
+		//dynamic state, the sets and push constants stay set across both pipelines(same layout), so they are set once
 		VkViewport viewport{};
 		viewport.x = 0.0f;
 		viewport.y = 0.0f;
@@ -77,18 +193,77 @@ namespace one{
 		scissor.extent = swapChainExtent;
 		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-		//now the draw command for the triangle
-		//info besides cmdBuffer
-		//vertexCount = even though no vertex buffer it will draw 3 vertex
-		//instanceCount = used for instance rendering, 1 if not doing that
-		//firstVertex = offset into the vertex buffer, lowest value of VertexIndex
-		//firstInstance = offset into the instance rendering, lowest value of InstanceIndex
-		vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+		//every resource a draw reads is picked from the table by the indices in the push constants, nothing is bound per draw
+		pBindlessTable->bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout);
+		//camera and time of the frame, the region and offset are the same every frame the buffer is replayed
+		pUniformRing->bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, uniformRegion, uniformOffset);
 
-		//the renderPass can now be ended
-		vkCmdEndRenderPass(commandBuffer);
+		//table indices are the same for every chunk, pushed once
+		vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstants), &pushConstants);
 
-		//finish command buffer
+		//depth only first, then color where the depth is equal so every pixel is shaded once
+		VkPipeline pipelines[] = { depthPrepassPipeline, graphicsPipeline };
+		for (VkPipeline pipeline : pipelines) {
+			//specifies its graphics and not compute 
+			//this just told vulkan wich operations to execute and which attachments to use(in fragment shader)
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+
+			//every chunk comes from the mesh arena, the commands and origins from the culling on the gpu
+			pChunkCuller->recordDraws(commandBuffer, cullTarget, firstDraw, drawCount);
+		}
+
+		//after every chunk so only the pixels they left at the cleared depth are raymarched, one triangle covers the screen
+		if (farFieldPipeline != VK_NULL_HANDLE && pushConstants.farFieldBuffer != NO_FAR_FIELD) {
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, farFieldPipeline);
+			vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+		}
+	}
+
+	void CommandBuffer::recordLayoutTransition(VkImage image, uint32_t levelCount, VkImageLayout newLayout) {
+		begin();
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.newLayout = newLayout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.levelCount = levelCount;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+			0, nullptr, 0, nullptr, 1, &barrier);
+		end();
+	}
+
+	void CommandBuffer::recordTimestampBegin(VkQueryPool timestampQueryPool, uint32_t firstQuery) {
+		begin();
+		vkCmdResetQueryPool(commandBuffer, timestampQueryPool, firstQuery, 2);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampQueryPool, firstQuery);
+		end();
+	}
+
+	void CommandBuffer::recordTimestampEnd(VkQueryPool timestampQueryPool, uint32_t firstQuery) {
+		begin();
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampQueryPool, firstQuery + 1);
+		end();
+	}
+
+	void CommandBuffer::begin() {
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+			throw std::runtime_error("failed to begin recording command buffer!");
+		}
+	}
+
+	void CommandBuffer::end() {
 		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
 			throw std::runtime_error("failed to record command buffer!");
 		}
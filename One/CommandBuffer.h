@@ -2,17 +2,56 @@
 #include "UtilHeader.h"
 
 namespace one {
+	class BindlessTable;
+	class ChunkCuller;
+	class ComputePipeline;
+	class RenderGraph;
+	class UniformRing;
+	struct PushConstants;
+
 	class CommandBuffer : NonCopyable
 	{
 	public:
 
-		CommandBuffer(VkDevice _device, VkCommandPool _commandPool);
+		CommandBuffer(VkDevice _device, VkCommandPool _commandPool, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 		~CommandBuffer();
 
 		void initialize();
 		void destroy();
 		
-		void recordCommandBuffer(VkFramebuffer frameBuffer, VkRenderPass renderPass, VkPipeline graphicsPipeline, VkExtent2D swapChainExtent);
+		//records every pass of the render graph with its barriers
+		//timestampQueryPool can be VK_NULL_HANDLE, otherwise queries firstQuery and firstQuery+1 get the graph's begin/end times
+		void recordGraph(const RenderGraph* pRenderGraph, VkQueryPool timestampQueryPool, uint32_t firstQuery);
+
+		//the scene pass of a render graph: the render pass with the draws going through the depth prepass pipeline first, then the color pipeline
+		//then the far field behind them(farFieldPipeline VK_NULL_HANDLE or pushConstants without a far field buffer skip it)
+		static void recordScene(VkCommandBuffer commandBuffer, VkFramebuffer frameBuffer, VkRenderPass renderPass, VkPipeline depthPrepassPipeline,
+			VkPipeline graphicsPipeline, VkPipeline farFieldPipeline, VkPipelineLayout pipelineLayout, const BindlessTable* pBindlessTable, const UniformRing* pUniformRing,
+			uint32_t uniformRegion, uint32_t uniformOffset, VkExtent2D swapChainExtent, const PushConstants& pushConstants, const ChunkCuller* pChunkCuller,
+			uint32_t cullTarget);
+
+		//same render pass but the draws come from secondary buffers recorded elsewhere, executed in order
+		static void recordScene(VkCommandBuffer commandBuffer, VkFramebuffer frameBuffer, VkRenderPass renderPass, VkExtent2D swapChainExtent,
+			const std::vector<VkCommandBuffer>& secondaryCommandBuffers);
+
+		//secondary buffers only: records draw calls firstDraw to firstDraw + drawCount of cullTarget continuing subpass 0 of renderPass
+		//every secondary runs its own depth prepass before shading its draws, only the last one should get a farFieldPipeline
+		void recordSecondary(VkFramebuffer frameBuffer, VkRenderPass renderPass, VkPipeline depthPrepassPipeline, VkPipeline graphicsPipeline, VkPipeline farFieldPipeline,
+			VkPipelineLayout pipelineLayout, const BindlessTable* pBindlessTable, const UniformRing* pUniformRing, uint32_t uniformRegion, uint32_t uniformOffset,
+			VkExtent2D swapChainExtent, const PushConstants& pushConstants, const ChunkCuller* pChunkCuller, uint32_t cullTarget, uint32_t firstDraw, uint32_t drawCount);
+
+		//one dispatch of a compute pipeline, for compute queues
+		//zeroedBuffer(optional) is filled with 0 before the dispatch reads or writes it
+		void recordDispatch(const ComputePipeline* pComputePipeline, VkDescriptorSet descriptorSet, const void* pPushConstants, uint32_t groupCount,
+			VkBuffer zeroedBuffer = VK_NULL_HANDLE);
+
+		//moves every level of a color image from UNDEFINED to newLayout, for images only compute touches afterwards
+		void recordLayoutTransition(VkImage image, uint32_t levelCount, VkImageLayout newLayout);
+
+		//small standalone buffers that reset the two queries and write the begin/end timestamp
+		//to time work recorded in other buffers of the same submit
+		void recordTimestampBegin(VkQueryPool timestampQueryPool, uint32_t firstQuery);
+		void recordTimestampEnd(VkQueryPool timestampQueryPool, uint32_t firstQuery);
 
 		void reset();
 
@@ -27,10 +66,22 @@ namespace one {
 
 	private:
 
+		static void beginRenderPass(VkCommandBuffer commandBuffer, VkFramebuffer frameBuffer, VkRenderPass renderPass, VkExtent2D swapChainExtent,
+			VkSubpassContents contents);
+		void begin();
+		void end();
+		//dynamic state, the bindless table, the frame uniforms(uniformOffset in uniformRegion of the ring), push constants and the indirect draws of the chunk culler, once per pipeline(depth prepass, then color)
+		//and the far field triangle last
+		static void recordDraws(VkCommandBuffer commandBuffer, VkPipeline depthPrepassPipeline, VkPipeline graphicsPipeline, VkPipeline farFieldPipeline, VkPipelineLayout pipelineLayout,
+			const BindlessTable* pBindlessTable, const UniformRing* pUniformRing, uint32_t uniformRegion, uint32_t uniformOffset, VkExtent2D swapChainExtent,
+			const PushConstants& pushConstants, const ChunkCuller* pChunkCuller, uint32_t cullTarget, uint32_t firstDraw, uint32_t drawCount);
+
 		VkDevice _device;
 		
 		VkCommandPool _commandPool;
 
+		VkCommandBufferLevel level;
+
 		VkCommandBuffer commandBuffer;
 		
 	};
@@ -1,15 +1,15 @@
 #include "CommandPool.h"
 
 namespace one {
-	CommandPool::CommandPool(VkDevice _device, uint32_t queueIndex): _device(_device) {
-		initialize(queueIndex);
+	CommandPool::CommandPool(VkDevice _device, uint32_t queueIndex, VkCommandPoolCreateFlags flags): _device(_device) {
+		initialize(queueIndex, flags);
 	}
 
-	void CommandPool::initialize(uint32_t queueIndex) {
+	void CommandPool::initialize(uint32_t queueIndex, VkCommandPoolCreateFlags flags) {
 		VkCommandPoolCreateInfo poolInfo{};
 		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
 		//two types of flags: Transient= newcommands veryoften / reset= commands will be recorded individually(allows to reuse without destroying them)
-		poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		poolInfo.flags = flags;
 		poolInfo.queueFamilyIndex = queueIndex;
 		//command pool can only contain commands to a single queue
 
@@ -21,6 +21,12 @@ namespace one {
 
 	}
 
+	void CommandPool::reset() {
+		if (vkResetCommandPool(_device, commandPool, 0) != VK_SUCCESS) {
+			throw std::runtime_error("failed to reset command pool!");
+		}
+	}
+
 	void CommandPool::destroy() {
 		if (commandPool != VK_NULL_HANDLE) {
 			vkDestroyCommandPool(_device, commandPool, nullptr);
@@ -8,12 +8,16 @@ namespace one {
 
 	public:
 
-		CommandPool(VkDevice _device, uint32_t queueIndex);
+		//flags default to buffers being reset one by one, pools reset as a whole can use transient
+		CommandPool(VkDevice _device, uint32_t queueIndex, VkCommandPoolCreateFlags flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
 		~CommandPool();
 
-		void initialize(uint32_t queueIndex);
+		void initialize(uint32_t queueIndex, VkCommandPoolCreateFlags flags);
 		void destroy();
 
+		//resets every command buffer allocated from the pool at once, none of them may still be executing
+		void reset();
+
 		inline VkCommandPool getCommandPool() const {
 			return commandPool;
 		}
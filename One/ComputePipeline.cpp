@@ -0,0 +1,231 @@
+#include "ComputePipeline.h"
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+
+namespace one {
+	ComputePipeline::ComputePipeline(VkDevice _device, const std::string& shaderPath, const std::vector<VkDescriptorType>& bindingTypes, uint32_t pushConstantSize,
+		uint32_t maxDescriptorSets, PipelineCache* pPipelineCache) :
+		_device(_device), bindingTypes(bindingTypes), pushConstantSize(pushConstantSize) {
+		initialize(shaderPath, maxDescriptorSets, pPipelineCache);
+	}
+
+	//read binary data from file
+	static std::vector<char> readFile(const std::string& filename) {
+		std::ifstream file(filename, std::ios::ate | std::ios::binary);
+
+		if (!file.is_open()) {
+			throw std::runtime_error("failed to open file!");
+		}
+
+		size_t fileSize = (size_t)file.tellg();
+		std::vector<char> buffer(fileSize);
+		file.seekg(0);
+		file.read(buffer.data(), fileSize);
+		file.close();
+		return buffer;
+	}
+
+	void ComputePipeline::initialize(const std::string& shaderPath, uint32_t maxDescriptorSets, PipelineCache* pPipelineCache) {
+		//*************************************************************************************
+		//one set, every binding a single descriptor only the compute stage sees
+		uint32_t bindingCount = static_cast<uint32_t>(bindingTypes.size());
+		std::vector<VkDescriptorSetLayoutBinding> bindings(bindingCount);
+		for (uint32_t i = 0; i < bindingCount; i++) {
+			bindings[i].binding = i;
+			bindings[i].descriptorType = bindingTypes[i];
+			bindings[i].descriptorCount = 1;
+			bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+			bindings[i].pImmutableSamplers = nullptr;
+		}
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.bindingCount = bindingCount;
+		layoutInfo.pBindings = bindings.data();
+
+		if (vkCreateDescriptorSetLayout(_device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create compute descriptor set layout!");
+		}
+
+		//one pool size per descriptor type, enough for maxDescriptorSets sets
+		std::vector<VkDescriptorPoolSize> poolSizes;
+		for (VkDescriptorType type : bindingTypes) {
+			auto poolSize = std::find_if(poolSizes.begin(), poolSizes.end(), [type](const VkDescriptorPoolSize& size) { return size.type == type; });
+			if (poolSize == poolSizes.end()) {
+				poolSizes.push_back({ type, 0 });
+				poolSize = poolSizes.end() - 1;
+			}
+			poolSize->descriptorCount += maxDescriptorSets;
+		}
+
+		//sets of resources recreated with the swapchain are given back
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+		poolInfo.maxSets = maxDescriptorSets;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+
+		if (vkCreateDescriptorPool(_device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create compute descriptor pool!");
+		}
+
+		//*************************************************************************************
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = pushConstantSize;
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = pushConstantSize > 0 ? 1 : 0;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		if (vkCreatePipelineLayout(_device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create compute pipeline layout!");
+		}
+
+		//*************************************************************************************
+		//a compute pipeline is just its shader stage, no fixed function state
+		auto shaderCode = readFile(shaderPath);
+		VkShaderModule shaderModule = createShaderModule(shaderCode);
+
+		VkPipelineShaderStageCreateInfo shaderStageInfo{};
+		shaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		shaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		shaderStageInfo.module = shaderModule;
+		shaderStageInfo.pName = "main";
+
+		VkComputePipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage = shaderStageInfo;
+		pipelineInfo.layout = pipelineLayout;
+		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+		pipelineInfo.basePipelineIndex = -1;
+
+		auto creationStart = std::chrono::high_resolution_clock::now();
+		if (vkCreateComputePipelines(_device, pPipelineCache->getPipelineCache(), 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create compute pipeline!");
+		}
+		double creationMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - creationStart).count();
+		pPipelineCache->recordCreation(creationMilliseconds);
+
+		vkDestroyShaderModule(_device, shaderModule, nullptr);
+
+		std::cerr << "vulkan compute pipeline " << shaderPath << " has initiated \n";
+	}
+
+	VkDescriptorSet ComputePipeline::allocateDescriptorSet() {
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = descriptorPool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &descriptorSetLayout;
+
+		VkDescriptorSet descriptorSet;
+		if (vkAllocateDescriptorSets(_device, &allocInfo, &descriptorSet) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate compute descriptor set!");
+		}
+		return descriptorSet;
+	}
+
+	void ComputePipeline::freeDescriptorSets(const std::vector<VkDescriptorSet>& descriptorSets) {
+		if (descriptorSets.empty()) {
+			return;
+		}
+		vkFreeDescriptorSets(_device, descriptorPool, static_cast<uint32_t>(descriptorSets.size()), descriptorSets.data());
+	}
+
+	void ComputePipeline::writeDescriptorSet(VkDescriptorSet descriptorSet, const std::vector<VkBuffer>& buffers) {
+		assert(buffers.size() <= bindingTypes.size());
+		uint32_t bufferCount = static_cast<uint32_t>(buffers.size());
+
+		std::vector<VkDescriptorBufferInfo> bufferInfos(bufferCount);
+		std::vector<VkWriteDescriptorSet> writes(bufferCount);
+		for (uint32_t i = 0; i < bufferCount; i++) {
+			bufferInfos[i].buffer = buffers[i];
+			bufferInfos[i].offset = 0;
+			bufferInfos[i].range = VK_WHOLE_SIZE;
+
+			writes[i] = {};
+			writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[i].dstSet = descriptorSet;
+			writes[i].dstBinding = i;
+			writes[i].dstArrayElement = 0;
+			writes[i].descriptorCount = 1;
+			writes[i].descriptorType = bindingTypes[i];
+			writes[i].pBufferInfo = &bufferInfos[i];
+		}
+		vkUpdateDescriptorSets(_device, bufferCount, writes.data(), 0, nullptr);
+	}
+
+	void ComputePipeline::writeImage(VkDescriptorSet descriptorSet, uint32_t binding, VkImageView imageView, VkImageLayout imageLayout) {
+		//sampled images are read with texelFetch, no sampler needed
+		VkDescriptorImageInfo imageInfo{};
+		imageInfo.sampler = VK_NULL_HANDLE;
+		imageInfo.imageView = imageView;
+		imageInfo.imageLayout = imageLayout;
+
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = descriptorSet;
+		write.dstBinding = binding;
+		write.dstArrayElement = 0;
+		write.descriptorCount = 1;
+		write.descriptorType = bindingTypes[binding];
+		write.pImageInfo = &imageInfo;
+		vkUpdateDescriptorSets(_device, 1, &write, 0, nullptr);
+	}
+
+	void ComputePipeline::dispatch(VkCommandBuffer commandBuffer, VkDescriptorSet descriptorSet, const void* pPushConstants, uint32_t groupCount,
+		uint32_t groupCountY) const {
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+		if (pushConstantSize > 0) {
+			vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, pushConstantSize, pPushConstants);
+		}
+		//0 groups is valid and does nothing
+		vkCmdDispatch(commandBuffer, groupCount, groupCountY, 1);
+	}
+
+	VkShaderModule ComputePipeline::createShaderModule(const std::vector<char>& shaderCode) {
+		VkShaderModuleCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		createInfo.codeSize = shaderCode.size();
+		createInfo.pCode = reinterpret_cast<const uint32_t*>(shaderCode.data());
+
+		VkShaderModule shaderModule;
+		if (vkCreateShaderModule(_device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create shader module!");
+		}
+
+		return shaderModule;
+	}
+
+	void ComputePipeline::destroy() {
+		if (pipeline != VK_NULL_HANDLE) {
+			vkDestroyPipeline(_device, pipeline, nullptr);
+			pipeline = VK_NULL_HANDLE;
+		}
+		if (pipelineLayout != VK_NULL_HANDLE) {
+			vkDestroyPipelineLayout(_device, pipelineLayout, nullptr);
+			pipelineLayout = VK_NULL_HANDLE;
+		}
+		//frees every set allocated from it
+		if (descriptorPool != VK_NULL_HANDLE) {
+			vkDestroyDescriptorPool(_device, descriptorPool, nullptr);
+			descriptorPool = VK_NULL_HANDLE;
+		}
+		if (descriptorSetLayout != VK_NULL_HANDLE) {
+			vkDestroyDescriptorSetLayout(_device, descriptorSetLayout, nullptr);
+			descriptorSetLayout = VK_NULL_HANDLE;
+		}
+	}
+
+	ComputePipeline::~ComputePipeline() {
+		destroy();
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "UtilHeader.h"
+#include "PipelineCache.h"
+#include <string>
+
+namespace one {
+	//compute shader with its descriptor set layout and push constant range
+	//binding i has the type bindingTypes[i], sets come from a pool owned by the pipeline
+	class ComputePipeline : NonCopyable
+	{
+	public:
+
+		ComputePipeline(VkDevice _device, const std::string& shaderPath, const std::vector<VkDescriptorType>& bindingTypes, uint32_t pushConstantSize,
+			uint32_t maxDescriptorSets, PipelineCache* pPipelineCache);
+		~ComputePipeline();
+
+		void initialize(const std::string& shaderPath, uint32_t maxDescriptorSets, PipelineCache* pPipelineCache);
+		void destroy();
+
+		VkDescriptorSet allocateDescriptorSet();
+		//returns sets to the pool, none of them can be in use by a pending command buffer
+		void freeDescriptorSets(const std::vector<VkDescriptorSet>& descriptorSets);
+		//points the first buffers.size() bindings of descriptorSet at whole buffers, in binding order
+		//the set can't be in use by a pending command buffer
+		void writeDescriptorSet(VkDescriptorSet descriptorSet, const std::vector<VkBuffer>& buffers);
+		//points an image binding(sampled or storage) of descriptorSet at imageView, read in imageLayout
+		void writeImage(VkDescriptorSet descriptorSet, uint32_t binding, VkImageView imageView, VkImageLayout imageLayout);
+
+		//binds the pipeline and set, pushes pPushConstants(pushConstantSize bytes) and dispatches groupCount x groupCountY workgroups
+		void dispatch(VkCommandBuffer commandBuffer, VkDescriptorSet descriptorSet, const void* pPushConstants, uint32_t groupCount,
+			uint32_t groupCountY = 1) const;
+
+		inline VkPipeline getPipeline(void) const {
+			return pipeline;
+		}
+
+		inline VkPipelineLayout getPipelineLayout(void) const {
+			return pipelineLayout;
+		}
+
+	private:
+
+		VkShaderModule createShaderModule(const std::vector<char>& shaderCode);
+
+		VkDevice _device;
+
+		const std::vector<VkDescriptorType> bindingTypes;
+		const uint32_t pushConstantSize;
+
+		VkDescriptorSetLayout descriptorSetLayout{ VK_NULL_HANDLE };
+		VkDescriptorPool descriptorPool{ VK_NULL_HANDLE };
+		VkPipelineLayout pipelineLayout{ VK_NULL_HANDLE };
+		VkPipeline pipeline{ VK_NULL_HANDLE };
+
+	};
+}
@@ -5,14 +5,20 @@
 
 namespace one {
 	Device::Device(VkInstance _instance, const std::vector<const char*> validationLayers, 
-					SwapChain* pSwapChain, Queue* pGraphicsQueue, Queue* pPresentationQueue): 
-					_instance(_instance), pSwapChain(pSwapChain), pPresentationQueue(pPresentationQueue), pGraphicsQueue(pGraphicsQueue) {
+					SwapChain* pSwapChain, Queue* pGraphicsQueue, Queue* pPresentationQueue, Queue* pTransferQueue, Queue* pComputeQueue,
+					bool physicalDeviceProperties2): 
+					_instance(_instance), pSwapChain(pSwapChain), pPresentationQueue(pPresentationQueue), pGraphicsQueue(pGraphicsQueue),
+					pTransferQueue(pTransferQueue), pComputeQueue(pComputeQueue), physicalDeviceProperties2(physicalDeviceProperties2) {
+		if (pSwapChain != nullptr) {
+			deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+		}
 		initialize();
 	}
 
 	void Device::initialize() {
 		pickPhysicalGraphicsDevice();
 		initializeLogicalDevice();
+		pMemoryAllocator = new MemoryAllocator(device, physicalGraphicsDevice);
 	}
 
 	void Device::pickPhysicalGraphicsDevice() {
@@ -76,17 +82,25 @@ namespace one {
 			std::cerr << "this graphics device " << graphicsDeviceProperties.deviceID << " does not support all extensions necessary to run program!\n";
 			return 0;
 		}
-		SwapChain::SwapChainSupportDetails swapChainSupport = pSwapChain->querySwapChainSupport(graphicsDevice);
-		//for now our swapchain just needs 1 image format, 1 presentation mode
-		if (swapChainSupport.formats.empty() || swapChainSupport.presentationModes.empty()) {
-			std::cerr << "this graphics device and surface dont hold enough compatible image formats and presentation modes!\n";
+		if (!checkDescriptorIndexingSupport(graphicsDevice)) {
+			std::cerr << "this graphics device " << graphicsDeviceProperties.deviceID << " does not support the descriptor indexing the bindless table needs!\n";
 			return 0;
 		}
+		if (pSwapChain != nullptr) {
+			SwapChain::SwapChainSupportDetails swapChainSupport = pSwapChain->querySwapChainSupport(graphicsDevice);
+			//for now our swapchain just needs 1 image format, 1 presentation mode
+			if (swapChainSupport.formats.empty() || swapChainSupport.presentationModes.empty()) {
+				std::cerr << "this graphics device and surface dont hold enough compatible image formats and presentation modes!\n";
+				return 0;
+			}
+		}
 
 		// Discrete GPUs have a significant performance advantage
 		score += 1000 * (graphicsDeviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU);
 		//if both are same performance is faster
-		score += 1000 * (pGraphicsQueue->getFamilyIndex() == pPresentationQueue->getFamilyIndex());
+		if (pPresentationQueue != nullptr) {
+			score += 1000 * (pGraphicsQueue->getFamilyIndex() == pPresentationQueue->getFamilyIndex());
+		}
 		// Maximum possible size of textures affects graphics quality
 		score += graphicsDeviceProperties.limits.maxImageDimension2D;
 
@@ -96,13 +110,22 @@ namespace one {
 	}
 
 	void Device::initializeLogicalDevice() {
-		assert(findQueueFamilies(physicalGraphicsDevice, pGraphicsQueue, pPresentationQueue));
+		//queue indices were last set while rating other devices, set them again for the picked one
+		if (!findQueueFamilies(physicalGraphicsDevice, pGraphicsQueue, pPresentationQueue)) {
+			throw std::runtime_error("failed to find queue families on the picked device!");
+		}
+		findTransferQueueFamily(physicalGraphicsDevice);
+		findComputeQueueFamily(physicalGraphicsDevice);
 
 		std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
 		std::set<uint32_t>  uniqueQueueFamilies = {
 			pGraphicsQueue->getFamilyIndex(),
-			pPresentationQueue->getFamilyIndex()
+			pTransferQueue->getFamilyIndex(),
+			pComputeQueue->getFamilyIndex()
 		};
+		if (pPresentationQueue != nullptr) {
+			uniqueQueueFamilies.insert(pPresentationQueue->getFamilyIndex());
+		}
 
 		//most times both are the same
 		float queuePriority = 1.0f;//priority of which queue to prioritize
@@ -116,10 +139,53 @@ namespace one {
 			queueCreateInfos.push_back(queueCreateInfo);
 		}
 
-		VkPhysicalDeviceFeatures deviceFeatures{};//none for now
+		//optional features the renderer has fallbacks for, enabled when the gpu supports them
+		VkPhysicalDeviceFeatures supportedFeatures;
+		vkGetPhysicalDeviceFeatures(physicalGraphicsDevice, &supportedFeatures);
+		VkPhysicalDeviceFeatures deviceFeatures{};
+		deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+		deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+		multiDrawIndirect = deviceFeatures.multiDrawIndirect == VK_TRUE;
+		drawIndirectFirstInstance = deviceFeatures.drawIndirectFirstInstance == VK_TRUE;
+		//the bindless table is indexed with push constants(dynamically uniform)
+		deviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+		deviceFeatures.shaderStorageBufferArrayDynamicIndexing = VK_TRUE;
+
+		//core in vulkan 1.2, an extension before
+		bool drawIndirectCount = checkExtensionSupport(physicalGraphicsDevice, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+		if (drawIndirectCount) {
+			deviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+		}
+
+		//optional, without it frames are tracked with fences and binary semaphores
+		timelineSemaphores = checkTimelineSemaphoreSupport(physicalGraphicsDevice);
+		VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures{};
+		timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+		timelineSemaphoreFeatures.timelineSemaphore = VK_TRUE;
+		if (timelineSemaphores) {
+			deviceExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+		}
+
+		//required(checked when rating the device), maintenance3 is a dependency of it
+		deviceExtensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+		deviceExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+		VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures{};
+		descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+		descriptorIndexingFeatures.pNext = timelineSemaphores ? &timelineSemaphoreFeatures : nullptr;
+		descriptorIndexingFeatures.runtimeDescriptorArray = VK_TRUE;
+		descriptorIndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+		descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		descriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+		descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+		//the bindless table sizes its arrays to these
+		descriptorIndexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+		if (!getProperties2(physicalGraphicsDevice, &descriptorIndexingProperties)) {
+			throw std::runtime_error("failed to query descriptor indexing limits!");
+		}
 
 		VkDeviceCreateInfo createInfo{};
 		createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		createInfo.pNext = &descriptorIndexingFeatures;
 		createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
 		createInfo.pEnabledFeatures = &deviceFeatures;
@@ -137,7 +203,12 @@ namespace one {
 			throw std::runtime_error("failed to create logical device!");
 		}
 
-		std::cerr << "vulkan device has initiated \n";
+		if (drawIndirectCount) {
+			pCmdDrawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+				vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR"));
+		}
+
+		std::cerr << "vulkan device has initiated" << (timelineSemaphores ? " with timeline semaphores \n" : " \n");
 	}
 
 	bool Device::checkDeviceExtensionSupport(const VkPhysicalDevice graphicsDevice) {
@@ -165,6 +236,91 @@ namespace one {
 		return true;
 	}
 
+	bool Device::checkExtensionSupport(const VkPhysicalDevice graphicsDevice, const char* extensionName) {
+		uint32_t extensionCount;
+		vkEnumerateDeviceExtensionProperties(graphicsDevice, nullptr, &extensionCount, nullptr);
+		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+		vkEnumerateDeviceExtensionProperties(graphicsDevice, nullptr, &extensionCount, availableExtensions.data());
+
+		for (const auto& extension : availableExtensions) {
+			if (strcmp(extensionName, extension.extensionName) == 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool Device::getFeatures2(const VkPhysicalDevice graphicsDevice, void* pFeatures) {
+		//extension features can only be queried through vkGetPhysicalDeviceFeatures2
+		if (!physicalDeviceProperties2) {
+			return false;
+		}
+		PFN_vkGetPhysicalDeviceFeatures2KHR pGetPhysicalDeviceFeatures2 = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(
+			vkGetInstanceProcAddr(_instance, "vkGetPhysicalDeviceFeatures2KHR"));
+		if (pGetPhysicalDeviceFeatures2 == nullptr) {
+			return false;
+		}
+		VkPhysicalDeviceFeatures2KHR features{};
+		features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+		features.pNext = pFeatures;
+		pGetPhysicalDeviceFeatures2(graphicsDevice, &features);
+		return true;
+	}
+
+	bool Device::getProperties2(const VkPhysicalDevice graphicsDevice, void* pProperties) {
+		if (!physicalDeviceProperties2) {
+			return false;
+		}
+		PFN_vkGetPhysicalDeviceProperties2KHR pGetPhysicalDeviceProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2KHR>(
+			vkGetInstanceProcAddr(_instance, "vkGetPhysicalDeviceProperties2KHR"));
+		if (pGetPhysicalDeviceProperties2 == nullptr) {
+			return false;
+		}
+		VkPhysicalDeviceProperties2KHR properties{};
+		properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+		properties.pNext = pProperties;
+		pGetPhysicalDeviceProperties2(graphicsDevice, &properties);
+		return true;
+	}
+
+	bool Device::checkTimelineSemaphoreSupport(const VkPhysicalDevice graphicsDevice) {
+		if (!checkExtensionSupport(graphicsDevice, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) {
+			return false;
+		}
+
+		VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures{};
+		timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+		if (!getFeatures2(graphicsDevice, &timelineSemaphoreFeatures)) {
+			return false;
+		}
+
+		return timelineSemaphoreFeatures.timelineSemaphore == VK_TRUE;
+	}
+
+	bool Device::checkDescriptorIndexingSupport(const VkPhysicalDevice graphicsDevice) {
+		if (!checkExtensionSupport(graphicsDevice, VK_KHR_MAINTENANCE3_EXTENSION_NAME) ||
+			!checkExtensionSupport(graphicsDevice, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)) {
+			return false;
+		}
+
+		VkPhysicalDeviceFeatures supportedFeatures;
+		vkGetPhysicalDeviceFeatures(graphicsDevice, &supportedFeatures);
+		if (!supportedFeatures.shaderSampledImageArrayDynamicIndexing || !supportedFeatures.shaderStorageBufferArrayDynamicIndexing) {
+			return false;
+		}
+
+		VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures{};
+		descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+		if (!getFeatures2(graphicsDevice, &descriptorIndexingFeatures)) {
+			return false;
+		}
+
+		//slots are written while the table is bound, and only the ones shaders pick have to be valid
+		return descriptorIndexingFeatures.runtimeDescriptorArray && descriptorIndexingFeatures.descriptorBindingPartiallyBound &&
+			descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind && descriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind &&
+			descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending;
+	}
+
 	bool Device::findQueueFamilies(const VkPhysicalDevice graphicsDevice, Queue* pGraphicsQueue, Queue* pPrasentationQueue) {
 
 		//on vulkan any command sent to vulkan is submitted to a queue
@@ -179,23 +335,27 @@ namespace one {
 
 		int i = 0;
 		int queueSet = 0;
+		//headless only needs the graphics queue
+		int queuesNeeded = (pPresentationQueue != nullptr) ? 2 : 1;
 		//marks the flag indice of the 
 		for (const auto& queueFamily : queueFamilies) {
 			if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
 				//queueFamily that has atleast the graphics bit
-				assert(pGraphicsQueue->setFamilyIndex(i));
-				assert(pGraphicsQueue->setQueueCount(queueFamily.queueCount));
+				pGraphicsQueue->setFamilyIndex(i);
+				pGraphicsQueue->setQueueCount(queueFamily.queueCount);
 				queueSet++;
 			}
 			//if presentationsupport is available on this queue being checked
 			VkBool32 presentationSupport = false;
-			vkGetPhysicalDeviceSurfaceSupportKHR(graphicsDevice, i, pSwapChain->getSurface(), &presentationSupport);
+			if (pPresentationQueue != nullptr) {
+				vkGetPhysicalDeviceSurfaceSupportKHR(graphicsDevice, i, pSwapChain->getSurface(), &presentationSupport);
+			}
 			if (presentationSupport) {
-				assert(pPresentationQueue->setFamilyIndex(i));
-				assert(pPresentationQueue->setQueueCount(queueFamily.queueCount));
+				pPresentationQueue->setFamilyIndex(i);
+				pPresentationQueue->setQueueCount(queueFamily.queueCount);
 				queueSet++;
 			}
-			if (queueSet >=2) {
+			if (queueSet >= queuesNeeded) {
 				return true;
 			}
 			i++;
@@ -204,7 +364,60 @@ namespace one {
 		return false;
 	}
 
+	void Device::findTransferQueueFamily(const VkPhysicalDevice graphicsDevice) {
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(graphicsDevice, &queueFamilyCount, nullptr);
+
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(graphicsDevice, &queueFamilyCount, queueFamilies.data());
+
+		//transfer only families map to the copy engines(dma) of discrete gpus and run next to graphics work
+		for (uint32_t i = 0; i < queueFamilyCount; i++) {
+			VkQueueFlags flags = queueFamilies[i].queueFlags;
+			if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT) && !(flags & VK_QUEUE_COMPUTE_BIT)) {
+				pTransferQueue->setFamilyIndex(i);
+				pTransferQueue->setQueueCount(queueFamilies[i].queueCount);
+				std::cerr << "found dedicated transfer queue family " << i << "\n";
+				return;
+			}
+		}
+
+		//graphics queues can always transfer
+		pTransferQueue->setFamilyIndex(pGraphicsQueue->getFamilyIndex());
+		pTransferQueue->setQueueCount(1);
+	}
+
+	void Device::findComputeQueueFamily(const VkPhysicalDevice graphicsDevice) {
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(graphicsDevice, &queueFamilyCount, nullptr);
+
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(graphicsDevice, &queueFamilyCount, queueFamilies.data());
+
+		//compute families without graphics are fed by their own hardware queues(async compute)
+		//work there runs in the gaps of the graphics queue instead of after it
+		for (uint32_t i = 0; i < queueFamilyCount; i++) {
+			VkQueueFlags flags = queueFamilies[i].queueFlags;
+			if ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT)) {
+				pComputeQueue->setFamilyIndex(i);
+				pComputeQueue->setQueueCount(queueFamilies[i].queueCount);
+				std::cerr << "found dedicated compute queue family " << i << "\n";
+				return;
+			}
+		}
+
+		//the graphics family can compute too(the spec requires a family with both)
+		pComputeQueue->setFamilyIndex(pGraphicsQueue->getFamilyIndex());
+		pComputeQueue->setQueueCount(1);
+	}
+
 	void Device::destroy() {
+		//every allocation must be freed before the device goes away
+		if (pMemoryAllocator != nullptr) {
+			pMemoryAllocator->destroy();
+			delete pMemoryAllocator;
+			pMemoryAllocator = nullptr;
+		}
 		if (device != VK_NULL_HANDLE) {
 			vkDestroyDevice(device, nullptr);
 			device = VK_NULL_HANDLE;
@@ -4,6 +4,7 @@
 #include "Queue.h"
 #include "SwapChain.h"
 #include "Window.h"
+#include "MemoryAllocator.h"
 
 
 namespace one {
@@ -11,8 +12,12 @@ namespace one {
 	{
 	public:
 
+		//pTransferQueue gets a transfer only family if the gpu has one, otherwise the graphics family
+		//pComputeQueue gets a compute family without graphics(async compute) if the gpu has one, otherwise the graphics family
+		//physicalDeviceProperties2 tells if the instance enabled VK_KHR_get_physical_device_properties2(needed for timeline semaphores)
 		Device(VkInstance _instance, const std::vector<const char*> validationLayers,
-			SwapChain* pSwapChain, Queue* pGraphicsQueue, Queue* pPresentationQueue);
+			SwapChain* pSwapChain, Queue* pGraphicsQueue, Queue* pPresentationQueue, Queue* pTransferQueue, Queue* pComputeQueue,
+			bool physicalDeviceProperties2);
 		~Device();
 
 		void initialize();
@@ -26,6 +31,40 @@ namespace one {
 			return  physicalGraphicsDevice;
 		}
 
+		//VK_KHR_timeline_semaphore is enabled, otherwise queues fall back to fences and binary semaphores
+		inline bool hasTimelineSemaphores() const {
+			return timelineSemaphores;
+		}
+
+		//indirect draws: many draws per call, firstInstance other than 0, draw count read from a buffer
+		//the count variant is only loaded when the device has VK_KHR_draw_indirect_count, otherwise nullptr
+		inline bool hasMultiDrawIndirect() const {
+			return multiDrawIndirect;
+		}
+
+		inline bool hasDrawIndirectFirstInstance() const {
+			return drawIndirectFirstInstance;
+		}
+
+		inline PFN_vkCmdDrawIndexedIndirectCountKHR getCmdDrawIndexedIndirectCount() const {
+			return pCmdDrawIndexedIndirectCount;
+		}
+
+		//compute work runs on its own family and can overlap the graphics queue
+		inline bool hasAsyncCompute() const {
+			return pComputeQueue->getFamilyIndex() != pGraphicsQueue->getFamilyIndex();
+		}
+
+		//update after bind limits of the descriptor indexing the bindless table is built on
+		inline const VkPhysicalDeviceDescriptorIndexingPropertiesEXT& getDescriptorIndexingProperties() const {
+			return descriptorIndexingProperties;
+		}
+
+		//every buffer and image memory should come from here instead of vkAllocateMemory
+		inline MemoryAllocator* getMemoryAllocator() const {
+			return pMemoryAllocator;
+		}
+
 	private:
 		//handle of intance
 		VkInstance _instance;
@@ -34,16 +73,28 @@ namespace one {
 		Window* _window;
 
 		//Swapchain wrapper (handles images from vulkan to surface)
+		//nullptr when running headless(no surface, no presentation queue, no swapchain extension)
 		SwapChain* pSwapChain;
 
 		void pickPhysicalGraphicsDevice();
 		int rateGraphicsDeviceSuitability(VkPhysicalDevice device);
 		void initializeLogicalDevice();
 		bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+		//extension advertised and its timelineSemaphore feature supported
+		bool checkTimelineSemaphoreSupport(VkPhysicalDevice device);
+		//VK_EXT_descriptor_indexing with every feature BindlessTable needs, required
+		bool checkDescriptorIndexingSupport(VkPhysicalDevice device);
+		//fills the feature structs chained in pFeatures through vkGetPhysicalDeviceFeatures2, false if the instance can't query them
+		bool getFeatures2(VkPhysicalDevice device, void* pFeatures);
+		//same for the property structs chained in pProperties through vkGetPhysicalDeviceProperties2
+		bool getProperties2(VkPhysicalDevice device, void* pProperties);
+		bool checkExtensionSupport(VkPhysicalDevice device, const char* extensionName);
 
 
 		//Queue families
 		bool findQueueFamilies(const VkPhysicalDevice graphicsDevice, Queue* pGraphicsQueue, Queue* pPrasentationQueue);
+		void findTransferQueueFamily(const VkPhysicalDevice graphicsDevice);
+		void findComputeQueueFamily(const VkPhysicalDevice graphicsDevice);
 
 		//DEVICE handle
 		VkDevice device;
@@ -51,10 +102,15 @@ namespace one {
 		//Picking Graphics card device
 		VkPhysicalDevice physicalGraphicsDevice = VK_NULL_HANDLE;
 
-		//Device Extensions:
-		const std::vector<const char*> deviceExtensions = {
-			VK_KHR_SWAPCHAIN_EXTENSION_NAME
-		};
+		//Device Extensions(swapchain only when there is a surface to present to):
+		std::vector<const char*> deviceExtensions;
+
+		bool physicalDeviceProperties2;
+		bool timelineSemaphores = false;
+		bool multiDrawIndirect = false;
+		bool drawIndirectFirstInstance = false;
+		PFN_vkCmdDrawIndexedIndirectCountKHR pCmdDrawIndexedIndirectCount = nullptr;
+		VkPhysicalDeviceDescriptorIndexingPropertiesEXT descriptorIndexingProperties{};
 
 		//Validation layers copy
 		const std::vector<const char*> validationLayers;
@@ -62,6 +118,11 @@ namespace one {
 		//Queues
 		Queue* pGraphicsQueue;
 		Queue* pPresentationQueue;
+		Queue* pTransferQueue;
+		Queue* pComputeQueue;
+
+		//lives as long as the logical device
+		MemoryAllocator* pMemoryAllocator{ nullptr };
 
 		
 
@@ -0,0 +1,156 @@
+#include "FarField.h"
+#include "StagingRing.h"
+#include <algorithm>
+
+namespace one {
+	//tile jobs queued at once, the chunk jobs of the near field are never stuck behind all of them
+	static const size_t TILE_JOBS_IN_FLIGHT = 4;
+
+	FarField::FarField(Device* pDevice, StagingRing* pStagingRing, JobSystem* pJobSystem, BindlessTable* pBindlessTable, uint32_t levels) :
+		pDevice(pDevice), pStagingRing(pStagingRing), pJobSystem(pJobSystem), pBindlessTable(pBindlessTable) {
+		initialize(levels);
+	}
+
+	void FarField::initialize(uint32_t cubeLevels) {
+		//16 levels is 65536 blocks wide, offsets and positions still fit in 32 bits
+		assert(cubeLevels >= TILE_LEVEL && cubeLevels <= 16);
+		levels = cubeLevels;
+		int32_t half = 1 << (levels - 1);
+		//chunk aligned, the ground starts at the bottom of the cube
+		minimum = glm::ivec3(-half, 0, -half);
+		tilesPerSide = 1u << (levels - TILE_LEVEL);
+		tileRoots.assign(static_cast<size_t>(tilesPerSide) * tilesPerSide, 0);
+		mergedTiles = 0;
+		nextTile = 0;
+		pDag = new SparseVoxelDag();
+
+		std::cerr << "far field has initiated with " << tileRoots.size() << " tiles \n";
+	}
+
+	void FarField::buildTile(uint32_t index) {
+		glm::ivec3 origin = minimum + glm::ivec3((index % tilesPerSide) * TILE_SIZE, 0, (index / tilesPerSide) * TILE_SIZE);
+		const int32_t chunksPerSide = TILE_SIZE / Chunk::SIZE;
+
+		//the chunks are generated one by one and their rows copied into the tile, above the world stays air
+		static thread_local std::vector<BlockId> blocks(static_cast<size_t>(TILE_SIZE) * TILE_SIZE * TILE_SIZE);
+		std::fill(blocks.begin(), blocks.end(), BLOCK_AIR);
+		for (int32_t chunkY = 0; chunkY < World::HEIGHT_IN_CHUNKS; chunkY++) {
+			for (int32_t chunkZ = 0; chunkZ < chunksPerSide; chunkZ++) {
+				for (int32_t chunkX = 0; chunkX < chunksPerSide; chunkX++) {
+					Chunk chunk({ origin.x / Chunk::SIZE + chunkX, chunkY, origin.z / Chunk::SIZE + chunkZ });
+					chunk.generateTerrain();
+					for (int32_t y = 0; y < Chunk::SIZE; y++) {
+						for (int32_t z = 0; z < Chunk::SIZE; z++) {
+							size_t row = (static_cast<size_t>(chunkY * Chunk::SIZE + y) * TILE_SIZE + chunkZ * Chunk::SIZE + z) * TILE_SIZE + chunkX * Chunk::SIZE;
+							chunk.getBlocks(0, y, z, Chunk::SIZE, blocks.data() + row);
+						}
+					}
+				}
+			}
+		}
+
+		SparseVoxelDag* pTileDag = new SparseVoxelDag();
+		uint32_t root = pTileDag->addBlocks(blocks.data(), TILE_LEVEL);
+		builtTiles.push({ index, pTileDag, root });
+	}
+
+	bool FarField::update() {
+		if (pBuffer != nullptr) {
+			return false;
+		}
+
+		size_t kept = 0;
+		for (JobSystem::Job* pJob : pJobs) {
+			if (pJobSystem->isFinished(pJob)) {
+				pJobSystem->release(pJob);
+			}
+			else {
+				pJobs[kept++] = pJob;
+			}
+		}
+		pJobs.resize(kept);
+		while (pJobs.size() < TILE_JOBS_IN_FLIGHT && nextTile < tileRoots.size()) {
+			uint32_t index = nextTile++;
+			JobSystem::Job* pJob = pJobSystem->create([this, index]() {
+				buildTile(index);
+			});
+			pJobs.push_back(pJob);
+			pJobSystem->submit(pJob);
+		}
+
+		//the merged dag is only touched here, tiles that look alike end up sharing most of their nodes
+		BuiltTile builtTile;
+		for (uint32_t i = 0; i < MERGES_PER_UPDATE && builtTiles.pop(builtTile); i++) {
+			tileRoots[builtTile.index] = pDag->merge(*builtTile.pDag, builtTile.root, TILE_LEVEL);
+			delete builtTile.pDag;
+			mergedTiles++;
+		}
+		if (mergedTiles < tileRoots.size()) {
+			return false;
+		}
+
+		uint32_t root = buildLevel(levels, 0, 0, 0);
+		pDag->setRoot(root, levels, minimum);
+
+		//read by the fragment shader only, never written again
+		const std::vector<uint32_t>& words = pDag->getWords();
+		VkDeviceSize size = words.size() * sizeof(uint32_t);
+		pBuffer = new Buffer(pDevice, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0);
+		pStagingRing->upload(pBuffer->getBuffer(), 0, words.data(), size, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+		buffer = pBindlessTable->addBuffer(pBuffer->getBuffer(), 0, size);
+		std::cerr << "far field: " << pDag->getNodeCount() << " nodes in " << size / 1024 << " KB \n";
+
+		//the ring copied the words, nothing reads them on the cpu anymore
+		pDag->destroy();
+		delete pDag;
+		pDag = nullptr;
+		return true;
+	}
+
+	uint32_t FarField::buildLevel(uint32_t level, uint32_t x, uint32_t y, uint32_t z) {
+		//everything above the bottom row of tiles is sky
+		if (y >= static_cast<uint32_t>(TILE_SIZE)) {
+			return 0;
+		}
+		if (level == TILE_LEVEL) {
+			return tileRoots[x / TILE_SIZE + (z / TILE_SIZE) * tilesPerSide];
+		}
+		uint32_t half = 1u << (level - 1);
+		std::array<uint32_t, 8> children;
+		for (uint32_t i = 0; i < 8; i++) {
+			children[i] = buildLevel(level - 1, x + (i & 1) * half, y + ((i >> 1) & 1) * half, z + ((i >> 2) & 1) * half);
+		}
+		return pDag->addNode(children, level);
+	}
+
+	void FarField::destroy() {
+		//jobs still building tiles push into the queue
+		for (JobSystem::Job* pJob : pJobs) {
+			pJobSystem->wait(pJob);
+			pJobSystem->release(pJob);
+		}
+		pJobs.clear();
+		BuiltTile builtTile;
+		while (builtTiles.pop(builtTile)) {
+			delete builtTile.pDag;
+		}
+		if (pDag != nullptr) {
+			pDag->destroy();
+			delete pDag;
+			pDag = nullptr;
+		}
+		tileRoots.clear();
+
+		//the device is idle, nothing draws it anymore
+		if (pBuffer != nullptr) {
+			pBindlessTable->removeBuffer(buffer);
+			pBuffer->destroy();
+			delete pBuffer;
+			pBuffer = nullptr;
+		}
+	}
+
+	FarField::~FarField() {
+		destroy();
+	}
+}
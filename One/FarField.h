@@ -0,0 +1,100 @@
+#pragma once
+#include "UtilHeader.h"
+#include "JobSystem.h"
+#include "LockFreeQueue.h"
+#include "SparseVoxelDag.h"
+#include "BindlessTable.h"
+#include "Buffer.h"
+#include "World.h"
+
+namespace one {
+	//terrain out to the horizon as a sparse voxel dag in a storage buffer, farfield.frag raymarches it wherever no chunk mesh was drawn
+	//a fixed cube of 2^levels blocks centered on the origin, built once from generated chunks: a job per tile generates its chunks and
+	//builds the tile's dag, update merges the finished tiles into one dag(tiles share their identical subtrees) and uploads it
+	//memory and drawing cost do not grow with the view distance, only with how different the terrain is
+	class FarField : NonCopyable
+	{
+	public:
+
+		//a tile is a cube of 2^TILE_LEVEL blocks, as tall as the world so a column of tiles is a single tile
+		static const uint32_t TILE_LEVEL = 6;
+		static const int32_t TILE_SIZE = 1 << TILE_LEVEL;
+		static_assert(World::HEIGHT_IN_CHUNKS * Chunk::SIZE <= TILE_SIZE, "the terrain must fit in a single tile of height");
+		//finished tiles merged per update, keeps a frame from stalling on them
+		static const uint32_t MERGES_PER_UPDATE = 16;
+
+		//levels: the cube is 2^levels blocks wide, TILE_LEVEL at least
+		FarField(Device* pDevice, StagingRing* pStagingRing, JobSystem* pJobSystem, BindlessTable* pBindlessTable, uint32_t levels);
+		~FarField();
+
+		void initialize(uint32_t levels);
+		void destroy();
+
+		//merges finished tiles, once every tile is in builds the levels above them and uploads the dag through the staging ring
+		//true on the call that uploaded it(the ring has to be flushed before it is drawn), call on the render thread
+		bool update();
+
+		//uploaded and in the bindless table
+		inline bool isReady(void) const {
+			return pBuffer != nullptr;
+		}
+
+		//index of the dag in the bindless table, only valid once it is ready
+		inline uint32_t getBuffer(void) const {
+			return buffer;
+		}
+
+		//first block of the cube
+		inline glm::ivec3 getMinimum(void) const {
+			return minimum;
+		}
+
+		//size of the uploaded dag
+		inline VkDeviceSize getByteSize(void) const {
+			return pBuffer != nullptr ? pBuffer->getSize() : 0;
+		}
+
+	private:
+
+		//dag of one tile built by a job
+		struct BuiltTile {
+			uint32_t index;
+			SparseVoxelDag* pDag;
+			uint32_t root;
+		};
+
+		//runs on a worker, generates the chunks of the tile and builds its dag
+		void buildTile(uint32_t index);
+		//node of level over the merged tiles, x, y, z(in blocks from the minimum) is its first block
+		uint32_t buildLevel(uint32_t level, uint32_t x, uint32_t y, uint32_t z);
+
+		Device* pDevice;
+
+		StagingRing* pStagingRing;
+
+		JobSystem* pJobSystem;
+
+		BindlessTable* pBindlessTable;
+
+		uint32_t levels = 0;
+		glm::ivec3 minimum{ 0, 0, 0 };
+		//tiles along x and z
+		uint32_t tilesPerSide = 0;
+
+		//the tile jobs, released once they are finished
+		std::vector<JobSystem::Job*> pJobs;
+		//tiles are handed to jobs in index order
+		uint32_t nextTile = 0;
+		LockFreeQueue<BuiltTile> builtTiles;
+
+		//every merged tile, freed once it is uploaded
+		SparseVoxelDag* pDag{ nullptr };
+		//root of each tile in pDag(x + z * tilesPerSide)
+		std::vector<uint32_t> tileRoots;
+		uint32_t mergedTiles = 0;
+
+		Buffer* pBuffer{ nullptr };
+		uint32_t buffer = 0;
+
+	};
+}
@@ -38,6 +38,11 @@ namespace one {
 		return vkWaitForFences(_device, static_cast<uint32_t>(_fences.size()), _fences.data(), VK_FALSE, timeout) == VK_SUCCESS;
 	}*/
 
+	bool Fence::isSignaled(void)
+	{
+		return vkGetFenceStatus(_device, fence) == VK_SUCCESS;
+	}
+
 	bool Fence::resetFence(void)
 	{
 		return vkResetFences(_device, 1, &fence) == VK_SUCCESS;
@@ -18,6 +18,8 @@ namespace one {
 
 		bool waitForFence(uint64_t timeout);
 		bool resetFence(void);
+		//polls without blocking
+		bool isSignaled(void);
 
 	private:
 
@@ -0,0 +1,132 @@
+#include "FrameProfiler.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+
+namespace one {
+	FrameProfiler::FrameProfiler(VkDevice _device, VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex, uint32_t framesInFlight) :
+		_device(_device), framesInFlight(framesInFlight) {
+		initialize(physicalDevice, queueFamilyIndex);
+	}
+
+	void FrameProfiler::initialize(VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex) {
+		slotSubmitted.assign(framesInFlight, false);
+
+		//timestamps are only valid if the queue family has valid bits for them
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+		uint32_t validBits = queueFamilyIndex < queueFamilyCount ? queueFamilies[queueFamilyIndex].timestampValidBits : 0;
+		if (validBits == 0 || properties.limits.timestampPeriod == 0.0f) {
+			std::cerr << "graphics queue does not support timestamps, gpu times will not be reported \n";
+			return;
+		}
+		timestampPeriod = properties.limits.timestampPeriod;
+		timestampMask = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1);
+
+		VkQueryPoolCreateInfo queryPoolInfo{};
+		queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolInfo.queryCount = framesInFlight * 2;
+
+		if (vkCreateQueryPool(_device, &queryPoolInfo, nullptr, &queryPool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create timestamp query pool!");
+		}
+
+		std::cerr << "vulkan frameprofiler has initiated \n";
+	}
+
+	void FrameProfiler::collectGpuTime(uint32_t frameSlot) {
+		if (queryPool == VK_NULL_HANDLE || !slotSubmitted[frameSlot]) {
+			return;
+		}
+
+		//the slot's frame was waited on so no need for VK_QUERY_RESULT_WAIT_BIT
+		uint64_t timestamps[2];
+		VkResult result = vkGetQueryPoolResults(_device, queryPool, getFirstQuery(frameSlot), 2, sizeof(timestamps), timestamps,
+			sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		slotSubmitted[frameSlot] = false;
+		if (result != VK_SUCCESS) {
+			return;
+		}
+
+		uint64_t ticks = (timestamps[1] - timestamps[0]) & timestampMask;
+		gpuSamples.push_back(static_cast<double>(ticks) * timestampPeriod / 1000000.0);
+	}
+
+	void FrameProfiler::collectAllGpuTimes() {
+		for (uint32_t i = 0; i < framesInFlight; i++) {
+			collectGpuTime(i);
+		}
+	}
+
+	//nearest rank percentile of sorted samples
+	static double percentile(const std::vector<double>& sorted, double fraction) {
+		size_t rank = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+		return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+	}
+
+	static void writeStatistics(std::ostream& out, const char* name, std::vector<double> samples) {
+		out << "\"" << name << "\": ";
+		if (samples.empty()) {
+			out << "null";
+			return;
+		}
+		std::sort(samples.begin(), samples.end());
+		out << "{ \"count\": " << samples.size()
+			<< ", \"min\": " << samples.front()
+			<< ", \"median\": " << percentile(samples, 0.5)
+			<< ", \"p95\": " << percentile(samples, 0.95)
+			<< ", \"p99\": " << percentile(samples, 0.99)
+			<< ", \"max\": " << samples.back() << " }";
+	}
+
+	void FrameProfiler::writeReport(const std::string& path) const {
+		static const char* phaseNames[PHASE_COUNT] = { "fenceWait", "acquire", "record", "submit", "present", "frame" };
+
+		//all times in milliseconds
+		std::ostringstream out;
+		out << "{\n  \"frames\": " << getFrameCount() << ",\n  \"framesInFlight\": " << framesInFlight << ",\n  \"unit\": \"ms\",\n  \"cpu\": {";
+		bool first = true;
+		for (int phase = 0; phase < PHASE_COUNT; phase++) {
+			//headless has no acquire or present
+			if (cpuSamples[phase].empty()) {
+				continue;
+			}
+			out << (first ? "\n    " : ",\n    ");
+			writeStatistics(out, phaseNames[phase], cpuSamples[phase]);
+			first = false;
+		}
+		out << "\n  },\n  \"gpu\": {\n    ";
+		writeStatistics(out, "renderPass", gpuSamples);
+		out << "\n  }\n}\n";
+
+		if (path.empty()) {
+			std::cout << out.str();
+			return;
+		}
+		std::ofstream file(path, std::ios::trunc);
+		if (!file.is_open()) {
+			throw std::runtime_error("failed to open benchmark report file!");
+		}
+		file << out.str();
+		std::cerr << "benchmark report written to " << path << "\n";
+	}
+
+	void FrameProfiler::destroy() {
+		if (queryPool != VK_NULL_HANDLE) {
+			vkDestroyQueryPool(_device, queryPool, nullptr);
+			queryPool = VK_NULL_HANDLE;
+		}
+	}
+
+	FrameProfiler::~FrameProfiler() {
+		destroy();
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "UtilHeader.h"
+#include <chrono>
+#include <string>
+
+namespace one {
+	//collects cpu time per phase of a frame and gpu time of the render pass(timestamp queries)
+	//and reports min/median/p95/p99 as json so runs can be compared between commits
+	class FrameProfiler : NonCopyable
+	{
+	public:
+
+		enum Phase {
+			PHASE_FENCE_WAIT,
+			PHASE_ACQUIRE,
+			PHASE_RECORD,
+			PHASE_SUBMIT,
+			PHASE_PRESENT,
+			PHASE_FRAME,//whole drawFrame
+			PHASE_COUNT
+		};
+
+		FrameProfiler(VkDevice _device, VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex, uint32_t framesInFlight);
+		~FrameProfiler();
+
+		void initialize(VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex);
+		void destroy();
+
+		inline void beginPhase(Phase phase) {
+			phaseStart[phase] = std::chrono::high_resolution_clock::now();
+		}
+
+		inline void endPhase(Phase phase) {
+			cpuSamples[phase].push_back(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - phaseStart[phase]).count());
+		}
+
+		//VK_NULL_HANDLE if the queue can't write timestamps, command buffers then skip them
+		inline VkQueryPool getQueryPool(void) const {
+			return queryPool;
+		}
+
+		//2 queries per frame slot, begin and end of the render pass
+		inline uint32_t getFirstQuery(uint32_t frameSlot) const {
+			return frameSlot * 2;
+		}
+
+		//call once the command buffer using these queries has been submitted
+		inline void markSubmitted(uint32_t frameSlot) {
+			slotSubmitted[frameSlot] = true;
+		}
+
+		//call after the slot's last frame was waited on, reads the timestamps that slot wrote last time
+		void collectGpuTime(uint32_t frameSlot);
+		//call after every frame was waited on(end of the run)
+		void collectAllGpuTimes();
+
+		inline size_t getFrameCount(void) const {
+			return cpuSamples[PHASE_FRAME].size();
+		}
+
+		//writes the json report to path, stdout if path is empty
+		void writeReport(const std::string& path) const;
+
+	private:
+
+		VkDevice _device;
+
+		const uint32_t framesInFlight;
+
+		VkQueryPool queryPool{ VK_NULL_HANDLE };
+		//nanoseconds per timestamp tick and valid bits of the queue
+		float timestampPeriod = 0.0f;
+		uint64_t timestampMask = 0;
+		std::vector<bool> slotSubmitted;
+
+		std::chrono::high_resolution_clock::time_point phaseStart[PHASE_COUNT];
+		std::vector<double> cpuSamples[PHASE_COUNT];
+		std::vector<double> gpuSamples;
+
+	};
+}
@@ -4,8 +4,8 @@
 
 namespace one {
 
-	Framebuffer::Framebuffer(VkDevice _device, const VkImageView attachments[], VkRenderPass renderPass, VkExtent2D swapChainExtent) : _device(_device) {
-		initialize(attachments, renderPass, swapChainExtent);
+	Framebuffer::Framebuffer(VkDevice _device, const VkImageView attachments[], uint32_t attachmentCount, VkRenderPass renderPass, VkExtent2D swapChainExtent) : _device(_device) {
+		initialize(attachments, attachmentCount, renderPass, swapChainExtent);
 	}
 
 	//frameBuffer and renderring recommendations:
@@ -14,11 +14,11 @@ namespace one {
 	//put all independent work items(same resolution) in the same renderpass
 	//if able use by_region dependencies between subpasses
 	
-	void Framebuffer::initialize(const VkImageView attachments[], VkRenderPass renderPass, VkExtent2D swapChainExtent) {
+	void Framebuffer::initialize(const VkImageView attachments[], uint32_t attachmentCount, VkRenderPass renderPass, VkExtent2D swapChainExtent) {
 		VkFramebufferCreateInfo framebufferInfo{};
 		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
 		framebufferInfo.renderPass = renderPass;//must be compatible(use same attachments etc.)
-		framebufferInfo.attachmentCount = 1;
+		framebufferInfo.attachmentCount = attachmentCount;
 		framebufferInfo.pAttachments = attachments;
 		framebufferInfo.width = swapChainExtent.width;
 		framebufferInfo.height = swapChainExtent.height;
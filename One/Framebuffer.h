@@ -6,7 +6,8 @@ namespace one {
 	class Framebuffer
 	{
 	public:
-		Framebuffer(VkDevice _device, const VkImageView attachments[], VkRenderPass renderPass, VkExtent2D extent);
+		//attachments are in the order of the render pass attachments
+		Framebuffer(VkDevice _device, const VkImageView attachments[], uint32_t attachmentCount, VkRenderPass renderPass, VkExtent2D extent);
 		~Framebuffer();
 		
 		void destroy();
@@ -17,7 +18,7 @@ namespace one {
 
 	private:
 		
-		void initialize(const VkImageView attachments[], VkRenderPass renderPass, VkExtent2D swapChainExtent);
+		void initialize(const VkImageView attachments[], uint32_t attachmentCount, VkRenderPass renderPass, VkExtent2D swapChainExtent);
 
 		VkDevice _device;
 
@@ -0,0 +1,497 @@
+#include "HeadlessApp.h"
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+#include <cstdlib>
+
+namespace one {
+	static const VkDeviceSize STAGING_RING_SIZE = 8ull * 1024 * 1024;
+	static const VkDeviceSize UNIFORM_REGION_SIZE = 64ull * 1024;
+	//time step of a frame
+	static const float FRAME_TIME = 1.0f / 60.0f;
+	//chunk columns generated in each direction from the origin
+	static const int32_t WORLD_RADIUS = 4;
+
+	HeadlessApp::HeadlessApp(VkExtent2D extent, uint32_t framesInFlight, bool parallelRecording, bool cachedCommands) :
+		framesInFlight(framesInFlight), parallelRecording(parallelRecording), cachedCommands(cachedCommands), extent(extent) {
+		assert(framesInFlight > 0);
+		initialize();
+	}
+
+	void HeadlessApp::initialize() {
+		pJobSystem = new JobSystem(0);
+
+		pInstance = new Instance(true);
+
+		pGraphicsQueue = new Queue(-1, 1.0f);
+		pTransferQueue = new Queue(-1, 1.0f);
+		pComputeQueue = new Queue(-1, 1.0f);
+
+		//no swapchain and no presentation queue, device only needs graphics(and transfer/compute)
+		pDevice = new Device(pInstance->getInstance(), pInstance->getValidationLayers(), nullptr, pGraphicsQueue, nullptr, pTransferQueue,
+							pComputeQueue, pInstance->hasPhysicalDeviceProperties2());
+		_device = pDevice->getDevice();
+
+		pGraphicsQueue->initialize(_device, pDevice->hasTimelineSemaphores());
+		pTransferQueue->initialize(_device, pDevice->hasTimelineSemaphores());
+		pComputeQueue->initialize(_device, pDevice->hasTimelineSemaphores());
+
+		pStagingRing = new StagingRing(pDevice, pTransferQueue, pGraphicsQueue, STAGING_RING_SIZE);
+
+		//images end up ready to be copied out instead of presented
+		depthFormat = RenderGraph::chooseDepthFormat(pDevice->getPhysicalGraphicsDevice());
+		//depth is stored, the Hi-Z build samples it after the scene
+		pRenderPass = new RenderPass(_device, targetFormat, depthFormat, VK_ATTACHMENT_STORE_OP_STORE);
+
+		pPipelineCache = new PipelineCache(_device, pDevice->getPhysicalGraphicsDevice(), "pipeline.cache");
+
+		pBindlessTable = new BindlessTable(pDevice);
+		pUniformRing = new UniformRing(pDevice, pGraphicsQueue, framesInFlight, UNIFORM_REGION_SIZE);
+		pPipeline = new Pipeline(_device, pRenderPass->getRenderPass(), pBindlessTable->getDescriptorSetLayout(),
+			pUniformRing->getDescriptorSetLayout(), pPipelineCache);
+
+		pHiZPipeline = new ComputePipeline(_device, "hiz.comp.spv", { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE },
+			sizeof(HiZPyramid::BuildConstants), framesInFlight * HiZPyramid::MAX_LEVELS, pPipelineCache);
+
+		initializeTargets();
+
+		initializeWorld();
+
+		//draws straight out of the world's mesh arena
+		pChunkCuller = new ChunkCuller(pDevice, pComputeQueue, pGraphicsQueue, pPipelineCache, pWorld->getMeshArena(), framesInFlight);
+		for (uint32_t i = 0; i < framesInFlight; i++) {
+			pChunkCuller->setHiZPyramid(i, pHiZPyramids[i]);
+		}
+
+		initializeCommandBuffers();
+
+		initializeSyncObjects();
+
+		pFrameProfiler = new FrameProfiler(_device, pDevice->getPhysicalGraphicsDevice(), pGraphicsQueue->getFamilyIndex(), framesInFlight);
+
+		std::cerr << "headless app has initiated \n";
+	}
+
+	void HeadlessApp::initializeTargets() {
+		pTargets.resize(framesInFlight);
+		pRenderGraphs.resize(framesInFlight);
+		pFramebuffers.resize(framesInFlight);
+		pHiZPyramids.resize(framesInFlight);
+		for (uint32_t i = 0; i < framesInFlight; i++) {
+			pTargets[i] = new OffscreenTarget(pDevice, targetFormat, extent);
+			HiZPyramid* pHiZPyramid = new HiZPyramid(pDevice, pComputeQueue, pGraphicsQueue, pHiZPipeline, extent);
+			pHiZPyramids[i] = pHiZPyramid;
+
+			//same graph as App's, except the image ends up ready to be copied out instead of presented
+			RenderGraph* pRenderGraph = new RenderGraph(pDevice);
+			pRenderGraphs[i] = pRenderGraph;
+			uint32_t color = pRenderGraph->importImage(pTargets[i]->getImage(), VK_IMAGE_ASPECT_COLOR_BIT, 1,
+				{ VK_PIPELINE_STAGE_TRANSFER_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED },
+				{ VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL });
+			uint32_t depth = pRenderGraph->createImage({ depthFormat, extent, VK_IMAGE_ASPECT_DEPTH_BIT });
+			uint32_t hiZ = pRenderGraph->importImage(pHiZPyramid->getImage(), VK_IMAGE_ASPECT_COLOR_BIT, pHiZPyramid->getLevelCount(),
+				{ VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL },
+				{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL });
+
+			uint32_t scene = pRenderGraph->addPass("scene", [this, i](VkCommandBuffer commandBuffer) {
+				recordScene(commandBuffer, i);
+			});
+			pRenderGraph->write(scene, color, RenderGraph::USAGE_COLOR_ATTACHMENT);
+			pRenderGraph->write(scene, depth, RenderGraph::USAGE_DEPTH_ATTACHMENT);
+
+			uint32_t hiZBuild = pRenderGraph->addPass("hi-z build", [pHiZPyramid](VkCommandBuffer commandBuffer) {
+				pHiZPyramid->recordBuild(commandBuffer);
+			});
+			pRenderGraph->read(hiZBuild, depth, RenderGraph::USAGE_SAMPLED_COMPUTE);
+			pRenderGraph->write(hiZBuild, hiZ, RenderGraph::USAGE_STORAGE_COMPUTE);
+
+			pRenderGraph->compile();
+			//read after the scene, so the render pass has to store it
+			assert(!pRenderGraph->isTransientAttachment(depth));
+
+			pHiZPyramid->setDepthView(pRenderGraph->getImageView(depth));
+			VkImageView attachments[] = {
+				pTargets[i]->getImageView(),
+				pRenderGraph->getImageView(depth)
+			};
+			pFramebuffers[i] = new Framebuffer(_device, attachments, 2, pRenderPass->getRenderPass(), extent);
+		}
+	}
+
+	void HeadlessApp::recordScene(VkCommandBuffer commandBuffer, uint32_t slot) {
+		if (pSceneSecondaryCommandBuffers != nullptr) {
+			CommandBuffer::recordScene(commandBuffer, pFramebuffers[slot]->getFrameBuffer(), pRenderPass->getRenderPass(), extent,
+										*pSceneSecondaryCommandBuffers);
+		}
+		else {
+			CommandBuffer::recordScene(commandBuffer, pFramebuffers[slot]->getFrameBuffer(), pRenderPass->getRenderPass(),
+										pPipeline->getDepthPrepassPipeline(), pPipeline->getPipeline(), pPipeline->getFarFieldPipeline(), pPipeline->getPipelineLayout(),
+										pBindlessTable, pUniformRing, frameUniforms.region, frameUniforms.offset, extent, { pWorld->getMaterialBuffer(), NO_FAR_FIELD },
+										pChunkCuller, slot);
+		}
+	}
+
+	void HeadlessApp::initializeWorld() {
+		//always generated, a saved world would make runs differ
+		//no far field either, the fixed square of chunks is the whole scene
+		pWorld = new World(pDevice, pStagingRing, pJobSystem, pBindlessTable, pGraphicsQueue, "");
+		pWorld->generate(WORLD_RADIUS);
+		//every frame has to show the whole world so captures and benchmarks are comparable
+		pWorld->finishLoading();
+		pStagingRing->flush();
+
+		//looking at the middle of the world from above one corner
+		float distance = static_cast<float>(WORLD_RADIUS * Chunk::SIZE);
+		pCamera = new Camera(glm::vec3(-distance, 2.0f * distance, -distance), glm::vec3(0.0f, 24.0f, 0.0f), glm::radians(60.0f));
+	}
+
+	void HeadlessApp::initializeCommandBuffers() {
+		pCommandBuffers.resize(framesInFlight);
+		for (uint32_t i = 0; i < framesInFlight; i++) {
+			pCommandBuffers[i] = new CommandBuffer(_device, pGraphicsQueue->getCommandPool());
+		}
+		//every slot draws into its own target so its buffer can be replayed as is, timestamps included
+		recordedVersions.assign(framesInFlight, 0);
+		if (parallelRecording && !cachedCommands) {
+			pParallelRecorder = new ParallelRecorder(_device, pGraphicsQueue->getFamilyIndex(), pJobSystem, framesInFlight);
+		}
+	}
+
+	void HeadlessApp::initializeSyncObjects() {
+		//no semaphores, there is no acquire or present to order against
+		//frame completion is the graphics queue value of each slot's last submit
+		slotSubmitValues.assign(framesInFlight, 0);
+	}
+
+	void HeadlessApp::drawFrame() {
+		CommandBuffer* pCommandBuffer = pCommandBuffers[currentFrame];
+
+		pFrameProfiler->beginPhase(FrameProfiler::PHASE_FRAME);
+		pFrameProfiler->beginPhase(FrameProfiler::PHASE_FENCE_WAIT);
+
+		//slot is free once the frame drawn framesInFlight frames ago is done
+		if (!pGraphicsQueue->waitForValue(slotSubmitValues[currentFrame], UINT64_MAX)) {
+			throw std::runtime_error("failed to wait for in flight frame!");
+		}
+
+		pFrameProfiler->endPhase(FrameProfiler::PHASE_FENCE_WAIT);
+		pFrameProfiler->collectGpuTime(currentFrame);
+		pFrameProfiler->beginPhase(FrameProfiler::PHASE_RECORD);
+
+		glm::mat4 viewProjection = pCamera->getViewProjection(static_cast<float>(extent.width) / static_cast<float>(extent.height));
+		//first allocation of the slot's region, same offset every frame so a cached buffer needs no new recording for the camera
+		pUniformRing->begin(currentFrame);
+		frameUniforms = pUniformRing->allocate(sizeof(FrameUniforms));
+		FrameUniforms* pFrameUniforms = static_cast<FrameUniforms*>(frameUniforms.pData);
+		pFrameUniforms->viewProjection = viewProjection;
+		pFrameUniforms->cameraPosition = glm::vec4(pCamera->getPosition(), 1.0f);
+		pFrameUniforms->time = static_cast<float>(frameNumber) * FRAME_TIME;
+		pFrameUniforms->pixelSpread = pCamera->getPixelSpread(extent.height);
+		pFrameUniforms->inverseViewProjection = glm::inverse(viewProjection);
+
+		//the slot's last frame is done and with it the draw commands it read
+		pWorld->sortMeshes(pCamera->getPosition());
+		const std::vector<ChunkMesh*>& pMeshes = pWorld->getMeshes();
+		pChunkCuller->cull(currentFrame, pMeshes, pWorld->getMeshVersion(), viewProjection);
+
+		//a cached slot that nothing changed for is submitted again as is
+		if (!cachedCommands || recordedVersions[currentFrame] != sceneVersion) {
+			pCommandBuffer->reset();
+			if (pParallelRecorder != nullptr) {
+				const std::vector<VkCommandBuffer>& secondaryCommandBuffers = pParallelRecorder->record(currentFrame,
+					pFramebuffers[currentFrame]->getFrameBuffer(), pRenderPass->getRenderPass(), pPipeline->getDepthPrepassPipeline(),
+					pPipeline->getPipeline(), pPipeline->getFarFieldPipeline(), pPipeline->getPipelineLayout(), pBindlessTable, pUniformRing,
+					frameUniforms.region, frameUniforms.offset, extent, { pWorld->getMaterialBuffer(), NO_FAR_FIELD }, pChunkCuller, currentFrame);
+				pSceneSecondaryCommandBuffers = &secondaryCommandBuffers;
+				pCommandBuffer->recordGraph(pRenderGraphs[currentFrame], pFrameProfiler->getQueryPool(), pFrameProfiler->getFirstQuery(currentFrame));
+				pSceneSecondaryCommandBuffers = nullptr;
+			}
+			else {
+				pCommandBuffer->recordGraph(pRenderGraphs[currentFrame], pFrameProfiler->getQueryPool(), pFrameProfiler->getFirstQuery(currentFrame));
+			}
+			recordedVersions[currentFrame] = sceneVersion;
+		}
+
+		pFrameProfiler->endPhase(FrameProfiler::PHASE_RECORD);
+		pFrameProfiler->beginPhase(FrameProfiler::PHASE_SUBMIT);
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = pCommandBuffer->getCommandBufferPointer();
+		//draws read the culled commands, only the indirect stage waits for the compute queue
+		std::vector<Queue::TimelineWait> timelineWaits;
+		VkSemaphore cullFinished = VK_NULL_HANDLE;
+		VkPipelineStageFlags cullWaitStage = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+		if (pComputeQueue->hasTimeline()) {
+			timelineWaits.push_back(pChunkCuller->getTimelineWait(currentFrame));
+		}
+		else {
+			cullFinished = pChunkCuller->getCullFinished(currentFrame);
+			submitInfo.waitSemaphoreCount = 1;
+			submitInfo.pWaitSemaphores = &cullFinished;
+			submitInfo.pWaitDstStageMask = &cullWaitStage;
+		}
+
+		slotSubmitValues[currentFrame] = pGraphicsQueue->submit(submitInfo, timelineWaits);
+		pUniformRing->end(slotSubmitValues[currentFrame]);
+
+		pFrameProfiler->endPhase(FrameProfiler::PHASE_SUBMIT);
+		pFrameProfiler->markSubmitted(currentFrame);
+		pFrameProfiler->endPhase(FrameProfiler::PHASE_FRAME);
+
+		lastFrame = currentFrame;
+		currentFrame = (currentFrame + 1) % framesInFlight;
+		frameNumber++;
+	}
+
+	void HeadlessApp::renderFrames(uint32_t frameCount, const std::string& reportPath) {
+		auto start = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < frameCount; i++) {
+			drawFrame();
+		}
+		//the last frames are still on the gpu, they count for the total
+		if (!pGraphicsQueue->waitForValue(pGraphicsQueue->getSubmittedValue(), UINT64_MAX)) {
+			throw std::runtime_error("failed to wait for in flight frame!");
+		}
+		double totalMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		pFrameProfiler->collectAllGpuTimes();
+
+		if (frameCount == 0) {
+			return;
+		}
+		std::cerr << "headless: " << frameCount << " frames at " << extent.width << "x" << extent.height
+			<< " in " << totalMilliseconds << " ms (" << (frameCount * 1000.0 / totalMilliseconds) << " fps) \n";
+		pFrameProfiler->writeReport(reportPath);
+	}
+
+	void HeadlessApp::readback(const std::string& path) {
+		VkDeviceSize imageSize = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+
+		//host visible buffer the gpu copies the image into
+		VkBufferCreateInfo bufferInfo{};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = imageSize;
+		bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VkBuffer readbackBuffer;
+		if (vkCreateBuffer(_device, &bufferInfo, nullptr, &readbackBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create readback buffer!");
+		}
+
+		//cached memory makes cpu reads of it much faster, not every gpu has it
+		MemoryAllocator::Allocation readbackMemory = pDevice->getMemoryAllocator()->allocateBuffer(readbackBuffer,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+			MemoryAllocator::STRATEGY_BUDDY);
+
+		//one time command buffer with the copy
+		CommandBuffer copyCommandBuffer(_device, pGraphicsQueue->getCommandPool());
+		VkCommandBuffer commandBuffer = copyCommandBuffer.getCommandBuffer();
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+			throw std::runtime_error("failed to begin recording command buffer!");
+		}
+
+		//the render graph left the image in transfer src, the copy is a separate submit so it still waits on the color writes
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = pTargets[lastFrame]->getImage();
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.levelCount = 1;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		VkBufferImageCopy region{};
+		region.bufferOffset = 0;
+		region.bufferRowLength = 0;//tightly packed
+		region.bufferImageHeight = 0;
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = 0;
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = 1;
+		region.imageOffset = { 0, 0, 0 };
+		region.imageExtent = { extent.width, extent.height, 1 };
+		vkCmdCopyImageToBuffer(commandBuffer, pTargets[lastFrame]->getImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer, 1, &region);
+
+		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to record command buffer!");
+		}
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = copyCommandBuffer.getCommandBufferPointer();
+
+		uint64_t copyValue = pGraphicsQueue->submit(submitInfo);
+		if (!pGraphicsQueue->waitForValue(copyValue, UINT64_MAX)) {
+			throw std::runtime_error("failed to wait for readback copy!");
+		}
+
+		//write rgb ppm, alpha is dropped
+		//allocator keeps host visible memory mapped
+		const uint8_t* pixels = static_cast<const uint8_t*>(readbackMemory.pMapped);
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			throw std::runtime_error("failed to open readback file!");
+		}
+		file << "P6\n" << extent.width << " " << extent.height << "\n255\n";
+		for (VkDeviceSize i = 0; i < imageSize; i += 4) {
+			file.write(reinterpret_cast<const char*>(pixels + i), 3);
+		}
+		file.close();
+
+		vkFreeCommandBuffers(_device, pGraphicsQueue->getCommandPool(), 1, copyCommandBuffer.getCommandBufferPointer());
+		vkDestroyBuffer(_device, readbackBuffer, nullptr);
+		pDevice->getMemoryAllocator()->free(readbackMemory);
+
+		std::cerr << "headless: final frame written to " << path << "\n";
+	}
+
+	//reads a binary ppm(P6, 8 bit), width and height are 0 if it fails
+	static std::vector<uint8_t> readPpm(const std::string& path, uint32_t& width, uint32_t& height) {
+		width = 0;
+		height = 0;
+		std::ifstream file(path, std::ios::binary);
+		std::string magic;
+		uint32_t maxValue = 0;
+		file >> magic >> width >> height >> maxValue;
+		if (!file || magic != "P6" || maxValue != 255) {
+			width = 0;
+			height = 0;
+			return {};
+		}
+		file.get();//single whitespace before the data
+
+		std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 3);
+		file.read(reinterpret_cast<char*>(pixels.data()), pixels.size());
+		if (!file) {
+			width = 0;
+			height = 0;
+			return {};
+		}
+		return pixels;
+	}
+
+	bool HeadlessApp::compareWithGolden(const std::string& imagePath, const std::string& goldenPath, uint32_t tolerance) {
+		uint32_t width, height, goldenWidth, goldenHeight;
+		std::vector<uint8_t> image = readPpm(imagePath, width, height);
+		std::vector<uint8_t> golden = readPpm(goldenPath, goldenWidth, goldenHeight);
+
+		if (width == 0 || goldenWidth == 0) {
+			std::cerr << "headless: could not read " << imagePath << " or " << goldenPath << "\n";
+			return false;
+		}
+		if (width != goldenWidth || height != goldenHeight) {
+			std::cerr << "headless: image is " << width << "x" << height << " but golden is " << goldenWidth << "x" << goldenHeight << "\n";
+			return false;
+		}
+
+		//software and hardware rasterizers round differently, so a small tolerance per channel
+		size_t mismatches = 0;
+		uint32_t maxDifference = 0;
+		for (size_t i = 0; i < image.size(); i++) {
+			uint32_t difference = static_cast<uint32_t>(std::abs(static_cast<int>(image[i]) - static_cast<int>(golden[i])));
+			maxDifference = std::max(maxDifference, difference);
+			if (difference > tolerance) {
+				mismatches++;
+			}
+		}
+
+		std::cerr << "headless: golden comparison " << (mismatches == 0 ? "passed" : "failed") << " (" << mismatches
+			<< " channels over tolerance " << tolerance << ", max difference " << maxDifference << ") \n";
+		return mismatches == 0;
+	}
+
+	void HeadlessApp::destroy() {
+		pFrameProfiler->destroy();
+		delete pFrameProfiler;
+
+		pWorld->destroy();
+		delete pWorld;
+		delete pCamera;
+		pChunkCuller->destroy();
+		delete pChunkCuller;
+		if (pParallelRecorder != nullptr) {
+			pParallelRecorder->destroy();
+			delete pParallelRecorder;
+			pParallelRecorder = nullptr;
+		}
+		pJobSystem->destroy();
+		delete pJobSystem;
+		pStagingRing->destroy();
+		delete pStagingRing;
+
+		for (uint32_t i = 0; i < framesInFlight; i++) {
+			//freed with the command pool
+			delete pCommandBuffers[i];
+			pFramebuffers[i]->destroy();
+			delete pFramebuffers[i];
+			pTargets[i]->destroy();
+			delete pTargets[i];
+			//frees its transition buffer to the compute queue's pool
+			pHiZPyramids[i]->destroy();
+			delete pHiZPyramids[i];
+			pRenderGraphs[i]->destroy();
+			delete pRenderGraphs[i];
+		}
+		slotSubmitValues.clear();
+		pCommandBuffers.clear();
+		pFramebuffers.clear();
+		pTargets.clear();
+		pHiZPyramids.clear();
+		pRenderGraphs.clear();
+
+		pHiZPipeline->destroy();
+		delete pHiZPipeline;
+
+		//waits on the graphics queue values of its regions
+		pUniformRing->destroy();
+		delete pUniformRing;
+
+		pGraphicsQueue->destroy();
+		pTransferQueue->destroy();
+		pComputeQueue->destroy();
+
+		pPipeline->destroy();
+		delete pPipeline;
+
+		pBindlessTable->destroy();
+		delete pBindlessTable;
+
+		//saves the cache to disk before destroying it
+		pPipelineCache->destroy();
+		delete pPipelineCache;
+
+		pRenderPass->destroy();
+		delete pRenderPass;
+
+		//queue is only deleted close to device and can't be vkDestroyed
+		delete pGraphicsQueue;
+		delete pTransferQueue;
+		delete pComputeQueue;
+
+		pDevice->destroy();
+		delete pDevice;
+
+		pInstance->destroy();
+		delete pInstance;
+	}
+
+	HeadlessApp::~HeadlessApp() {
+
+	}
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "UtilHeader.h"
+#include "Framebuffer.h"
+#include "Pipeline.h"
+#include "BindlessTable.h"
+#include "UniformRing.h"
+#include "PipelineCache.h"
+#include "CommandBuffer.h"
+#include "ParallelRecorder.h"
+#include "ChunkCuller.h"
+#include "Device.h"
+#include "Instance.h"
+#include "RenderPass.h"
+#include "Fence.h"
+#include "OffscreenTarget.h"
+#include "RenderGraph.h"
+#include "HiZPyramid.h"
+#include "FrameProfiler.h"
+#include "StagingRing.h"
+#include "World.h"
+#include "Camera.h"
+#include <string>
+
+
+namespace one {
+
+	//same renderer as App but drawing into offscreen images, no window/surface/swapchain
+	//so it can run on build machines with a software driver(lavapipe) for benchmarking and golden images
+	class HeadlessApp {
+
+	public:
+
+		HeadlessApp(VkExtent2D extent, uint32_t framesInFlight, bool parallelRecording, bool cachedCommands);
+		void initialize();
+		void destroy();
+		~HeadlessApp();
+
+		HeadlessApp(const HeadlessApp&) = delete;//cant pass by reference
+		HeadlessApp& operator=(const HeadlessApp&) = delete;//cant copy by reference;
+
+		//action methods
+		//draws frameCount frames as fast as possible and writes the timing report(json, stdout if reportPath is empty)
+		void renderFrames(uint32_t frameCount, const std::string& reportPath);
+		//copies the last drawn frame to a ppm image(rgb, 8 bits)
+		void readback(const std::string& path);
+		//true if every channel of both ppm images is within tolerance
+		static bool compareWithGolden(const std::string& imagePath, const std::string& goldenPath, uint32_t tolerance);
+
+		inline VkDevice getDevice(void) const {
+			return _device;
+		}
+
+	private:
+
+		//offscreen image, render graph(with the depth buffer), framebuffer and Hi-Z pyramid of every frame slot
+		void initializeTargets();
+		//scene pass of slot's render graph, draws inline or executes pSceneSecondaryCommandBuffers
+		void recordScene(VkCommandBuffer commandBuffer, uint32_t slot);
+		void initializeCommandBuffers();
+		void initializeSyncObjects();
+		void initializeWorld();
+
+		void drawFrame();
+
+		Instance* pInstance;
+		Device* pDevice;
+		Pipeline* pPipeline;
+		BindlessTable* pBindlessTable;
+		//camera and time of each frame, one region per frame slot
+		UniformRing* pUniformRing;
+		PipelineCache* pPipelineCache;
+		RenderPass* pRenderPass;
+		//offscreen images, render graphs, framebuffers and Hi-Z pyramids(one per frame slot, like swapchain images)
+		std::vector<OffscreenTarget*> pTargets;
+		std::vector<RenderGraph*> pRenderGraphs;
+		std::vector<Framebuffer*> pFramebuffers;
+		std::vector<HiZPyramid*> pHiZPyramids;
+		//builds every level of every pyramid
+		ComputePipeline* pHiZPipeline;
+		//Frame slots
+		const uint32_t framesInFlight;
+		uint32_t currentFrame = 0;
+		//slot drawn last, it holds the image readback copies
+		uint32_t lastFrame = 0;
+		std::vector<CommandBuffer*> pCommandBuffers;
+		const bool parallelRecording;
+		ParallelRecorder* pParallelRecorder{ nullptr };
+		//cached command mode: a slot's buffer is only recorded again when it is older than sceneVersion
+		const bool cachedCommands;
+		std::vector<uint64_t> recordedVersions;
+		uint64_t sceneVersion = 1;
+		//the frame uniforms of the slot being recorded
+		UniformRing::Allocation frameUniforms{};
+		//frames drawn so far, FrameUniforms::time follows it so captures are the same on every run
+		uint64_t frameNumber = 0;
+		//secondary buffers the scene pass executes while a graph is recorded, nullptr draws inline
+		const std::vector<VkCommandBuffer>* pSceneSecondaryCommandBuffers = nullptr;
+		//graphics queue value of each slot's last frame
+		std::vector<uint64_t> slotSubmitValues;
+
+		//times fence wait/record/submit and the gpu render pass
+		FrameProfiler* pFrameProfiler;
+
+		StagingRing* pStagingRing;
+		JobSystem* pJobSystem;
+		World* pWorld;
+		Camera* pCamera;
+		//one target per frame slot
+		ChunkCuller* pChunkCuller;
+
+		Queue* pGraphicsQueue;
+		Queue* pTransferQueue;
+		Queue* pComputeQueue;
+
+		//images are always drawn in this format so readback doesnt depend on the driver
+		const VkFormat targetFormat = VK_FORMAT_R8G8B8A8_UNORM;
+		//picked like App does
+		VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+		VkExtent2D extent;
+
+		//logical device
+		VkDevice _device;
+
+	};
+}
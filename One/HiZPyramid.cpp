@@ -0,0 +1,152 @@
+#include "HiZPyramid.h"
+#include <set>
+#include <algorithm>
+
+namespace one {
+	HiZPyramid::HiZPyramid(Device* pDevice, Queue* pComputeQueue, Queue* pGraphicsQueue, ComputePipeline* pBuildPipeline, VkExtent2D extent) :
+		pDevice(pDevice), _device(pDevice->getDevice()), pComputeQueue(pComputeQueue), pGraphicsQueue(pGraphicsQueue), pBuildPipeline(pBuildPipeline), extent(extent) {
+		initialize();
+	}
+
+	void HiZPyramid::initialize() {
+		//halved down to 1x1
+		levelCount = 1;
+		while (levelCount < MAX_LEVELS && (std::max(extent.width, extent.height) >> levelCount) > 0) {
+			levelCount++;
+		}
+
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.format = VK_FORMAT_R32_SFLOAT;
+		imageInfo.extent.width = extent.width;
+		imageInfo.extent.height = extent.height;
+		imageInfo.extent.depth = 1;
+		imageInfo.mipLevels = levelCount;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		//written by the build, read by the build's next level and by the culling
+		imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		//built on graphics and read on compute every frame, like the culler's buffers
+		std::set<uint32_t> uniqueQueueFamilies = { pComputeQueue->getFamilyIndex(), pGraphicsQueue->getFamilyIndex() };
+		std::vector<uint32_t> sharingQueueFamilies(uniqueQueueFamilies.begin(), uniqueQueueFamilies.end());
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		if (sharingQueueFamilies.size() > 1) {
+			imageInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+			imageInfo.queueFamilyIndexCount = static_cast<uint32_t>(sharingQueueFamilies.size());
+			imageInfo.pQueueFamilyIndices = sharingQueueFamilies.data();
+		}
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		if (vkCreateImage(_device, &imageInfo, nullptr, &image) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create hi-z image!");
+		}
+
+		//recreated with the swapchain like the render targets
+		imageMemory = pDevice->getMemoryAllocator()->allocateImage(image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, MemoryAllocator::STRATEGY_BUDDY);
+
+		pImageView = new ImageView(_device, image, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount);
+
+		//*************************************************************************************
+		VkExtent2D sourceExtent = extent;
+		for (uint32_t level = 0; level < levelCount; level++) {
+			pLevelViews.push_back(new ImageView(_device, image, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, level, 1));
+
+			//level 0 reads the depth buffer, see setDepthView
+			VkDescriptorSet descriptorSet = pBuildPipeline->allocateDescriptorSet();
+			if (level > 0) {
+				pBuildPipeline->writeImage(descriptorSet, 0, pLevelViews[level - 1]->getImageView(), VK_IMAGE_LAYOUT_GENERAL);
+			}
+			pBuildPipeline->writeImage(descriptorSet, 1, pLevelViews[level]->getImageView(), VK_IMAGE_LAYOUT_GENERAL);
+			descriptorSets.push_back(descriptorSet);
+
+			VkExtent2D destinationExtent = level == 0 ? extent :
+				VkExtent2D{ std::max(sourceExtent.width >> 1, 1u), std::max(sourceExtent.height >> 1, 1u) };
+			BuildConstants constants{};
+			constants.sourceSize = glm::ivec2(sourceExtent.width, sourceExtent.height);
+			constants.destinationSize = glm::ivec2(destinationExtent.width, destinationExtent.height);
+			constants.step = level == 0 ? 1 : 2;
+			buildConstants.push_back(constants);
+			sourceExtent = destinationExtent;
+		}
+
+		//the culling binds the pyramid before the first build, its layout has to be right already
+		pTransitionCommandBuffer = new CommandBuffer(_device, pComputeQueue->getCommandPool());
+		pTransitionCommandBuffer->recordLayoutTransition(image, levelCount, VK_IMAGE_LAYOUT_GENERAL);
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = pTransitionCommandBuffer->getCommandBufferPointer();
+		transitionValue = pComputeQueue->submit(submitInfo);
+
+		std::cerr << "hi-z pyramid has initiated with " << levelCount << " levels \n";
+	}
+
+	void HiZPyramid::setDepthView(VkImageView depthView) {
+		pBuildPipeline->writeImage(descriptorSets[0], 0, depthView, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
+	}
+
+	void HiZPyramid::recordBuild(VkCommandBuffer commandBuffer) const {
+		//levels wait on the one before, the render graph already synchronized the whole image with everything outside the build
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+
+		for (uint32_t level = 0; level < levelCount; level++) {
+			const BuildConstants& constants = buildConstants[level];
+			pBuildPipeline->dispatch(commandBuffer, descriptorSets[level], &constants,
+				(constants.destinationSize.x + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, (constants.destinationSize.y + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE);
+
+			//the next level reads this one
+			if (level + 1 < levelCount) {
+				barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+				barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+				barrier.subresourceRange.baseMipLevel = level;
+				barrier.subresourceRange.levelCount = 1;
+				vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+					0, nullptr, 0, nullptr, 1, &barrier);
+			}
+		}
+	}
+
+	void HiZPyramid::destroy() {
+		//owner waits for every frame that built or culled with it first
+		if (pTransitionCommandBuffer != nullptr) {
+			if (!pComputeQueue->waitForValue(transitionValue, UINT64_MAX)) {
+				throw std::runtime_error("failed to wait for hi-z transition!");
+			}
+			vkFreeCommandBuffers(_device, pComputeQueue->getCommandPool(), 1, pTransitionCommandBuffer->getCommandBufferPointer());
+			delete pTransitionCommandBuffer;
+			pTransitionCommandBuffer = nullptr;
+		}
+		pBuildPipeline->freeDescriptorSets(descriptorSets);
+		descriptorSets.clear();
+		for (ImageView* pLevelView : pLevelViews) {
+			pLevelView->destroy(_device);
+			delete pLevelView;
+		}
+		pLevelViews.clear();
+		if (pImageView != nullptr) {
+			pImageView->destroy(_device);
+			delete pImageView;
+			pImageView = nullptr;
+		}
+		if (image != VK_NULL_HANDLE) {
+			vkDestroyImage(_device, image, nullptr);
+			image = VK_NULL_HANDLE;
+		}
+		pDevice->getMemoryAllocator()->free(imageMemory);
+	}
+
+	HiZPyramid::~HiZPyramid() {
+		destroy();
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include "UtilHeader.h"
+#include "Device.h"
+#include "ImageView.h"
+#include "ComputePipeline.h"
+#include "CommandBuffer.h"
+#include "Queue.h"
+
+namespace one {
+	//mip chain of the farthest depth of a render target, built by compute right after its render pass
+	//level 0 is a copy of the depth buffer, every level after keeps the farthest of the texels it covers
+	//the chunk culler tests bounds against it the next time the same target is culled(see ChunkCuller)
+	class HiZPyramid : NonCopyable
+	{
+	public:
+
+		//matches BuildConstants in hiz.comp
+		struct BuildConstants {
+			glm::ivec2 sourceSize;
+			glm::ivec2 destinationSize;
+			//1 copies the source, 2 halves it
+			int32_t step;
+		};
+
+		//local_size_x and local_size_y of hiz.comp
+		static const uint32_t WORKGROUP_SIZE = 8;
+		//enough for a 32768 wide target
+		static const uint32_t MAX_LEVELS = 16;
+
+		//pBuildPipeline is hiz.comp, shared by every pyramid(one descriptor set per level)
+		HiZPyramid(Device* pDevice, Queue* pComputeQueue, Queue* pGraphicsQueue, ComputePipeline* pBuildPipeline, VkExtent2D extent);
+		~HiZPyramid();
+
+		void initialize();
+		void destroy();
+
+		//depth buffer level 0 is built from, read in DEPTH_STENCIL_READ_ONLY_OPTIMAL and has to match extent
+		//has to be set before the first build(the render graph creates the depth buffer after the pyramid was imported)
+		void setDepthView(VkImageView depthView);
+
+		//every level from the depth buffer, as a pass of the render graph that reads the depth and writes the pyramid
+		//the graph's barrier before it covers the depth writes and the last culling and build of the pyramid
+		void recordBuild(VkCommandBuffer commandBuffer) const;
+
+		inline VkImage getImage(void) const {
+			return image;
+		}
+
+		//every level, read with texelFetch in GENERAL
+		inline VkImageView getImageView(void) const {
+			return pImageView->getImageView();
+		}
+
+		inline VkExtent2D getExtent(void) const {
+			return extent;
+		}
+
+		inline uint32_t getLevelCount(void) const {
+			return levelCount;
+		}
+
+	private:
+
+		Device* pDevice;
+		VkDevice _device;
+
+		Queue* pComputeQueue;
+		Queue* pGraphicsQueue;
+
+		ComputePipeline* pBuildPipeline;
+
+		VkExtent2D extent;
+		uint32_t levelCount;
+
+		VkImage image{ VK_NULL_HANDLE };
+		MemoryAllocator::Allocation imageMemory;
+
+		ImageView* pImageView{ nullptr };
+		//storage view of each level for the build
+		std::vector<ImageView*> pLevelViews;
+		//level i reads the depth buffer(i == 0) or level i - 1 and writes level i
+		std::vector<VkDescriptorSet> descriptorSets;
+		std::vector<BuildConstants> buildConstants;
+
+		//moves the image into GENERAL once, before anything can bind it
+		CommandBuffer* pTransitionCommandBuffer{ nullptr };
+		uint64_t transitionValue = 0;
+
+	};
+}
@@ -1,11 +1,12 @@
 #include "ImageView.h"
 
 namespace one {
-	ImageView::ImageView(VkDevice _device, VkImage _image, VkFormat swapchainImageFormat) :  _image(_image){
-		initialize(_device, swapchainImageFormat);
+	ImageView::ImageView(VkDevice _device, VkImage _image, VkFormat swapchainImageFormat, VkImageAspectFlags aspectMask,
+		uint32_t baseMipLevel, uint32_t levelCount) :  _image(_image){
+		initialize(_device, swapchainImageFormat, aspectMask, baseMipLevel, levelCount);
 	}
 
-	void ImageView::initialize(VkDevice _device, VkFormat swapchainImageFormat) {
+	void ImageView::initialize(VkDevice _device, VkFormat swapchainImageFormat, VkImageAspectFlags aspectMask, uint32_t baseMipLevel, uint32_t levelCount) {
 		VkImageViewCreateInfo createInfo{};
 		createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 		createInfo.image = _image;
@@ -20,9 +21,9 @@ namespace one {
 		createInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
 
 		//
-		createInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;//purpose
-		createInfo.subresourceRange.baseMipLevel = 0;//mipmapping levels
-		createInfo.subresourceRange.levelCount = 1;//?
+		createInfo.subresourceRange.aspectMask = aspectMask;//purpose
+		createInfo.subresourceRange.baseMipLevel = baseMipLevel;//mipmapping levels
+		createInfo.subresourceRange.levelCount = levelCount;//levels seen through the view
 		createInfo.subresourceRange.baseArrayLayer = 0;//purpose
 		createInfo.subresourceRange.layerCount = 1;//multiple layers per view
 
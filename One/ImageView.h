@@ -6,10 +6,12 @@ namespace one {
 	{
 	public:
 
-		ImageView(VkDevice _device, VkImage _image, VkFormat swapchainImageFormat);
+		//defaults view the first mip level of a color image, depth targets and mip chains pick their own range
+		ImageView(VkDevice _device, VkImage _image, VkFormat swapchainImageFormat, VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+			uint32_t baseMipLevel = 0, uint32_t levelCount = 1);
 		~ImageView();
 
-		void initialize(VkDevice _device, VkFormat swapchainImageFormat);
+		void initialize(VkDevice _device, VkFormat swapchainImageFormat, VkImageAspectFlags aspectMask, uint32_t baseMipLevel, uint32_t levelCount);
 		void destroy(VkDevice _device);
 
 		inline VkImageView getImageView(void) const {
@@ -1,7 +1,7 @@
 #include "Instance.h"
 
 namespace one {
-	Instance::Instance() {
+	Instance::Instance(bool headless) : headless(headless) {
 		initialize();
 	}
 
@@ -26,14 +26,28 @@ namespace one {
 		createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO; //most structs in vulkan require to specify their type
 		createInfo.pApplicationInfo = &appInfo;
 
-		//Using GLFW might move to window in future;
-		uint32_t glfwExtensionCount = 0;
-		const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);;
-
 		std::vector<const char*> requiredExtensions;
-		//when time come be to add extra extensions:(Can check if extensions are supported by vulkan)
-		for (uint32_t i = 0; i < glfwExtensionCount; i++) {
-			requiredExtensions.emplace_back(glfwExtensions[i]);
+		if (!headless) {
+			//Using GLFW might move to window in future;
+			uint32_t glfwExtensionCount = 0;
+			const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);;
+
+			//when time come be to add extra extensions:(Can check if extensions are supported by vulkan)
+			for (uint32_t i = 0; i < glfwExtensionCount; i++) {
+				requiredExtensions.emplace_back(glfwExtensions[i]);
+			}
+		}
+
+		//optional, only used to query and enable newer device features
+		uint32_t extensionCount = 0;
+		vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+		vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, availableExtensions.data());
+		for (const auto& extension : availableExtensions) {
+			if (strcmp(extension.extensionName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0) {
+				requiredExtensions.emplace_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+				physicalDeviceProperties2 = true;
+			}
 		}
 
 		createInfo.enabledExtensionCount = (uint32_t)requiredExtensions.size();
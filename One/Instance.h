@@ -6,7 +6,8 @@ namespace one {
 	{
 	public:
 
-		Instance();
+		//headless instances dont ask glfw for surface extensions(no window, no display)
+		Instance(bool headless);
 		~Instance();
 
 		void initialize();
@@ -21,9 +22,16 @@ namespace one {
 			return validationLayers;
 		}
 
+		//VK_KHR_get_physical_device_properties2 got enabled, device extensions like timeline semaphores depend on it
+		inline bool hasPhysicalDeviceProperties2(void) const {
+			return physicalDeviceProperties2;
+		}
+
 	private:
 
-		
+		bool headless;
+
+		bool physicalDeviceProperties2 = false;
 
 
 		//Creating Vulkan Instance
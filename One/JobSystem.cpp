@@ -0,0 +1,211 @@
+#include "JobSystem.h"
+#include <iostream>
+
+namespace one {
+	struct JobSystem::Job {
+		std::function<void()> function;
+		//starts at 1 so the job can't be queued before submit, every dependency adds one
+		std::atomic<int32_t> unfinishedDependencies{ 1 };
+		//owner handle + the system until the job ran
+		std::atomic<int32_t> references{ 2 };
+		std::atomic<bool> finished{ false };
+		//jobs waiting on this one, guarded since dependencies can be added while it runs
+		std::mutex dependentsMutex;
+		std::vector<Job*> pDependents;
+		bool dependentsReleased = false;
+	};
+
+	//index of the worker running on this thread, -1 on threads outside the pool
+	static thread_local int32_t currentWorkerIndex = -1;
+
+	JobSystem::JobSystem(uint32_t threadCount) {
+		initialize(threadCount);
+	}
+
+	void JobSystem::initialize(uint32_t threadCount) {
+		if (threadCount == 0) {
+			//hardware_concurrency can report 0 when unknown, the main thread keeps one core for itself
+			uint32_t cores = std::thread::hardware_concurrency();
+			threadCount = (cores > 1) ? cores - 1 : 1;
+		}
+
+		pQueues.resize(threadCount);
+		for (uint32_t i = 0; i < threadCount; i++) {
+			pQueues[i] = new WorkerQueue();
+		}
+		workers.reserve(threadCount);
+		for (uint32_t i = 0; i < threadCount; i++) {
+			workers.emplace_back(&JobSystem::workerLoop, this, i);
+		}
+
+		std::cerr << "job system has initiated with " << threadCount << " workers \n";
+	}
+
+	int32_t JobSystem::getCurrentWorkerIndex() {
+		return currentWorkerIndex;
+	}
+
+	JobSystem::Job* JobSystem::create(std::function<void()> function) {
+		Job* pJob = new Job();
+		pJob->function = std::move(function);
+		return pJob;
+	}
+
+	void JobSystem::addDependency(Job* pJob, Job* pDependency) {
+		std::lock_guard<std::mutex> lock(pDependency->dependentsMutex);
+		if (pDependency->dependentsReleased) {
+			//already done, nothing to wait for
+			return;
+		}
+		pJob->unfinishedDependencies.fetch_add(1, std::memory_order_relaxed);
+		pDependency->pDependents.push_back(pJob);
+	}
+
+	void JobSystem::submit(Job* pJob) {
+		//drops the submit guard, the last dependency to finish queues it otherwise
+		if (pJob->unfinishedDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			enqueue(pJob);
+		}
+	}
+
+	void JobSystem::wait(Job* pJob) {
+		//helping out instead of blocking also keeps a worker waiting on a job from deadlocking the pool
+		while (!pJob->finished.load(std::memory_order_acquire)) {
+			Job* pOther = findJob(currentWorkerIndex);
+			if (pOther != nullptr) {
+				execute(pOther);
+			}
+			else {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	bool JobSystem::isFinished(const Job* pJob) const {
+		return pJob->finished.load(std::memory_order_acquire);
+	}
+
+	void JobSystem::release(Job* pJob) {
+		if (pJob != nullptr && pJob->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			delete pJob;
+		}
+	}
+
+	void JobSystem::enqueue(Job* pJob) {
+		//workers keep their own spawned jobs local, outside threads spread them round robin
+		uint32_t queueIndex = (currentWorkerIndex >= 0)
+			? static_cast<uint32_t>(currentWorkerIndex)
+			: nextQueue.fetch_add(1, std::memory_order_relaxed) % static_cast<uint32_t>(pQueues.size());
+		{
+			std::lock_guard<std::mutex> lock(pQueues[queueIndex]->mutex);
+			pQueues[queueIndex]->jobs.push_back(pJob);
+		}
+		queuedJobs.fetch_add(1, std::memory_order_release);
+		{
+			//taking the lock orders the notify after a sleeping worker's predicate check
+			std::lock_guard<std::mutex> lock(sleepMutex);
+		}
+		sleepCondition.notify_one();
+	}
+
+	JobSystem::Job* JobSystem::findJob(int32_t workerIndex) {
+		uint32_t queueCount = static_cast<uint32_t>(pQueues.size());
+
+		if (workerIndex >= 0) {
+			WorkerQueue* pOwn = pQueues[workerIndex];
+			std::lock_guard<std::mutex> lock(pOwn->mutex);
+			if (!pOwn->jobs.empty()) {
+				Job* pJob = pOwn->jobs.back();
+				pOwn->jobs.pop_back();
+				queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+				return pJob;
+			}
+		}
+
+		//steal the oldest job, starting after ourselves so thieves don't all hit queue 0
+		uint32_t start = (workerIndex >= 0) ? static_cast<uint32_t>(workerIndex) + 1 : nextQueue.load(std::memory_order_relaxed);
+		for (uint32_t i = 0; i < queueCount; i++) {
+			WorkerQueue* pVictim = pQueues[(start + i) % queueCount];
+			//try_lock, a busy queue is skipped instead of stalling on it
+			std::unique_lock<std::mutex> lock(pVictim->mutex, std::try_to_lock);
+			if (lock.owns_lock() && !pVictim->jobs.empty()) {
+				Job* pJob = pVictim->jobs.front();
+				pVictim->jobs.pop_front();
+				queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+				return pJob;
+			}
+		}
+		return nullptr;
+	}
+
+	void JobSystem::execute(Job* pJob) {
+		pJob->function();
+
+		std::vector<Job*> pDependents;
+		{
+			std::lock_guard<std::mutex> lock(pJob->dependentsMutex);
+			pJob->dependentsReleased = true;
+			pDependents.swap(pJob->pDependents);
+		}
+		for (Job* pDependent : pDependents) {
+			submit(pDependent);
+		}
+
+		pJob->finished.store(true, std::memory_order_release);
+		release(pJob);
+	}
+
+	void JobSystem::workerLoop(uint32_t workerIndex) {
+		currentWorkerIndex = static_cast<int32_t>(workerIndex);
+
+		while (true) {
+			Job* pJob = findJob(currentWorkerIndex);
+			if (pJob != nullptr) {
+				execute(pJob);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			if (stopping.load(std::memory_order_acquire)) {
+				return;
+			}
+			//a failed try_lock can miss a job, so don't sleep for good while some are queued
+			if (queuedJobs.load(std::memory_order_acquire) > 0) {
+				lock.unlock();
+				std::this_thread::yield();
+				continue;
+			}
+			sleepCondition.wait(lock, [this] {
+				return stopping.load(std::memory_order_acquire) || queuedJobs.load(std::memory_order_acquire) > 0;
+			});
+		}
+	}
+
+	void JobSystem::destroy() {
+		if (workers.empty()) {
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			stopping.store(true, std::memory_order_release);
+		}
+		sleepCondition.notify_all();
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+		workers.clear();
+
+		for (WorkerQueue* pQueue : pQueues) {
+			//jobs never run drop the system's reference, handles stay valid until released
+			for (Job* pJob : pQueue->jobs) {
+				release(pJob);
+			}
+			delete pQueue;
+		}
+		pQueues.clear();
+	}
+
+	JobSystem::~JobSystem() {
+		destroy();
+	}
+}
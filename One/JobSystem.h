@@ -0,0 +1,73 @@
+#pragma once
+#include "NonCopyable.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace one {
+	//runs small cpu tasks(chunk generation, meshing) on a pool of worker threads
+	//every worker has its own deque: it pushes and pops at the back(newest first, still in cache)
+	//and idle workers steal from the front of the others(oldest first, usually the biggest work left)
+	class JobSystem : NonCopyable
+	{
+	public:
+
+		struct Job;
+
+		//threadCount 0 uses one worker per core minus the main thread
+		JobSystem(uint32_t threadCount);
+		~JobSystem();
+
+		void initialize(uint32_t threadCount);
+		void destroy();
+
+		//the returned handle must be given back with release
+		Job* create(std::function<void()> function);
+		//pJob only starts once pDependency has finished, must be called before submitting pJob
+		void addDependency(Job* pJob, Job* pDependency);
+		//queues the job(it runs as soon as its dependencies are done)
+		void submit(Job* pJob);
+		//runs other jobs on the calling thread until pJob has finished
+		void wait(Job* pJob);
+		bool isFinished(const Job* pJob) const;
+		void release(Job* pJob);
+
+		//index of the worker running the calling thread, -1 outside the pool(main thread)
+		static int32_t getCurrentWorkerIndex();
+
+		inline uint32_t getWorkerCount(void) const {
+			return static_cast<uint32_t>(workers.size());
+		}
+
+	private:
+
+		struct WorkerQueue {
+			std::mutex mutex;
+			std::deque<Job*> jobs;
+		};
+
+		void workerLoop(uint32_t workerIndex);
+		void enqueue(Job* pJob);
+		//own queue first, then steals from the others, nullptr if everything is empty
+		Job* findJob(int32_t workerIndex);
+		void execute(Job* pJob);
+
+		std::vector<std::thread> workers;
+		std::vector<WorkerQueue*> pQueues;
+
+		//spreads jobs submitted from outside the pool
+		std::atomic<uint32_t> nextQueue{ 0 };
+		std::atomic<int32_t> queuedJobs{ 0 };
+		std::atomic<bool> stopping{ false };
+
+		//idle workers sleep here until something is queued
+		std::mutex sleepMutex;
+		std::condition_variable sleepCondition;
+
+	};
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "NonCopyable.h"
+#include <atomic>
+#include <utility>
+
+namespace one {
+	//unbounded multiple producer single consumer queue(Vyukov's intrusive mpsc)
+	//any thread can push without locking, only one thread may pop
+	template<typename T>
+	class LockFreeQueue : NonCopyable
+	{
+	public:
+
+		LockFreeQueue() {
+			//stub node, the consumer always holds one node that was already popped
+			Node* pStub = new Node();
+			head.store(pStub, std::memory_order_relaxed);
+			pTail = pStub;
+		}
+
+		~LockFreeQueue() {
+			T value;
+			while (pop(value)) {
+			}
+			delete pTail;
+		}
+
+		void push(T value) {
+			Node* pNode = new Node();
+			pNode->value = std::move(value);
+			//producers only race on the exchange, the link is published afterwards
+			Node* pPrevious = head.exchange(pNode, std::memory_order_acq_rel);
+			pPrevious->next.store(pNode, std::memory_order_release);
+		}
+
+		//false if empty(or a push is halfway through, it shows up on a later pop)
+		bool pop(T& value) {
+			Node* pNext = pTail->next.load(std::memory_order_acquire);
+			if (pNext == nullptr) {
+				return false;
+			}
+			value = std::move(pNext->value);
+			delete pTail;
+			pTail = pNext;
+			return true;
+		}
+
+	private:
+
+		struct Node {
+			std::atomic<Node*> next{ nullptr };
+			T value{};
+		};
+
+		//last pushed node, producers side
+		std::atomic<Node*> head;
+		//last popped node, consumer side only
+		Node* pTail;
+
+	};
+}
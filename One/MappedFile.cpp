@@ -0,0 +1,108 @@
+#include "MappedFile.h"
+#include <iostream>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace one {
+	MappedFile::MappedFile(const std::string& path) {
+		initialize(path);
+	}
+
+#ifdef _WIN32
+	void MappedFile::initialize(const std::string& path) {
+		//others may read it too, the owner of the mapping writes through its own handle
+		HANDLE fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+		if (fileHandle == INVALID_HANDLE_VALUE) {
+			return;
+		}
+		LARGE_INTEGER fileSize;
+		//an empty file can't be mapped
+		if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+			CloseHandle(fileHandle);
+			return;
+		}
+		HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mappingHandle == nullptr) {
+			std::cerr << "failed to map " << path << "\n";
+			CloseHandle(fileHandle);
+			return;
+		}
+		void* pView = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+		if (pView == nullptr) {
+			std::cerr << "failed to map " << path << "\n";
+			CloseHandle(mappingHandle);
+			CloseHandle(fileHandle);
+			return;
+		}
+		file = fileHandle;
+		mapping = mappingHandle;
+		pData = static_cast<const uint8_t*>(pView);
+		size = static_cast<size_t>(fileSize.QuadPart);
+	}
+
+	void MappedFile::destroy() {
+		if (pData != nullptr) {
+			UnmapViewOfFile(pData);
+			pData = nullptr;
+			size = 0;
+		}
+		if (mapping != nullptr) {
+			CloseHandle(mapping);
+			mapping = nullptr;
+		}
+		if (file != nullptr) {
+			CloseHandle(file);
+			file = nullptr;
+		}
+	}
+#else
+	void MappedFile::initialize(const std::string& path) {
+		int fileDescriptor = open(path.c_str(), O_RDONLY);
+		if (fileDescriptor < 0) {
+			return;
+		}
+		struct stat status;
+		//an empty file can't be mapped
+		if (fstat(fileDescriptor, &status) != 0 || status.st_size == 0) {
+			close(fileDescriptor);
+			return;
+		}
+		void* pView = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, fileDescriptor, 0);
+		if (pView == MAP_FAILED) {
+			std::cerr << "failed to map " << path << "\n";
+			close(fileDescriptor);
+			return;
+		}
+		//chunks are looked up all over the file
+		madvise(pView, static_cast<size_t>(status.st_size), MADV_RANDOM);
+		file = fileDescriptor;
+		pData = static_cast<const uint8_t*>(pView);
+		size = static_cast<size_t>(status.st_size);
+	}
+
+	void MappedFile::destroy() {
+		if (pData != nullptr) {
+			munmap(const_cast<uint8_t*>(pData), size);
+			pData = nullptr;
+			size = 0;
+		}
+		if (file >= 0) {
+			close(file);
+			file = -1;
+		}
+	}
+#endif
+
+	MappedFile::~MappedFile() {
+		destroy();
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "NonCopyable.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace one {
+	//read only view of a whole file mapped into memory, pages are read by the os when they are first touched
+	//nothing is copied into a buffer, the file must not shrink while it is mapped
+	class MappedFile : NonCopyable
+	{
+	public:
+
+		//a missing or empty file is not an error, isOpen is false then
+		MappedFile(const std::string& path);
+		~MappedFile();
+
+		void initialize(const std::string& path);
+		void destroy();
+
+		inline bool isOpen(void) const {
+			return pData != nullptr;
+		}
+
+		inline const uint8_t* getData(void) const {
+			return pData;
+		}
+
+		inline size_t getSize(void) const {
+			return size;
+		}
+
+	private:
+
+		const uint8_t* pData = nullptr;
+		size_t size = 0;
+
+#ifdef _WIN32
+		//HANDLEs, void* so windows.h stays out of the header
+		void* file = nullptr;
+		void* mapping = nullptr;
+#else
+		int file = -1;
+#endif
+
+	};
+}
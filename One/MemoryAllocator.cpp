@@ -0,0 +1,384 @@
+#include "MemoryAllocator.h"
+#include <set>
+#include <algorithm>
+
+namespace one {
+	//blocks are 64MB unless the heap is small(integrated gpus, host visible vram windows)
+	static const VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+	static const VkDeviceSize MIN_BLOCK_SIZE = 1ull * 1024 * 1024;
+	//smallest buddy, smaller allocations waste the rest(uniforms should go through a ring buffer instead)
+	static const VkDeviceSize MIN_BUDDY_SIZE = 256;
+
+	static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	static VkDeviceSize floorPowerOfTwo(VkDeviceSize value) {
+		VkDeviceSize power = 1;
+		while (power * 2 <= value) {
+			power *= 2;
+		}
+		return power;
+	}
+
+	struct MemoryAllocator::Block {
+		VkDeviceMemory memory{ VK_NULL_HANDLE };
+		VkDeviceSize size = 0;
+		uint32_t memoryTypeIndex = 0;
+		bool optimalImage = false;
+		Strategy strategy = STRATEGY_BUDDY;
+		void* pMapped = nullptr;
+
+		VkDeviceSize usedBytes = 0;
+		uint32_t allocationCount = 0;
+
+		//buddy: free offsets per order, order n holds ranges of MIN_BUDDY_SIZE << n
+		std::vector<std::set<VkDeviceSize>> freeLists;
+		//linear: next free offset
+		VkDeviceSize linearOffset = 0;
+
+		uint32_t maxOrder() const {
+			return static_cast<uint32_t>(freeLists.size()) - 1;
+		}
+
+		//returns false if it doesnt fit
+		bool allocate(VkDeviceSize allocationSize, VkDeviceSize alignment, VkDeviceSize& offset, VkDeviceSize& reservedSize, uint32_t& order) {
+			if (strategy == STRATEGY_LINEAR) {
+				VkDeviceSize alignedOffset = alignUp(linearOffset, alignment);
+				if (alignedOffset + allocationSize > size) {
+					return false;
+				}
+				offset = alignedOffset;
+				//padding counts as used, it is lost until the block empties
+				reservedSize = alignedOffset + allocationSize - linearOffset;
+				linearOffset = alignedOffset + allocationSize;
+				order = 0;
+				return true;
+			}
+
+			//buddies of order n start at multiples of their size, so a big enough order is always aligned
+			VkDeviceSize needed = std::max({ allocationSize, alignment, MIN_BUDDY_SIZE });
+			uint32_t wantedOrder = 0;
+			while ((MIN_BUDDY_SIZE << wantedOrder) < needed) {
+				wantedOrder++;
+			}
+			if (wantedOrder > maxOrder()) {
+				return false;
+			}
+
+			uint32_t foundOrder = wantedOrder;
+			while (foundOrder <= maxOrder() && freeLists[foundOrder].empty()) {
+				foundOrder++;
+			}
+			if (foundOrder > maxOrder()) {
+				return false;
+			}
+
+			offset = *freeLists[foundOrder].begin();
+			freeLists[foundOrder].erase(freeLists[foundOrder].begin());
+			//split until it is the size we want, upper halves go to the free lists
+			while (foundOrder > wantedOrder) {
+				foundOrder--;
+				freeLists[foundOrder].insert(offset + (MIN_BUDDY_SIZE << foundOrder));
+			}
+			reservedSize = MIN_BUDDY_SIZE << wantedOrder;
+			order = wantedOrder;
+			return true;
+		}
+
+		void free(VkDeviceSize offset, uint32_t order) {
+			if (strategy == STRATEGY_LINEAR) {
+				//nothing is given back until the whole block is empty
+				if (allocationCount == 0) {
+					linearOffset = 0;
+					usedBytes = 0;
+				}
+				return;
+			}
+
+			//merge with the buddy as long as it is free
+			while (order < maxOrder()) {
+				VkDeviceSize buddy = offset ^ (MIN_BUDDY_SIZE << order);
+				if (freeLists[order].erase(buddy) == 0) {
+					break;
+				}
+				offset = std::min(offset, buddy);
+				order++;
+			}
+			freeLists[order].insert(offset);
+		}
+
+		VkDeviceSize largestFreeRange() const {
+			if (strategy == STRATEGY_LINEAR) {
+				return size - linearOffset;
+			}
+			for (uint32_t order = maxOrder() + 1; order > 0; order--) {
+				if (!freeLists[order - 1].empty()) {
+					return MIN_BUDDY_SIZE << (order - 1);
+				}
+			}
+			return 0;
+		}
+	};
+
+	MemoryAllocator::MemoryAllocator(VkDevice _device, VkPhysicalDevice _physicalDevice) : _device(_device), _physicalDevice(_physicalDevice) {
+		initialize();
+	}
+
+	void MemoryAllocator::initialize() {
+		vkGetPhysicalDeviceMemoryProperties(_physicalDevice, &memoryProperties);
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(_physicalDevice, &properties);
+		maxMemoryAllocationCount = properties.limits.maxMemoryAllocationCount;
+
+		std::cerr << "vulkan memoryallocator has initiated \n";
+	}
+
+	uint32_t MemoryAllocator::findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred) const {
+		//gpus have different heaps(vram, system ram visible to gpu, etc.) and types inside them
+		uint32_t bestType = UINT32_MAX;
+		int bestScore = -1;
+		for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+			VkMemoryPropertyFlags flags = memoryProperties.memoryTypes[i].propertyFlags;
+			if (!(typeBits & (1u << i)) || (flags & required) != required) {
+				continue;
+			}
+			//count preferred flags this type has
+			int score = 0;
+			for (VkMemoryPropertyFlags bits = flags & preferred; bits != 0; bits &= bits - 1) {
+				score++;
+			}
+			if (score > bestScore) {
+				bestScore = score;
+				bestType = i;
+			}
+		}
+
+		if (bestType == UINT32_MAX) {
+			throw std::runtime_error("failed to find suitable memory type!");
+		}
+		return bestType;
+	}
+
+	VkDeviceMemory MemoryAllocator::allocateMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void** ppMapped) {
+		if (memoryAllocationCount >= maxMemoryAllocationCount) {
+			throw std::runtime_error("reached maxMemoryAllocationCount!");
+		}
+
+		VkMemoryAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = size;
+		allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+		VkDeviceMemory memory;
+		if (vkAllocateMemory(_device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate device memory!");
+		}
+		memoryAllocationCount++;
+
+		//host visible memory stays mapped for its whole life, mapping is not free
+		*ppMapped = nullptr;
+		if (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+			if (vkMapMemory(_device, memory, 0, size, 0, ppMapped) != VK_SUCCESS) {
+				throw std::runtime_error("failed to map device memory!");
+			}
+		}
+		return memory;
+	}
+
+	MemoryAllocator::Block* MemoryAllocator::createBlock(uint32_t memoryTypeIndex, bool optimalImage, Strategy strategy) {
+		VkDeviceSize heapSize = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[memoryTypeIndex].heapIndex].size;
+
+		Block* pBlock = new Block();
+		//buddy needs a power of two
+		pBlock->size = std::max(MIN_BLOCK_SIZE, std::min(DEFAULT_BLOCK_SIZE, floorPowerOfTwo(heapSize / 8)));
+		pBlock->memoryTypeIndex = memoryTypeIndex;
+		pBlock->optimalImage = optimalImage;
+		pBlock->strategy = strategy;
+		pBlock->memory = allocateMemory(pBlock->size, memoryTypeIndex, &pBlock->pMapped);
+
+		if (strategy == STRATEGY_BUDDY) {
+			uint32_t orders = 1;
+			while ((MIN_BUDDY_SIZE << (orders - 1)) < pBlock->size) {
+				orders++;
+			}
+			pBlock->freeLists.resize(orders);
+			pBlock->freeLists[orders - 1].insert(0);
+		}
+
+		pBlocks.push_back(pBlock);
+		return pBlock;
+	}
+
+	void MemoryAllocator::destroyBlock(Block* pBlock) {
+		//freeing memory also unmaps it
+		vkFreeMemory(_device, pBlock->memory, nullptr);
+		memoryAllocationCount--;
+		pBlocks.erase(std::find(pBlocks.begin(), pBlocks.end(), pBlock));
+		delete pBlock;
+	}
+
+	MemoryAllocator::Allocation MemoryAllocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags required,
+		VkMemoryPropertyFlags preferred, bool optimalImage, Strategy strategy) {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		Allocation allocation{};
+		allocation.memoryTypeIndex = findMemoryType(requirements.memoryTypeBits, required, preferred);
+		allocation.size = requirements.size;
+
+		//buffers and optimal images never share a block, so neighbours are always the same kind
+		//and bufferImageGranularity(only applies between linear and optimal resources) never has to be padded for
+		VkDeviceSize alignment = std::max<VkDeviceSize>(requirements.alignment, 1);
+
+		//anything bigger than half a block gets its own memory
+		//so does lazily allocated memory, a block would commit for every image in it as soon as one of them is drawn to
+		VkDeviceSize heapSize = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[allocation.memoryTypeIndex].heapIndex].size;
+		VkDeviceSize blockSize = std::max(MIN_BLOCK_SIZE, std::min(DEFAULT_BLOCK_SIZE, floorPowerOfTwo(heapSize / 8)));
+		bool lazy = (memoryProperties.memoryTypes[allocation.memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) != 0;
+		if (requirements.size > blockSize / 2 || lazy) {
+			allocation.memory = allocateMemory(requirements.size, allocation.memoryTypeIndex, &allocation.pMapped);
+			dedicatedCount++;
+			dedicatedBytes += requirements.size;
+			return allocation;
+		}
+
+		VkDeviceSize reservedSize = 0;
+		for (Block* pBlock : pBlocks) {
+			if (pBlock->memoryTypeIndex != allocation.memoryTypeIndex || pBlock->optimalImage != optimalImage || pBlock->strategy != strategy) {
+				continue;
+			}
+			if (pBlock->allocate(requirements.size, alignment, allocation.offset, reservedSize, allocation.order)) {
+				allocation.pBlock = pBlock;
+				break;
+			}
+		}
+		if (allocation.pBlock == nullptr) {
+			Block* pBlock = createBlock(allocation.memoryTypeIndex, optimalImage, strategy);
+			if (!pBlock->allocate(requirements.size, alignment, allocation.offset, reservedSize, allocation.order)) {
+				throw std::runtime_error("failed to sub-allocate device memory!");
+			}
+			allocation.pBlock = pBlock;
+		}
+
+		allocation.pBlock->usedBytes += reservedSize;
+		allocation.pBlock->allocationCount++;
+		allocation.memory = allocation.pBlock->memory;
+		if (allocation.pBlock->pMapped != nullptr) {
+			allocation.pMapped = static_cast<char*>(allocation.pBlock->pMapped) + allocation.offset;
+		}
+		return allocation;
+	}
+
+	MemoryAllocator::Allocation MemoryAllocator::allocateBuffer(VkBuffer buffer, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, Strategy strategy) {
+		VkMemoryRequirements requirements;
+		vkGetBufferMemoryRequirements(_device, buffer, &requirements);
+
+		Allocation allocation = allocate(requirements, required, preferred, false, strategy);
+		if (vkBindBufferMemory(_device, buffer, allocation.memory, allocation.offset) != VK_SUCCESS) {
+			throw std::runtime_error("failed to bind buffer memory!");
+		}
+		return allocation;
+	}
+
+	MemoryAllocator::Allocation MemoryAllocator::allocateImage(VkImage image, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, Strategy strategy) {
+		VkMemoryRequirements requirements;
+		vkGetImageMemoryRequirements(_device, image, &requirements);
+
+		//every image made in this project is optimal tiled
+		Allocation allocation = allocate(requirements, required, preferred, true, strategy);
+		if (vkBindImageMemory(_device, image, allocation.memory, allocation.offset) != VK_SUCCESS) {
+			throw std::runtime_error("failed to bind image memory!");
+		}
+		return allocation;
+	}
+
+	bool MemoryAllocator::isLazilyAllocated(const Allocation& allocation) const {
+		return allocation.memory != VK_NULL_HANDLE &&
+			(memoryProperties.memoryTypes[allocation.memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) != 0;
+	}
+
+	void MemoryAllocator::free(Allocation& allocation) {
+		if (allocation.memory == VK_NULL_HANDLE) {
+			return;
+		}
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (allocation.pBlock == nullptr) {
+			vkFreeMemory(_device, allocation.memory, nullptr);
+			memoryAllocationCount--;
+			dedicatedCount--;
+			dedicatedBytes -= allocation.size;
+			allocation = Allocation{};
+			return;
+		}
+
+		Block* pBlock = allocation.pBlock;
+		pBlock->allocationCount--;
+		if (pBlock->strategy == STRATEGY_BUDDY) {
+			pBlock->usedBytes -= MIN_BUDDY_SIZE << allocation.order;
+		}
+		pBlock->free(allocation.offset, allocation.order);
+		allocation = Allocation{};
+
+		//empty blocks are given back unless it is the last one of its kind(avoids allocating again right away)
+		if (pBlock->allocationCount == 0) {
+			for (Block* pOther : pBlocks) {
+				if (pOther != pBlock && pOther->memoryTypeIndex == pBlock->memoryTypeIndex &&
+					pOther->optimalImage == pBlock->optimalImage && pOther->strategy == pBlock->strategy) {
+					destroyBlock(pBlock);
+					break;
+				}
+			}
+		}
+	}
+
+	MemoryAllocator::Statistics MemoryAllocator::getStatistics(Strategy strategy) const {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		Statistics statistics{};
+		for (const Block* pBlock : pBlocks) {
+			if (pBlock->strategy != strategy) {
+				continue;
+			}
+			statistics.blockCount++;
+			statistics.allocationCount += pBlock->allocationCount;
+			statistics.reservedBytes += pBlock->size;
+			statistics.usedBytes += pBlock->usedBytes;
+			statistics.largestFreeRange = std::max(statistics.largestFreeRange, pBlock->largestFreeRange());
+		}
+		statistics.dedicatedCount = dedicatedCount;
+		statistics.dedicatedBytes = dedicatedBytes;
+
+		VkDeviceSize freeBytes = statistics.reservedBytes - statistics.usedBytes;
+		if (freeBytes > 0) {
+			statistics.fragmentation = 1.0f - static_cast<float>(statistics.largestFreeRange) / static_cast<float>(freeBytes);
+		}
+		return statistics;
+	}
+
+	void MemoryAllocator::printStatistics() const {
+		const char* names[] = { "buddy", "linear" };
+		for (int strategy = STRATEGY_BUDDY; strategy <= STRATEGY_LINEAR; strategy++) {
+			Statistics statistics = getStatistics(static_cast<Strategy>(strategy));
+			std::cerr << "memory " << names[strategy] << ": " << statistics.allocationCount << " allocations in " << statistics.blockCount
+				<< " blocks, " << statistics.usedBytes << "/" << statistics.reservedBytes << " bytes used, largest free range "
+				<< statistics.largestFreeRange << " bytes, fragmentation " << statistics.fragmentation << "\n";
+		}
+		std::cerr << "memory dedicated: " << dedicatedCount << " allocations, " << dedicatedBytes << " bytes, "
+			<< memoryAllocationCount << "/" << maxMemoryAllocationCount << " vkAllocateMemory calls in use \n";
+	}
+
+	void MemoryAllocator::destroy() {
+		if (!pBlocks.empty()) {
+			printStatistics();
+		}
+		while (!pBlocks.empty()) {
+			destroyBlock(pBlocks.back());
+		}
+	}
+
+	MemoryAllocator::~MemoryAllocator() {
+		destroy();
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include "UtilHeader.h"
+#include <mutex>
+
+namespace one {
+	//sub-allocates buffers and images from big VkDeviceMemory blocks
+	//vulkan limits the number of vkAllocateMemory calls(maxMemoryAllocationCount, often 4096)
+	//and every allocation has a cost, so one allocation per resource doesnt scale
+	class MemoryAllocator : NonCopyable
+	{
+	public:
+
+		enum Strategy {
+			//power of two splits, any allocation can be freed on its own and neighbours merge back
+			STRATEGY_BUDDY,
+			//bump pointer, very cheap, the block only becomes free again when every allocation in it was freed
+			//good for resources that live and die together(per level, per load)
+			STRATEGY_LINEAR
+		};
+
+		struct Block;
+
+		struct Allocation {
+			VkDeviceMemory memory{ VK_NULL_HANDLE };
+			VkDeviceSize offset = 0;
+			VkDeviceSize size = 0;
+			//persistently mapped pointer to offset, nullptr if memory is not host visible
+			void* pMapped = nullptr;
+			uint32_t memoryTypeIndex = 0;
+
+			//owner block, nullptr for dedicated allocations(too big for a block)
+			Block* pBlock = nullptr;
+			//buddy order the allocation was taken from
+			uint32_t order = 0;
+		};
+
+		struct Statistics {
+			uint32_t blockCount = 0;
+			uint32_t dedicatedCount = 0;
+			uint32_t allocationCount = 0;
+			VkDeviceSize reservedBytes = 0;//vkAllocateMemory'd in blocks
+			VkDeviceSize usedBytes = 0;//handed out from blocks(with alignment padding)
+			VkDeviceSize dedicatedBytes = 0;
+			VkDeviceSize largestFreeRange = 0;
+			//1 - largest free range / total free, 0 means all free memory is in one piece
+			float fragmentation = 0.0f;
+		};
+
+		MemoryAllocator(VkDevice _device, VkPhysicalDevice _physicalDevice);
+		~MemoryAllocator();
+
+		void initialize();
+		void destroy();
+
+		//memory type with all required flags, the one with most preferred flags wins
+		uint32_t findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred) const;
+
+		//optimalImage separates optimal tiled images from buffers/linear images so bufferImageGranularity never applies inside a block
+		Allocation allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred,
+			bool optimalImage, Strategy strategy);
+		//allocate and bind
+		Allocation allocateBuffer(VkBuffer buffer, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, Strategy strategy);
+		Allocation allocateImage(VkImage image, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, Strategy strategy);
+		void free(Allocation& allocation);
+
+		//true if the memory is only committed when the gpu actually needs it(transient attachments on tile based gpus)
+		bool isLazilyAllocated(const Allocation& allocation) const;
+
+		Statistics getStatistics(Strategy strategy) const;
+		void printStatistics() const;
+
+	private:
+
+		Block* createBlock(uint32_t memoryTypeIndex, bool optimalImage, Strategy strategy);
+		void destroyBlock(Block* pBlock);
+		VkDeviceMemory allocateMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void** ppMapped);
+
+		VkDevice _device;
+
+		VkPhysicalDevice _physicalDevice;
+
+		VkPhysicalDeviceMemoryProperties memoryProperties;
+
+		uint32_t maxMemoryAllocationCount = 0;
+
+		uint32_t memoryAllocationCount = 0;
+
+		std::vector<Block*> pBlocks;
+
+		//dedicated allocations are counted for the statistics
+		uint32_t dedicatedCount = 0;
+		VkDeviceSize dedicatedBytes = 0;
+
+		//uploads may be prepared on other threads
+		mutable std::mutex mutex;
+
+	};
+}
@@ -0,0 +1,137 @@
+#include "MeshArena.h"
+#include <cstddef>
+
+namespace one {
+	VkVertexInputBindingDescription Vertex::getBindingDescription() {
+		//all attributes interleaved in one buffer, advancing per vertex(not per instance)
+		VkVertexInputBindingDescription bindingDescription{};
+		bindingDescription.binding = 0;
+		bindingDescription.stride = sizeof(Vertex);
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+		return bindingDescription;
+	}
+
+	std::array<VkVertexInputAttributeDescription, 1> Vertex::getAttributeDescriptions() {
+		std::array<VkVertexInputAttributeDescription, 1> attributeDescriptions{};
+		//location matches layout(location = x) in shader.vert, unpacked there
+		attributeDescriptions[0].binding = 0;
+		attributeDescriptions[0].location = 0;
+		attributeDescriptions[0].format = VK_FORMAT_R32_UINT;
+		attributeDescriptions[0].offset = offsetof(Vertex, packed);
+		return attributeDescriptions;
+	}
+
+	//takes count elements from the first free range big enough, false if none is
+	static bool allocateRange(std::map<uint32_t, uint32_t>& freeRanges, uint32_t count, uint32_t& first) {
+		for (auto it = freeRanges.begin(); it != freeRanges.end(); it++) {
+			if (it->second >= count) {
+				first = it->first;
+				uint32_t remaining = it->second - count;
+				freeRanges.erase(it);
+				if (remaining > 0) {
+					freeRanges[first + count] = remaining;
+				}
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//gives count elements at first back and merges them with the free ranges around
+	static void freeRange(std::map<uint32_t, uint32_t>& freeRanges, uint32_t first, uint32_t count) {
+		auto next = freeRanges.lower_bound(first);
+		if (next != freeRanges.end() && first + count == next->first) {
+			count += next->second;
+			next = freeRanges.erase(next);
+		}
+		if (next != freeRanges.begin()) {
+			auto previous = std::prev(next);
+			if (previous->first + previous->second == first) {
+				previous->second += count;
+				return;
+			}
+		}
+		freeRanges[first] = count;
+	}
+
+	MeshArena::MeshArena(Device* pDevice, uint32_t vertexCapacity, uint32_t indexCapacity) : pDevice(pDevice) {
+		initialize(vertexCapacity, indexCapacity);
+	}
+
+	void MeshArena::initialize(uint32_t vertexCapacity, uint32_t indexCapacity) {
+		//device local is not host visible on discrete gpus, so it can only be written by a copy
+		pVertexBuffer = new Buffer(pDevice, sizeof(Vertex) * static_cast<VkDeviceSize>(vertexCapacity),
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0);
+		pIndexBuffer = new Buffer(pDevice, sizeof(uint32_t) * static_cast<VkDeviceSize>(indexCapacity),
+			VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0);
+
+		freeVertices[0] = vertexCapacity;
+		freeIndices[0] = indexCapacity;
+
+		std::cerr << "mesh arena has initiated with room for " << vertexCapacity << " vertices and " << indexCapacity << " indices \n";
+	}
+
+	MeshArena::Allocation MeshArena::allocate(StagingRing* pStagingRing, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices) {
+		Allocation allocation;
+		allocation.vertexCount = static_cast<uint32_t>(vertices.size());
+		allocation.indexCount = static_cast<uint32_t>(indices.size());
+
+		if (!allocateRange(freeVertices, allocation.vertexCount, allocation.firstVertex)) {
+			throw std::runtime_error("failed to allocate vertices from mesh arena!");
+		}
+		if (!allocateRange(freeIndices, allocation.indexCount, allocation.firstIndex)) {
+			freeRange(freeVertices, allocation.firstVertex, allocation.vertexCount);
+			throw std::runtime_error("failed to allocate indices from mesh arena!");
+		}
+		usedVertices += allocation.vertexCount;
+		usedIndices += allocation.indexCount;
+
+		pStagingRing->upload(pVertexBuffer->getBuffer(), sizeof(Vertex) * static_cast<VkDeviceSize>(allocation.firstVertex),
+			vertices.data(), sizeof(Vertex) * vertices.size(),
+			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+		pStagingRing->upload(pIndexBuffer->getBuffer(), sizeof(uint32_t) * static_cast<VkDeviceSize>(allocation.firstIndex),
+			indices.data(), sizeof(uint32_t) * indices.size(),
+			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT);
+
+		return allocation;
+	}
+
+	void MeshArena::free(const Allocation& allocation) {
+		if (allocation.vertexCount > 0) {
+			freeRange(freeVertices, allocation.firstVertex, allocation.vertexCount);
+		}
+		if (allocation.indexCount > 0) {
+			freeRange(freeIndices, allocation.firstIndex, allocation.indexCount);
+		}
+		usedVertices -= allocation.vertexCount;
+		usedIndices -= allocation.indexCount;
+	}
+
+	void MeshArena::bind(VkCommandBuffer commandBuffer) const {
+		VkBuffer vertexBuffers[] = { pVertexBuffer->getBuffer() };
+		VkDeviceSize offsets[] = { 0 };
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+		vkCmdBindIndexBuffer(commandBuffer, pIndexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+	}
+
+	void MeshArena::destroy() {
+		if (pVertexBuffer != nullptr) {
+			pVertexBuffer->destroy();
+			delete pVertexBuffer;
+			pVertexBuffer = nullptr;
+		}
+		if (pIndexBuffer != nullptr) {
+			pIndexBuffer->destroy();
+			delete pIndexBuffer;
+			pIndexBuffer = nullptr;
+		}
+		freeVertices.clear();
+		freeIndices.clear();
+		usedVertices = 0;
+		usedIndices = 0;
+	}
+
+	MeshArena::~MeshArena() {
+		destroy();
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "UtilHeader.h"
+#include <array>
+#include <map>
+#include "Buffer.h"
+#include "StagingRing.h"
+
+namespace one {
+	//layout of one vertex as the vertex shader reads it(binding 0)
+	//voxel vertices sit on integer corners of a chunk, so everything fits in 32 bits:
+	//bits 0-17 position inside the chunk(6 bits per axis, 0 to 32), 18-20 face(normal), 21-28 block id
+	//the chunk origin comes from the per instance binding(see ChunkCuller)
+	struct Vertex {
+		uint32_t packed;
+
+		static inline Vertex pack(uint32_t x, uint32_t y, uint32_t z, uint32_t face, uint32_t block) {
+			return { x | (y << 6) | (z << 12) | (face << 18) | (block << 21) };
+		}
+
+		static VkVertexInputBindingDescription getBindingDescription();
+		static std::array<VkVertexInputAttributeDescription, 1> getAttributeDescriptions();
+	};
+
+	//one device local vertex buffer and one index buffer every chunk mesh is sub-allocated from
+	//a single indirect draw can't switch buffers, so all chunks have to share them to be drawn by one
+	//indices stay local to their mesh, the draw's vertexOffset points them at the mesh vertices
+	class MeshArena : NonCopyable
+	{
+	public:
+
+		//where a mesh lives in the arena, counted in vertices and indices
+		struct Allocation {
+			uint32_t firstVertex = 0;
+			uint32_t vertexCount = 0;
+			uint32_t firstIndex = 0;
+			uint32_t indexCount = 0;
+		};
+
+		MeshArena(Device* pDevice, uint32_t vertexCapacity, uint32_t indexCapacity);
+		~MeshArena();
+
+		void initialize(uint32_t vertexCapacity, uint32_t indexCapacity);
+		void destroy();
+
+		//reserves room for the mesh and uploads it through the staging ring, throws when the arena is full
+		Allocation allocate(StagingRing* pStagingRing, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+		//the ranges can be handed out again right away, no pending draw may read them anymore
+		void free(const Allocation& allocation);
+
+		//vertices to binding 0 and the indices
+		void bind(VkCommandBuffer commandBuffer) const;
+
+		inline uint32_t getUsedVertices(void) const {
+			return usedVertices;
+		}
+
+		inline uint32_t getUsedIndices(void) const {
+			return usedIndices;
+		}
+
+	private:
+
+		Device* pDevice;
+
+		Buffer* pVertexBuffer{ nullptr };
+		Buffer* pIndexBuffer{ nullptr };
+
+		//free ranges by first element(first fit), neighbours merge back when freed
+		std::map<uint32_t, uint32_t> freeVertices;
+		std::map<uint32_t, uint32_t> freeIndices;
+
+		uint32_t usedVertices = 0;
+		uint32_t usedIndices = 0;
+
+	};
+}
@@ -0,0 +1,54 @@
+#include "OffscreenTarget.h"
+
+namespace one {
+	OffscreenTarget::OffscreenTarget(Device* pDevice, VkFormat format, VkExtent2D extent) : _device(pDevice->getDevice()), pDevice(pDevice) {
+		initialize(format, extent);
+	}
+
+	void OffscreenTarget::initialize(VkFormat format, VkExtent2D extent) {
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.format = format;
+		imageInfo.extent.width = extent.width;
+		imageInfo.extent.height = extent.height;
+		imageInfo.extent.depth = 1;
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		//optimal lets the gpu lay texels out however it wants, we copy to a buffer to read it
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		//rendered to like a swapchain image and copied out for readback
+		imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		if (vkCreateImage(_device, &imageInfo, nullptr, &image) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create offscreen image!");
+		}
+
+		//render targets are recreated on resize, buddy gives the space back one by one
+		imageMemory = pDevice->getMemoryAllocator()->allocateImage(image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, MemoryAllocator::STRATEGY_BUDDY);
+
+		pImageView = new ImageView(_device, image, format);
+
+		std::cerr << "vulkan offscreentarget has initiated \n";
+	}
+
+	void OffscreenTarget::destroy() {
+		if (pImageView != nullptr) {
+			pImageView->destroy(_device);
+			delete pImageView;
+			pImageView = nullptr;
+		}
+		if (image != VK_NULL_HANDLE) {
+			vkDestroyImage(_device, image, nullptr);
+			image = VK_NULL_HANDLE;
+		}
+		pDevice->getMemoryAllocator()->free(imageMemory);
+	}
+
+	OffscreenTarget::~OffscreenTarget() {
+		destroy();
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "UtilHeader.h"
+#include "Device.h"
+#include "ImageView.h"
+
+namespace one {
+	//color image rendered to instead of a swapchain image(headless rendering, no surface needed)
+	class OffscreenTarget : NonCopyable
+	{
+	public:
+
+		OffscreenTarget(Device* pDevice, VkFormat format, VkExtent2D extent);
+		~OffscreenTarget();
+
+		void initialize(VkFormat format, VkExtent2D extent);
+		void destroy();
+
+		inline VkImage getImage(void) const {
+			return image;
+		}
+
+		inline VkImageView getImageView(void) const {
+			return pImageView->getImageView();
+		}
+
+	private:
+
+		VkDevice _device;
+
+		Device* pDevice;
+
+		VkImage image{ VK_NULL_HANDLE };
+
+		MemoryAllocator::Allocation imageMemory;
+
+		ImageView* pImageView{ nullptr };
+
+	};
+}
@@ -0,0 +1,97 @@
+#include "ParallelRecorder.h"
+#include "ChunkCuller.h"
+#include <algorithm>
+
+namespace one {
+	ParallelRecorder::ParallelRecorder(VkDevice _device, uint32_t queueFamilyIndex, JobSystem* pJobSystem, uint32_t framesInFlight) :
+		_device(_device), pJobSystem(pJobSystem), framesInFlight(framesInFlight) {
+		initialize(queueFamilyIndex);
+	}
+
+	void ParallelRecorder::initialize(uint32_t queueFamilyIndex) {
+		uint32_t threadCount = pJobSystem->getWorkerCount() + 1;
+		threadPools.resize(framesInFlight);
+		for (uint32_t frame = 0; frame < framesInFlight; frame++) {
+			threadPools[frame].resize(threadCount);
+			for (uint32_t thread = 0; thread < threadCount; thread++) {
+				//buffers are recorded once per frame and freed by resetting the whole pool
+				threadPools[frame][thread].pCommandPool = new CommandPool(_device, queueFamilyIndex, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+			}
+		}
+
+		std::cerr << "parallel recorder has initiated with " << threadCount << " pools per frame \n";
+	}
+
+	const std::vector<VkCommandBuffer>& ParallelRecorder::record(uint32_t frame, VkFramebuffer frameBuffer, VkRenderPass renderPass,
+		VkPipeline depthPrepassPipeline, VkPipeline graphicsPipeline, VkPipeline farFieldPipeline, VkPipelineLayout pipelineLayout, const BindlessTable* pBindlessTable,
+		const UniformRing* pUniformRing, uint32_t uniformRegion, uint32_t uniformOffset, VkExtent2D extent, const PushConstants& pushConstants,
+		const ChunkCuller* pChunkCuller, uint32_t cullTarget) {
+
+		//the gpu is done with this slot, one reset per pool instead of one per buffer
+		for (ThreadPool& threadPool : threadPools[frame]) {
+			threadPool.pCommandPool->reset();
+			threadPool.used = 0;
+		}
+
+		//at most one batch per recording thread, and none smaller than MIN_DRAWS_PER_BATCH
+		//a single indirect call for every chunk is always one batch
+		size_t drawCallCount = pChunkCuller->getDrawCallCount(cullTarget);
+		size_t threadCount = threadPools[frame].size();
+		size_t batchCount = std::min(threadCount, (drawCallCount + MIN_DRAWS_PER_BATCH - 1) / MIN_DRAWS_PER_BATCH);
+		batchCount = std::max<size_t>(batchCount, 1);
+		size_t batchSize = (drawCallCount + batchCount - 1) / batchCount;
+
+		secondaryCommandBuffers.assign(batchCount, VK_NULL_HANDLE);
+		std::vector<JobSystem::Job*> pJobs(batchCount);
+		for (size_t batch = 0; batch < batchCount; batch++) {
+			size_t first = std::min(batch * batchSize, drawCallCount);
+			size_t count = std::min(batchSize, drawCallCount - first);
+			//the far field goes behind every chunk, only the last batch draws it
+			VkPipeline batchFarFieldPipeline = batch + 1 == batchCount ? farFieldPipeline : VK_NULL_HANDLE;
+			pJobs[batch] = pJobSystem->create([this, frame, frameBuffer, renderPass, depthPrepassPipeline, graphicsPipeline, batchFarFieldPipeline, pipelineLayout, pBindlessTable, pUniformRing, uniformRegion, uniformOffset, extent, first, count, batch, pChunkCuller, cullTarget, &pushConstants]() {
+				CommandBuffer* pCommandBuffer = nextCommandBuffer(frame);
+				//each batch lays down its own depth before shading, a later batch can still cover it(correct, just some overdraw)
+				pCommandBuffer->recordSecondary(frameBuffer, renderPass, depthPrepassPipeline, graphicsPipeline, batchFarFieldPipeline, pipelineLayout, pBindlessTable,
+					pUniformRing, uniformRegion, uniformOffset, extent, pushConstants, pChunkCuller, cullTarget, static_cast<uint32_t>(first), static_cast<uint32_t>(count));
+				//each job writes its own slot, order is the batch order not the finishing order
+				secondaryCommandBuffers[batch] = pCommandBuffer->getCommandBuffer();
+			});
+			pJobSystem->submit(pJobs[batch]);
+		}
+
+		//the calling thread records batches too while it waits
+		for (JobSystem::Job* pJob : pJobs) {
+			pJobSystem->wait(pJob);
+			pJobSystem->release(pJob);
+		}
+
+		return secondaryCommandBuffers;
+	}
+
+	CommandBuffer* ParallelRecorder::nextCommandBuffer(uint32_t frame) {
+		ThreadPool& threadPool = threadPools[frame][JobSystem::getCurrentWorkerIndex() + 1];
+		if (threadPool.used == threadPool.pCommandBuffers.size()) {
+			threadPool.pCommandBuffers.push_back(new CommandBuffer(_device, threadPool.pCommandPool->getCommandPool(), VK_COMMAND_BUFFER_LEVEL_SECONDARY));
+		}
+		return threadPool.pCommandBuffers[threadPool.used++];
+	}
+
+	void ParallelRecorder::destroy() {
+		for (auto& framePools : threadPools) {
+			for (ThreadPool& threadPool : framePools) {
+				//freed with the command pool
+				for (CommandBuffer* pCommandBuffer : threadPool.pCommandBuffers) {
+					delete pCommandBuffer;
+				}
+				threadPool.pCommandPool->destroy();
+				delete threadPool.pCommandPool;
+			}
+		}
+		threadPools.clear();
+		secondaryCommandBuffers.clear();
+	}
+
+	ParallelRecorder::~ParallelRecorder() {
+		destroy();
+	}
+}
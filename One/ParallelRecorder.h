@@ -0,0 +1,57 @@
+#pragma once
+#include "UtilHeader.h"
+#include "CommandBuffer.h"
+#include "CommandPool.h"
+#include "JobSystem.h"
+
+namespace one {
+	//records the chunk draws into secondary command buffers on the job system workers
+	//a command pool may only be used by one thread at a time, so every recording thread(workers + the
+	//calling thread) gets its own pool per frame slot and the pools of a slot are reset together
+	class ParallelRecorder : NonCopyable
+	{
+	public:
+
+		//draws below this are not worth a secondary buffer of their own
+		static const uint32_t MIN_DRAWS_PER_BATCH = 64;
+
+		ParallelRecorder(VkDevice _device, uint32_t queueFamilyIndex, JobSystem* pJobSystem, uint32_t framesInFlight);
+		~ParallelRecorder();
+
+		void initialize(uint32_t queueFamilyIndex);
+		void destroy();
+
+		//splits the draw calls of cullTarget into batches, records each on a worker and waits for all of them
+		//the fence of frame must have been waited on, its pools are reset here
+		//the far field is drawn by the last buffer, behind every chunk
+		//returns the secondary buffers in draw order, valid until frame is recorded again
+		const std::vector<VkCommandBuffer>& record(uint32_t frame, VkFramebuffer frameBuffer, VkRenderPass renderPass,
+			VkPipeline depthPrepassPipeline, VkPipeline graphicsPipeline, VkPipeline farFieldPipeline, VkPipelineLayout pipelineLayout, const BindlessTable* pBindlessTable,
+			const UniformRing* pUniformRing, uint32_t uniformRegion, uint32_t uniformOffset, VkExtent2D extent, const PushConstants& pushConstants,
+			const ChunkCuller* pChunkCuller, uint32_t cullTarget);
+
+	private:
+
+		//pool of one recording thread for one frame slot, buffers are kept and reused after the pool reset
+		struct ThreadPool {
+			CommandPool* pCommandPool;
+			std::vector<CommandBuffer*> pCommandBuffers;
+			uint32_t used = 0;
+		};
+
+		//next free secondary buffer of the calling thread's pool
+		CommandBuffer* nextCommandBuffer(uint32_t frame);
+
+		VkDevice _device;
+
+		JobSystem* pJobSystem;
+
+		const uint32_t framesInFlight;
+
+		//[frame][thread], thread 0 is any thread outside the job system, worker i is i + 1
+		std::vector<std::vector<ThreadPool>> threadPools;
+
+		std::vector<VkCommandBuffer> secondaryCommandBuffers;
+
+	};
+}
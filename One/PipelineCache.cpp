@@ -0,0 +1,130 @@
+#include "PipelineCache.h"
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+
+namespace one {
+	PipelineCache::PipelineCache(VkDevice _device, VkPhysicalDevice _physicalDevice, const std::string& filePath) :
+		_device(_device), _physicalDevice(_physicalDevice), filePath(filePath) {
+		initialize();
+	}
+
+	//pipeline cache stores the compiled pipelines of the driver so next creations(and next launches) skip compiling
+	//one cache is shared by every pipeline creation, vulkan caches are internally synchronized
+	void PipelineCache::initialize() {
+		std::vector<char> data = loadFromDisk();
+		if (!data.empty() && !validateHeader(data)) {
+			std::cerr << "pipeline cache on disk is corrupt or belongs to another device or driver, starting empty \n";
+			data.clear();
+		}
+		warm = !data.empty();
+
+		VkPipelineCacheCreateInfo cacheInfo{};
+		cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		cacheInfo.initialDataSize = data.size();
+		cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+		if (vkCreatePipelineCache(_device, &cacheInfo, nullptr, &pipelineCache) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create pipeline cache!");
+		}
+
+		std::cerr << "vulkan pipelinecache has initiated (" << (warm ? "warm, " : "cold, ") << data.size() << " bytes) \n";
+	}
+
+	std::vector<char> PipelineCache::loadFromDisk() const {
+		//missing file is normal on first launch, so no throwing here
+		std::ifstream file(filePath, std::ios::ate | std::ios::binary);
+		if (!file.is_open()) {
+			return {};
+		}
+
+		size_t fileSize = (size_t)file.tellg();
+		std::vector<char> buffer(fileSize);
+		file.seekg(0);
+		file.read(buffer.data(), fileSize);
+		if (!file) {
+			return {};
+		}
+		return buffer;
+	}
+
+	bool PipelineCache::validateHeader(const std::vector<char>& data) const {
+		//the blob starts with a header, the driver also checks it but some drivers crash on garbage
+		VkPipelineCacheHeaderVersionOne header{};
+		if (data.size() < sizeof(header)) {
+			return false;
+		}
+		std::memcpy(&header, data.data(), sizeof(header));
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(_physicalDevice, &properties);
+
+		//a truncated or corrupt file can claim a header that is smaller than the fixed one or runs past the data
+		return header.headerSize >= sizeof(header) && header.headerSize <= data.size() &&
+			header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+			header.vendorID == properties.vendorID &&
+			header.deviceID == properties.deviceID &&
+			std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+	}
+
+	void PipelineCache::recordCreation(double milliseconds) {
+		creationCount++;
+		creationMilliseconds += milliseconds;
+	}
+
+	void PipelineCache::save() {
+		if (pipelineCache == VK_NULL_HANDLE) {
+			return;
+		}
+
+		size_t dataSize = 0;
+		if (vkGetPipelineCacheData(_device, pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0) {
+			std::cerr << "failed to get pipeline cache data, not saving \n";
+			return;
+		}
+		std::vector<char> data(dataSize);
+		if (vkGetPipelineCacheData(_device, pipelineCache, &dataSize, data.data()) != VK_SUCCESS) {
+			std::cerr << "failed to get pipeline cache data, not saving \n";
+			return;
+		}
+
+		//write to a temporary file and rename it over the old one, 
+		//a crash while saving never leaves a half written cache behind
+		std::string tempPath = filePath + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open()) {
+				std::cerr << "failed to open " << tempPath << ", pipeline cache not saved \n";
+				return;
+			}
+			file.write(data.data(), dataSize);
+			if (!file) {
+				std::cerr << "failed to write " << tempPath << ", pipeline cache not saved \n";
+				return;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(tempPath, filePath, error);
+		if (error) {
+			std::cerr << "failed to replace " << filePath << ": " << error.message() << "\n";
+			std::filesystem::remove(tempPath, error);
+			return;
+		}
+
+		std::cerr << "pipeline cache saved (" << dataSize << " bytes) \n";
+	}
+
+	void PipelineCache::destroy() {
+		if (pipelineCache != VK_NULL_HANDLE) {
+			std::cerr << "pipeline creation: " << creationCount << " pipelines in " << creationMilliseconds << " ms with a " << (warm ? "warm" : "cold") << " cache \n";
+			save();
+			vkDestroyPipelineCache(_device, pipelineCache, nullptr);
+			pipelineCache = VK_NULL_HANDLE;
+		}
+	}
+
+	PipelineCache::~PipelineCache() {
+		destroy();
+	}
+}
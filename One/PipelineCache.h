@@ -0,0 +1,45 @@
+#pragma once
+#include "UtilHeader.h"
+#include <string>
+
+namespace one {
+	class PipelineCache : NonCopyable
+	{
+	public:
+
+		PipelineCache(VkDevice _device, VkPhysicalDevice _physicalDevice, const std::string& filePath);
+		~PipelineCache();
+
+		void initialize();
+		//writes the cache back to disk(atomically) and destroys it
+		void destroy();
+		void save();
+
+		//every pipeline creation reports here how long it took so we can compare cold and warm starts
+		void recordCreation(double milliseconds);
+
+		inline VkPipelineCache getPipelineCache(void) const {
+			return pipelineCache;
+		}
+
+	private:
+
+		//false if the blob was written by another driver/device or is corrupted
+		bool validateHeader(const std::vector<char>& data) const;
+		std::vector<char> loadFromDisk() const;
+
+		VkDevice _device;
+
+		VkPhysicalDevice _physicalDevice;
+
+		VkPipelineCache pipelineCache{ VK_NULL_HANDLE };
+
+		std::string filePath;
+
+		//timings
+		bool warm = false;
+		uint32_t creationCount = 0;
+		double creationMilliseconds = 0.0;
+
+	};
+}
@@ -1,4 +1,5 @@
 #include "Queue.h"
+#include <algorithm>
 
 
 namespace one {
@@ -6,27 +7,139 @@ namespace one {
 
 	}
 
-	bool Queue::initialize(VkDevice _device) {
+	bool Queue::initialize(VkDevice _device, bool timelineSemaphores) {
 		Queue::_device = _device;
 		vkGetDeviceQueue(_device, familyIndex, 0, &queue);
 		initializeCommandPool();
+		if (timelineSemaphores) {
+			//nothing submitted yet, so 0 counts as done
+			pTimeline = new TimelineSemaphore(_device, 0);
+		}
 
 		std::cerr << "vulkan queue has initiated \n";
 		return true;
 	}
 
-	void Queue::submit(VkSubmitInfo submitInfo, Fence* fence) {
-		//ended here(add queue submit to queue object and fix queue structure thingy
-		if (vkQueueSubmit(queue, 1, &submitInfo, fence->getFence()) != VK_SUCCESS) {
+	uint64_t Queue::submit(VkSubmitInfo submitInfo, const std::vector<TimelineWait>& timelineWaits) {
+		uint64_t value = submittedValue + 1;
+
+		if (pTimeline == nullptr) {
+			//binary semaphores can only be signaled once per wait, they cant express values
+			if (!timelineWaits.empty()) {
+				throw std::runtime_error("failed to submit, timeline waits need timeline semaphores!");
+			}
+			//the transfer and compute queues may never be asked for their values, the finished fences are recycled here
+			//or every submit would create another one
+			getCompletedValue();
+			Fence* pFence = nullptr;
+			if (!pFreeFences.empty()) {
+				pFence = pFreeFences.back();
+				pFreeFences.pop_back();
+			}
+			else {
+				pFence = new Fence(_device);
+			}
+			//created signaled and recycled signaled
+			if (!pFence->resetFence()) {
+				throw std::runtime_error("failed to reset submit fence!");
+			}
+			if (vkQueueSubmit(queue, 1, &submitInfo, pFence->getFence()) != VK_SUCCESS) {
+				throw std::runtime_error("failed to submit draw command buffer to queue!");
+			}
+			pendingFences.push_back({ value, pFence });
+			submittedValue = value;
+			return value;
+		}
+
+		//binary semaphores keep their slots, their values are ignored
+		std::vector<VkSemaphore> waitSemaphores(submitInfo.pWaitSemaphores, submitInfo.pWaitSemaphores + submitInfo.waitSemaphoreCount);
+		std::vector<VkPipelineStageFlags> waitStages(submitInfo.pWaitDstStageMask, submitInfo.pWaitDstStageMask + submitInfo.waitSemaphoreCount);
+		std::vector<uint64_t> waitValues(submitInfo.waitSemaphoreCount, 0);
+		for (const TimelineWait& timelineWait : timelineWaits) {
+			waitSemaphores.push_back(timelineWait.pQueue->pTimeline->getSemaphore());
+			waitStages.push_back(timelineWait.stage);
+			waitValues.push_back(timelineWait.value);
+		}
+		std::vector<VkSemaphore> signalSemaphores(submitInfo.pSignalSemaphores, submitInfo.pSignalSemaphores + submitInfo.signalSemaphoreCount);
+		std::vector<uint64_t> signalValues(submitInfo.signalSemaphoreCount, 0);
+		signalSemaphores.push_back(pTimeline->getSemaphore());
+		signalValues.push_back(value);
+
+		VkTimelineSemaphoreSubmitInfoKHR timelineInfo{};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+		timelineInfo.pNext = submitInfo.pNext;
+		timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+		timelineInfo.pWaitSemaphoreValues = waitValues.data();
+		timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size());
+		timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+		submitInfo.pWaitSemaphores = waitSemaphores.data();
+		submitInfo.pWaitDstStageMask = waitStages.data();
+		submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
+		submitInfo.pSignalSemaphores = signalSemaphores.data();
+
+		if (vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
 			throw std::runtime_error("failed to submit draw command buffer to queue!");
 		}
+		submittedValue = value;
+		return value;
 	}
 
-	void Queue::present(VkPresentInfoKHR presentInfo) {
+	bool Queue::waitForValue(uint64_t value, uint64_t timeout) {
+		if (pTimeline != nullptr) {
+			return pTimeline->wait(value, timeout);
+		}
 
-		if (vkQueuePresentKHR(queue, &presentInfo) != VK_SUCCESS) {
+		if (value <= completedValue) {
+			return true;
+		}
+		//a fence covers every submission before it on the queue, the first one at or after value is enough
+		for (const PendingFence& pendingFence : pendingFences) {
+			if (pendingFence.value >= value) {
+				if (!pendingFence.pFence->waitForFence(timeout)) {
+					return false;
+				}
+				retireFences(pendingFence.value);
+				return true;
+			}
+		}
+		throw std::runtime_error("failed to wait, value was never submitted!");
+	}
+
+	uint64_t Queue::getCompletedValue(void) {
+		if (pTimeline != nullptr) {
+			return pTimeline->getValue();
+		}
+
+		uint64_t finished = completedValue;
+		for (const PendingFence& pendingFence : pendingFences) {
+			if (!pendingFence.pFence->isSignaled()) {
+				break;
+			}
+			finished = pendingFence.value;
+		}
+		retireFences(finished);
+		return completedValue;
+	}
+
+	void Queue::retireFences(uint64_t value) {
+		while (!pendingFences.empty() && pendingFences.front().value <= value) {
+			pFreeFences.push_back(pendingFences.front().pFence);
+			pendingFences.pop_front();
+		}
+		completedValue = std::max(completedValue, value);
+	}
+
+	VkResult Queue::present(VkPresentInfoKHR presentInfo) {
+
+		VkResult result = vkQueuePresentKHR(queue, &presentInfo);
+		//out of date and suboptimal are not failures, the owner of the swapchain has to recreate it
+		if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR && result != VK_ERROR_OUT_OF_DATE_KHR) {
 			throw std::runtime_error("failed to present image from queue!");
 		}
+		return result;
 	}
 
 	void Queue::initializeCommandPool() {
@@ -35,9 +148,28 @@ namespace one {
 	}
 
 	void Queue::destroy() {
+		//owner waits for the device to be idle first
+		for (const PendingFence& pendingFence : pendingFences) {
+			pFreeFences.push_back(pendingFence.pFence);
+		}
+		pendingFences.clear();
+		for (Fence* pFence : pFreeFences) {
+			pFence->destroy();
+			delete pFence;
+		}
+		pFreeFences.clear();
+		if (pTimeline != nullptr) {
+			pTimeline->destroy();
+			delete pTimeline;
+			pTimeline = nullptr;
+		}
+
 		//destroyed with physical device
-		pCommandPool->destroy();
-		delete pCommandPool;
+		if (pCommandPool != nullptr) {
+			pCommandPool->destroy();
+			delete pCommandPool;
+			pCommandPool = nullptr;
+		}
 	}
 
 	Queue::~Queue() {
@@ -2,6 +2,8 @@
 #include "UtilHeader.h"
 #include "CommandPool.h"
 #include "Fence.h"
+#include "TimelineSemaphore.h"
+#include <deque>
 
 namespace one {
 	class Queue : NonCopyable
@@ -11,11 +13,27 @@ namespace one {
 		Queue(uint32_t familyIndex, float priority);
 		~Queue();
 
-		bool initialize(VkDevice _device);
+		//a gpu wait inside a submission for another queue to reach a value(timeline semaphores only)
+		struct TimelineWait {
+			const Queue* pQueue;
+			uint64_t value;
+			VkPipelineStageFlags stage;
+		};
+
+		//timelineSemaphores gives the queue a timeline counted up by every submit,
+		//otherwise each submit gets a fence from a recycled pool(the binary fallback)
+		bool initialize(VkDevice _device, bool timelineSemaphores);
 		void destroy();
 		void initializeCommandPool();
-		void submit(VkSubmitInfo submitInfo, Fence* fence);
-		void present(VkPresentInfoKHR presentInfo);
+		//returns the value of this submission, values grow by one per submit on this queue
+		//binary semaphores in submitInfo are kept, timelineWaits are added on top
+		uint64_t submit(VkSubmitInfo submitInfo, const std::vector<TimelineWait>& timelineWaits = {});
+		//blocks until every submission up to value has finished, false on timeout
+		bool waitForValue(uint64_t value, uint64_t timeout);
+		//highest value whose submission(and every earlier one) has finished, does not block
+		uint64_t getCompletedValue(void);
+		//returns VK_SUCCESS, VK_SUBOPTIMAL_KHR or VK_ERROR_OUT_OF_DATE_KHR(swapchain must be recreated)
+		VkResult present(VkPresentInfoKHR presentInfo);
 
 		inline VkQueue getQueue() const{
 			return queue;
@@ -43,6 +61,14 @@ namespace one {
 			return pCommandPool->getCommandPool();
 		}
 
+		inline bool hasTimeline(void) const {
+			return pTimeline != nullptr;
+		}
+
+		inline uint64_t getSubmittedValue(void) const {
+			return submittedValue;
+		}
+
 
 	private:
 
@@ -53,7 +79,23 @@ namespace one {
 		uint16_t queueCount;
 		float priority;
 
-		CommandPool* pCommandPool;
+		CommandPool* pCommandPool{ nullptr };
+
+		//value of the last submit
+		uint64_t submittedValue = 0;
+
+		TimelineSemaphore* pTimeline{ nullptr };
+
+		//binary fallback: fence of every submission not known to be finished, oldest first
+		struct PendingFence {
+			uint64_t value;
+			Fence* pFence;
+		};
+		//recycles the fences of every submission up to value
+		void retireFences(uint64_t value);
+		std::deque<PendingFence> pendingFences;
+		std::vector<Fence*> pFreeFences;
+		uint64_t completedValue = 0;
 
 	};
 }
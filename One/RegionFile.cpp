@@ -0,0 +1,446 @@
+#include "RegionFile.h"
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <mutex>
+
+namespace one {
+	//"ONER"
+	static const uint32_t REGION_MAGIC = 0x52454e4f;
+	static const uint32_t REGION_VERSION = 1;
+
+	//how the raw palette stream of a payload is stored
+	static const uint8_t COMPRESSION_NONE = 0;
+	static const uint8_t COMPRESSION_RUNS = 1;
+	static const size_t PAYLOAD_HEADER_SIZE = sizeof(uint32_t) + sizeof(uint8_t);
+
+	//a control byte n below 128 is followed by n + 1 literal bytes, from 128 on the next byte repeats n - 125 times(3 to 130)
+	//the bit packed indices of terrain are long stretches of the same byte(air above, stone below), so runs take most of a chunk
+	static void compressRuns(const uint8_t* pData, size_t size, std::vector<uint8_t>& compressed) {
+		size_t i = 0;
+		while (i < size) {
+			size_t run = 1;
+			while (i + run < size && run < 130 && pData[i + run] == pData[i]) {
+				run++;
+			}
+			if (run >= 3) {
+				compressed.push_back(static_cast<uint8_t>(run + 125));
+				compressed.push_back(pData[i]);
+				i += run;
+				continue;
+			}
+			//literals up to the next run worth encoding
+			size_t start = i;
+			while (i < size && i - start < 128) {
+				if (i + 2 < size && pData[i] == pData[i + 1] && pData[i] == pData[i + 2]) {
+					break;
+				}
+				i++;
+			}
+			compressed.push_back(static_cast<uint8_t>(i - start - 1));
+			compressed.insert(compressed.end(), pData + start, pData + i);
+		}
+	}
+
+	//false if the runs don't add up to exactly size bytes
+	static bool decompressRuns(const uint8_t* pData, size_t size, uint8_t* pOutput, size_t outputSize) {
+		size_t written = 0;
+		size_t i = 0;
+		while (i < size) {
+			uint8_t control = pData[i++];
+			if (control < 128) {
+				size_t count = static_cast<size_t>(control) + 1;
+				if (i + count > size || written + count > outputSize) {
+					return false;
+				}
+				std::memcpy(pOutput + written, pData + i, count);
+				i += count;
+				written += count;
+			}
+			else {
+				size_t count = static_cast<size_t>(control) - 125;
+				if (i >= size || written + count > outputSize) {
+					return false;
+				}
+				std::memset(pOutput + written, pData[i++], count);
+				written += count;
+			}
+		}
+		return written == outputSize;
+	}
+
+	RegionFile::RegionFile(const std::string& path) {
+		initialize(path);
+	}
+
+	void RegionFile::initialize(const std::string& filePath) {
+		path = filePath;
+		pMapping = new MappedFile(path);
+		open();
+	}
+
+	ChunkCoordinate RegionFile::getRegion(ChunkCoordinate chunk) {
+		//rounds down for negative chunks too
+		auto floorDivide = [](int32_t value, int32_t divisor) {
+			return value >= 0 ? value / divisor : (value - divisor + 1) / divisor;
+		};
+		return { floorDivide(chunk.x, SIZE), floorDivide(chunk.y, HEIGHT), floorDivide(chunk.z, SIZE) };
+	}
+
+	uint32_t RegionFile::index(ChunkCoordinate chunk) {
+		ChunkCoordinate region = getRegion(chunk);
+		int32_t x = chunk.x - region.x * SIZE;
+		int32_t y = chunk.y - region.y * HEIGHT;
+		int32_t z = chunk.z - region.z * SIZE;
+		return static_cast<uint32_t>((y * SIZE + z) * SIZE + x);
+	}
+
+	void RegionFile::open() {
+		entries.assign(CHUNK_COUNT, { 0, 0 });
+		fileSize = 0;
+		deadBytes = 0;
+		if (!pMapping->isOpen()) {
+			return;
+		}
+
+		//a file that is not a region keeps fileSize at 0, the first flush writes a new one over it
+		const uint8_t* pData = pMapping->getData();
+		size_t size = pMapping->getSize();
+		size_t tableEnd = sizeof(Header) + CHUNK_COUNT * sizeof(Entry);
+		Header header;
+		if (size < tableEnd) {
+			std::cerr << path << " is not a region file, it will be overwritten \n";
+			return;
+		}
+		std::memcpy(&header, pData, sizeof(Header));
+		if (header.magic != REGION_MAGIC || header.version != REGION_VERSION || header.chunkCount != CHUNK_COUNT) {
+			std::cerr << path << " is not a region file of this version, it will be overwritten \n";
+			return;
+		}
+		std::memcpy(entries.data(), pData + sizeof(Header), CHUNK_COUNT * sizeof(Entry));
+
+		uint64_t liveBytes = 0;
+		for (Entry& entry : entries) {
+			//cut off by a crash, the chunk is generated again
+			if (entry.offset != 0 && (entry.offset < tableEnd || static_cast<uint64_t>(entry.offset) + entry.size > size)) {
+				entry = { 0, 0 };
+			}
+			liveBytes += entry.size;
+		}
+		fileSize = size;
+		deadBytes = fileSize - tableEnd - liveBytes;
+	}
+
+	void RegionFile::encode(const Chunk* pChunk, std::vector<uint8_t>& payload) {
+		//decoded once, the file's palette and index width are its own
+		static thread_local std::vector<BlockId> blocks(Chunk::BLOCK_COUNT);
+		pChunk->getBlocks(0, 0, 0, Chunk::BLOCK_COUNT, blocks.data());
+		const BlockId* pBlocks = blocks.data();
+
+		//palette in the order the blocks first show up
+		std::array<int16_t, 256> paletteIndices;
+		paletteIndices.fill(-1);
+		std::vector<BlockId> palette;
+		for (uint32_t i = 0; i < Chunk::BLOCK_COUNT; i++) {
+			if (paletteIndices[pBlocks[i]] < 0) {
+				paletteIndices[pBlocks[i]] = static_cast<int16_t>(palette.size());
+				palette.push_back(pBlocks[i]);
+			}
+		}
+		uint8_t bits = 0;
+		while ((static_cast<size_t>(1) << bits) < palette.size()) {
+			bits++;
+		}
+
+		//reused by every chunk a worker saves
+		static thread_local std::vector<uint8_t> raw;
+		raw.clear();
+		uint16_t paletteSize = static_cast<uint16_t>(palette.size());
+		raw.resize(sizeof(uint16_t));
+		std::memcpy(raw.data(), &paletteSize, sizeof(uint16_t));
+		raw.insert(raw.end(), palette.begin(), palette.end());
+		raw.push_back(bits);
+		//a chunk of only one block(all air or all stone) needs no indices
+		if (bits > 0) {
+			uint64_t accumulator = 0;
+			uint32_t accumulated = 0;
+			for (uint32_t i = 0; i < Chunk::BLOCK_COUNT; i++) {
+				accumulator |= static_cast<uint64_t>(paletteIndices[pBlocks[i]]) << accumulated;
+				accumulated += bits;
+				while (accumulated >= 8) {
+					raw.push_back(static_cast<uint8_t>(accumulator));
+					accumulator >>= 8;
+					accumulated -= 8;
+				}
+			}
+			if (accumulated > 0) {
+				raw.push_back(static_cast<uint8_t>(accumulator));
+			}
+		}
+
+		uint32_t rawSize = static_cast<uint32_t>(raw.size());
+		payload.resize(PAYLOAD_HEADER_SIZE);
+		std::memcpy(payload.data(), &rawSize, sizeof(uint32_t));
+		payload[sizeof(uint32_t)] = COMPRESSION_RUNS;
+		compressRuns(raw.data(), raw.size(), payload);
+		//noise that does not compress is kept as it is
+		if (payload.size() - PAYLOAD_HEADER_SIZE >= raw.size()) {
+			payload.resize(PAYLOAD_HEADER_SIZE);
+			payload[sizeof(uint32_t)] = COMPRESSION_NONE;
+			payload.insert(payload.end(), raw.begin(), raw.end());
+		}
+	}
+
+	bool RegionFile::decode(const uint8_t* pPayload, size_t size, Chunk* pChunk) {
+		if (size < PAYLOAD_HEADER_SIZE) {
+			return false;
+		}
+		uint32_t rawSize;
+		std::memcpy(&rawSize, pPayload, sizeof(uint32_t));
+		uint8_t compression = pPayload[sizeof(uint32_t)];
+		const uint8_t* pRaw = pPayload + PAYLOAD_HEADER_SIZE;
+		//a full palette with 8 bits per block is the most a chunk takes
+		if (rawSize > sizeof(uint16_t) + 256 + 1 + Chunk::BLOCK_COUNT) {
+			return false;
+		}
+
+		//uncompressed payloads are read where they are mapped, the rest is expanded into memory the worker keeps
+		static thread_local std::vector<uint8_t> scratch;
+		if (compression == COMPRESSION_RUNS) {
+			scratch.resize(rawSize);
+			if (!decompressRuns(pRaw, size - PAYLOAD_HEADER_SIZE, scratch.data(), rawSize)) {
+				return false;
+			}
+			pRaw = scratch.data();
+		}
+		else if (compression != COMPRESSION_NONE || rawSize != size - PAYLOAD_HEADER_SIZE) {
+			return false;
+		}
+
+		if (rawSize < sizeof(uint16_t)) {
+			return false;
+		}
+		uint16_t paletteSize;
+		std::memcpy(&paletteSize, pRaw, sizeof(uint16_t));
+		if (paletteSize == 0 || paletteSize > 256 || rawSize < sizeof(uint16_t) + paletteSize + 1) {
+			return false;
+		}
+		const BlockId* pPalette = pRaw + sizeof(uint16_t);
+		uint8_t bits = pRaw[sizeof(uint16_t) + paletteSize];
+		const uint8_t* pIndices = pRaw + sizeof(uint16_t) + paletteSize + 1;
+		size_t indexBytes = (static_cast<size_t>(Chunk::BLOCK_COUNT) * bits + 7) / 8;
+		if (bits > 8 || (static_cast<size_t>(1) << bits) < paletteSize || sizeof(uint16_t) + paletteSize + 1 + indexBytes > rawSize) {
+			return false;
+		}
+
+		if (bits == 0) {
+			pChunk->fillBlocks(pPalette[0]);
+			return true;
+		}
+		//the chunk is only touched once the whole payload decoded
+		static thread_local std::vector<BlockId> blocks(Chunk::BLOCK_COUNT);
+		BlockId* pBlocks = blocks.data();
+		uint64_t accumulator = 0;
+		uint32_t accumulated = 0;
+		uint64_t mask = (static_cast<uint64_t>(1) << bits) - 1;
+		for (uint32_t i = 0; i < Chunk::BLOCK_COUNT; i++) {
+			while (accumulated < bits) {
+				accumulator |= static_cast<uint64_t>(*pIndices++) << accumulated;
+				accumulated += 8;
+			}
+			uint32_t paletteIndex = static_cast<uint32_t>(accumulator & mask);
+			accumulator >>= bits;
+			accumulated -= bits;
+			if (paletteIndex >= paletteSize) {
+				return false;
+			}
+			pBlocks[i] = pPalette[paletteIndex];
+		}
+		pChunk->assignBlocks(pBlocks);
+		return true;
+	}
+
+	bool RegionFile::read(Chunk* pChunk) const {
+		uint32_t chunkIndex = index(pChunk->getCoordinate());
+		std::shared_lock lock(mutex);
+		bool decoded = false;
+		auto pending = pendingPayloads.find(chunkIndex);
+		if (pending != pendingPayloads.end()) {
+			decoded = decode(pending->second.data(), pending->second.size(), pChunk);
+		}
+		else {
+			const Entry& entry = entries[chunkIndex];
+			if (entry.offset == 0 || !pMapping->isOpen()) {
+				return false;
+			}
+			//a pointer into the mapping, the os reads the pages in as they are touched
+			decoded = decode(pMapping->getData() + entry.offset, entry.size, pChunk);
+		}
+		if (!decoded) {
+			ChunkCoordinate coordinate = pChunk->getCoordinate();
+			std::cerr << path << ": chunk " << coordinate.x << " " << coordinate.y << " " << coordinate.z << " is corrupt, it is generated again \n";
+		}
+		return decoded;
+	}
+
+	void RegionFile::write(const Chunk* pChunk) {
+		//encoded before the lock, reads only wait for the swap
+		std::vector<uint8_t> payload;
+		encode(pChunk, payload);
+		uint32_t chunkIndex = index(pChunk->getCoordinate());
+
+		std::unique_lock lock(mutex);
+		std::vector<uint8_t>& pending = pendingPayloads[chunkIndex];
+		pendingBytes = pendingBytes - pending.size() + payload.size();
+		pending = std::move(payload);
+	}
+
+	size_t RegionFile::getPendingBytes(void) const {
+		std::shared_lock lock(mutex);
+		return pendingBytes;
+	}
+
+	void RegionFile::flush() {
+		std::unique_lock lock(mutex);
+		if (pendingPayloads.empty()) {
+			return;
+		}
+
+		//payloads the pending ones replace
+		uint64_t replacedBytes = 0;
+		for (const auto& pending : pendingPayloads) {
+			replacedBytes += entries[pending.first].size;
+		}
+		//a new file, or one that is mostly dead payloads, is written from scratch
+		bool written = fileSize == 0 || (deadBytes + replacedBytes) * 2 > fileSize ? compact() : append();
+		if (!written) {
+			//kept for the next flush
+			return;
+		}
+		pendingPayloads.clear();
+		pendingBytes = 0;
+
+		//the old mapping ends before the appended payloads
+		pMapping->destroy();
+		pMapping->initialize(path);
+	}
+
+	bool RegionFile::append() {
+		std::vector<Entry> newEntries = entries;
+		uint64_t end = fileSize;
+		uint64_t newDeadBytes = deadBytes;
+		{
+			//the mapping stays valid meanwhile, the file only grows
+			std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+			if (!file.is_open()) {
+				std::cerr << "failed to open " << path << ", region not saved \n";
+				return false;
+			}
+			file.seekp(static_cast<std::streamoff>(end));
+			for (const auto& pending : pendingPayloads) {
+				if (end + pending.second.size() > UINT32_MAX) {
+					std::cerr << path << " is full, region not saved \n";
+					return false;
+				}
+				newDeadBytes += newEntries[pending.first].size;
+				newEntries[pending.first] = { static_cast<uint32_t>(end), static_cast<uint32_t>(pending.second.size()) };
+				file.write(reinterpret_cast<const char*>(pending.second.data()), static_cast<std::streamsize>(pending.second.size()));
+				end += pending.second.size();
+			}
+			//the table after the payloads, a crash before it leaves the old chunks in place
+			file.seekp(sizeof(Header));
+			file.write(reinterpret_cast<const char*>(newEntries.data()), static_cast<std::streamsize>(newEntries.size() * sizeof(Entry)));
+			file.flush();
+			if (!file) {
+				std::cerr << "failed to write " << path << ", region not saved \n";
+				return false;
+			}
+		}
+		entries = std::move(newEntries);
+		fileSize = end;
+		deadBytes = newDeadBytes;
+		return true;
+	}
+
+	bool RegionFile::compact() {
+		//same as the pipeline cache, a crash while compacting never leaves a half written region behind
+		std::string tempPath = path + ".tmp";
+		std::vector<Entry> newEntries(CHUNK_COUNT, { 0, 0 });
+		uint64_t end = sizeof(Header) + CHUNK_COUNT * sizeof(Entry);
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open()) {
+				std::cerr << "failed to open " << tempPath << ", region not saved \n";
+				return false;
+			}
+			Header header{ REGION_MAGIC, REGION_VERSION, CHUNK_COUNT, 0 };
+			file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+			//the table is written once the offsets are known
+			file.seekp(static_cast<std::streamoff>(end));
+
+			//live payloads in chunk order, the newest version of every chunk
+			for (uint32_t i = 0; i < CHUNK_COUNT; i++) {
+				const uint8_t* pPayload = nullptr;
+				size_t size = 0;
+				auto pending = pendingPayloads.find(i);
+				if (pending != pendingPayloads.end()) {
+					pPayload = pending->second.data();
+					size = pending->second.size();
+				}
+				else if (entries[i].offset != 0) {
+					pPayload = pMapping->getData() + entries[i].offset;
+					size = entries[i].size;
+				}
+				else {
+					continue;
+				}
+				if (end + size > UINT32_MAX) {
+					std::cerr << path << " is full, region not saved \n";
+					return false;
+				}
+				newEntries[i] = { static_cast<uint32_t>(end), static_cast<uint32_t>(size) };
+				file.write(reinterpret_cast<const char*>(pPayload), static_cast<std::streamsize>(size));
+				end += size;
+			}
+
+			file.seekp(sizeof(Header));
+			file.write(reinterpret_cast<const char*>(newEntries.data()), static_cast<std::streamsize>(newEntries.size() * sizeof(Entry)));
+			if (!file) {
+				std::cerr << "failed to write " << tempPath << ", region not saved \n";
+				return false;
+			}
+		}
+
+		//windows can't replace a file that is still mapped
+		pMapping->destroy();
+		std::error_code error;
+		std::filesystem::rename(tempPath, path, error);
+		if (error) {
+			std::cerr << "failed to replace " << path << ": " << error.message() << "\n";
+			std::filesystem::remove(tempPath, error);
+			pMapping->initialize(path);
+			return false;
+		}
+		entries = std::move(newEntries);
+		fileSize = end;
+		deadBytes = 0;
+		return true;
+	}
+
+	void RegionFile::destroy() {
+		if (pMapping == nullptr) {
+			return;
+		}
+		//nothing written is lost
+		flush();
+		pMapping->destroy();
+		delete pMapping;
+		pMapping = nullptr;
+		entries.clear();
+	}
+
+	RegionFile::~RegionFile() {
+		destroy();
+	}
+}
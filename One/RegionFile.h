@@ -0,0 +1,88 @@
+#pragma once
+#include "UtilHeader.h"
+#include <shared_mutex>
+#include <unordered_map>
+#include "Chunk.h"
+#include "MappedFile.h"
+
+namespace one {
+	//the chunks of a SIZE x HEIGHT x SIZE box saved in one file
+	//layout: Header, an Entry per chunk(where its payload is, offset 0 if it was never saved), then the payloads in the order they were appended
+	//reads decode straight from the memory mapped file, writes are kept in memory until flush appends them and rewrites the table
+	//a chunk saved again leaves its old payload behind, flush compacts the file once most of it is dead
+	class RegionFile : NonCopyable
+	{
+	public:
+
+		static const int32_t SIZE = 32;
+		static const int32_t HEIGHT = 8;
+		static const uint32_t CHUNK_COUNT = SIZE * HEIGHT * SIZE;
+
+		//the file is created by the first flush
+		RegionFile(const std::string& path);
+		~RegionFile();
+
+		void initialize(const std::string& path);
+		void destroy();
+
+		//region a chunk is saved in
+		static ChunkCoordinate getRegion(ChunkCoordinate chunk);
+
+		//fills pChunk with its saved blocks, false if this region has none for it(or they are corrupt)
+		//any thread, reads run concurrently and see writes that were not flushed yet
+		bool read(Chunk* pChunk) const;
+		//encodes the chunk's blocks, they are on disk after the next flush
+		void write(const Chunk* pChunk);
+		//appends what was written since the last flush, waits for the reads meanwhile
+		void flush();
+
+		//encoded bytes written but not flushed yet
+		size_t getPendingBytes(void) const;
+
+	private:
+
+		struct Header {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t chunkCount;
+			uint32_t reserved;
+		};
+
+		struct Entry {
+			//from the start of the file
+			uint32_t offset;
+			uint32_t size;
+		};
+
+		static uint32_t index(ChunkCoordinate chunk);
+
+		//payload: [uint32 raw size][uint8 compression][data]
+		//raw: [uint16 palette size][palette][uint8 bits per block][indices bit packed lsb first], no indices for a chunk of one block
+		static void encode(const Chunk* pChunk, std::vector<uint8_t>& payload);
+		static bool decode(const uint8_t* pPayload, size_t size, Chunk* pChunk);
+
+		//maps the file and reads its table, a missing or foreign file leaves the region empty
+		void open();
+		//writes the pending payloads after the end of the file and rewrites the table
+		bool append();
+		//writes the header, table and every payload to a new file that replaces the old one
+		bool compact();
+
+		std::string path;
+
+		MappedFile* pMapping{ nullptr };
+
+		std::vector<Entry> entries;
+		uint64_t fileSize = 0;
+		//bytes of payloads no entry points at anymore
+		uint64_t deadBytes = 0;
+
+		//encoded by write, by chunk index
+		std::unordered_map<uint32_t, std::vector<uint8_t>> pendingPayloads;
+		size_t pendingBytes = 0;
+
+		//shared by reads, flush and write take it alone
+		mutable std::shared_mutex mutex;
+
+	};
+}
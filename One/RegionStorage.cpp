@@ -0,0 +1,75 @@
+#include "RegionStorage.h"
+#include <filesystem>
+
+namespace one {
+	RegionStorage::RegionStorage(const std::string& directory) {
+		initialize(directory);
+	}
+
+	void RegionStorage::initialize(const std::string& path) {
+		directory = path;
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+		if (error) {
+			//reads find nothing and every flush reports its failure
+			std::cerr << "failed to create " << directory << ": " << error.message() << "\n";
+		}
+
+		std::cerr << "region storage has initiated in " << directory << "\n";
+	}
+
+	RegionFile* RegionStorage::getRegionFile(ChunkCoordinate chunk) {
+		ChunkCoordinate region = RegionFile::getRegion(chunk);
+		std::lock_guard<std::mutex> lock(mutex);
+		RegionFile*& pRegionFile = pRegionFiles[region];
+		if (pRegionFile == nullptr) {
+			std::string name = "r." + std::to_string(region.x) + "." + std::to_string(region.y) + "." + std::to_string(region.z) + ".region";
+			pRegionFile = new RegionFile((std::filesystem::path(directory) / name).string());
+		}
+		return pRegionFile;
+	}
+
+	bool RegionStorage::read(Chunk* pChunk) {
+		return getRegionFile(pChunk->getCoordinate())->read(pChunk);
+	}
+
+	void RegionStorage::write(const Chunk* pChunk) {
+		getRegionFile(pChunk->getCoordinate())->write(pChunk);
+	}
+
+	void RegionStorage::flush() {
+		//regions are never closed before destroy, so the pointers outlive the lock
+		std::vector<RegionFile*> regionFiles;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			for (auto& regionFile : pRegionFiles) {
+				regionFiles.push_back(regionFile.second);
+			}
+		}
+		for (RegionFile* pRegionFile : regionFiles) {
+			pRegionFile->flush();
+		}
+	}
+
+	size_t RegionStorage::getPendingBytes(void) {
+		std::lock_guard<std::mutex> lock(mutex);
+		size_t pendingBytes = 0;
+		for (auto& regionFile : pRegionFiles) {
+			pendingBytes += regionFile.second->getPendingBytes();
+		}
+		return pendingBytes;
+	}
+
+	void RegionStorage::destroy() {
+		std::lock_guard<std::mutex> lock(mutex);
+		for (auto& regionFile : pRegionFiles) {
+			regionFile.second->destroy();
+			delete regionFile.second;
+		}
+		pRegionFiles.clear();
+	}
+
+	RegionStorage::~RegionStorage() {
+		destroy();
+	}
+}
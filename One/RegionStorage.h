@@ -0,0 +1,42 @@
+#pragma once
+#include "UtilHeader.h"
+#include <mutex>
+#include <unordered_map>
+#include "RegionFile.h"
+
+namespace one {
+	//the region files of one world, kept in a directory and opened the first time one of their chunks is read or written
+	//any thread
+	class RegionStorage : NonCopyable
+	{
+	public:
+
+		//the directory is created if it does not exist
+		RegionStorage(const std::string& directory);
+		~RegionStorage();
+
+		void initialize(const std::string& directory);
+		//flushes every region
+		void destroy();
+
+		//fills pChunk with its saved blocks, false if it was never saved
+		bool read(Chunk* pChunk);
+		//the blocks are on disk after the next flush, read already sees them
+		void write(const Chunk* pChunk);
+		void flush();
+
+		//encoded bytes waiting for a flush over every region
+		size_t getPendingBytes(void);
+
+	private:
+
+		RegionFile* getRegionFile(ChunkCoordinate chunk);
+
+		std::string directory;
+
+		//guards the map only, the files have locks of their own
+		std::mutex mutex;
+		std::unordered_map<ChunkCoordinate, RegionFile*, ChunkCoordinateHash> pRegionFiles;
+
+	};
+}
@@ -0,0 +1,456 @@
+#include "RenderGraph.h"
+#include <algorithm>
+
+namespace one {
+	//stages, access, layout and image usage flag a usage needs(writes also read, attachments are tested and loaded)
+	struct UsageAccess {
+		VkPipelineStageFlags stageMask;
+		VkAccessFlags readAccess;
+		VkAccessFlags writeAccess;
+		VkImageLayout layout;
+		VkImageUsageFlags imageUsage;
+	};
+
+	static UsageAccess getUsageAccess(RenderGraph::Usage usage, VkImageAspectFlags aspectMask) {
+		VkImageLayout readOnlyLayout = (aspectMask & VK_IMAGE_ASPECT_DEPTH_BIT) != 0 ?
+			VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		switch (usage) {
+		case RenderGraph::USAGE_COLOR_ATTACHMENT:
+			return { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+				VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT };
+		case RenderGraph::USAGE_DEPTH_ATTACHMENT:
+			return { VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+				VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+				VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT };
+		case RenderGraph::USAGE_SAMPLED_COMPUTE:
+			return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, 0, readOnlyLayout, VK_IMAGE_USAGE_SAMPLED_BIT };
+		case RenderGraph::USAGE_SAMPLED_FRAGMENT:
+			return { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, 0, readOnlyLayout, VK_IMAGE_USAGE_SAMPLED_BIT };
+		case RenderGraph::USAGE_STORAGE_COMPUTE:
+			return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT };
+		case RenderGraph::USAGE_TRANSFER_SOURCE:
+			return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, 0, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT };
+		case RenderGraph::USAGE_TRANSFER_DESTINATION:
+			return { VK_PIPELINE_STAGE_TRANSFER_BIT, 0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT };
+		}
+		throw std::runtime_error("failed to find render graph usage!");
+	}
+
+	//barriers on combined depth/stencil formats have to name both aspects
+	static VkImageAspectFlags getBarrierAspect(VkFormat format, VkImageAspectFlags aspectMask) {
+		if ((aspectMask & VK_IMAGE_ASPECT_DEPTH_BIT) != 0 && (format == VK_FORMAT_D16_UNORM_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT ||
+			format == VK_FORMAT_D32_SFLOAT_S8_UINT)) {
+			return aspectMask | VK_IMAGE_ASPECT_STENCIL_BIT;
+		}
+		return aspectMask;
+	}
+
+	RenderGraph::RenderGraph(Device* pDevice) : pDevice(pDevice), _device(pDevice->getDevice()) {
+		initialize();
+	}
+
+	void RenderGraph::initialize() {
+		std::cerr << "render graph has initiated \n";
+	}
+
+	uint32_t RenderGraph::importImage(VkImage image, VkImageAspectFlags aspectMask, uint32_t levelCount, const ImageState& initialState, const ImageState& finalState) {
+		assert(!compiled);
+		Image imported{};
+		imported.image = image;
+		imported.aspectMask = aspectMask;
+		imported.levelCount = levelCount;
+		imported.imported = true;
+		imported.initialState = initialState;
+		imported.finalState = finalState;
+		imported.pImageView = nullptr;
+		images.push_back(imported);
+		return static_cast<uint32_t>(images.size() - 1);
+	}
+
+	uint32_t RenderGraph::createImage(const ImageDescription& description) {
+		assert(!compiled);
+		Image transient{};
+		transient.image = VK_NULL_HANDLE;
+		transient.aspectMask = getBarrierAspect(description.format, description.aspectMask);
+		transient.levelCount = 1;
+		transient.imported = false;
+		transient.description = description;
+		transient.pImageView = nullptr;
+		images.push_back(transient);
+		return static_cast<uint32_t>(images.size() - 1);
+	}
+
+	uint32_t RenderGraph::addPass(const char* name, Record record) {
+		assert(!compiled);
+		Pass pass{};
+		pass.name = name;
+		pass.record = record;
+		passes.push_back(pass);
+		return static_cast<uint32_t>(passes.size() - 1);
+	}
+
+	void RenderGraph::read(uint32_t pass, uint32_t image, Usage usage) {
+		addUse(pass, image, usage, false);
+	}
+
+	void RenderGraph::write(uint32_t pass, uint32_t image, Usage usage) {
+		addUse(pass, image, usage, true);
+	}
+
+	void RenderGraph::addUse(uint32_t pass, uint32_t image, Usage usage, bool write) {
+		assert(!compiled && pass < passes.size() && image < images.size());
+		for (const ImageUse& use : passes[pass].uses) {
+			assert(use.image != image);
+		}
+		passes[pass].uses.push_back({ image, usage, write });
+	}
+
+	void RenderGraph::compile() {
+		assert(!compiled);
+		cullPasses();
+		allocateTransients();
+		buildBarriers();
+		compiled = true;
+	}
+
+	void RenderGraph::cullPasses() {
+		//images whose contents a kept pass(or the outside) still needs, walked from the last pass back
+		std::vector<bool> needed(images.size(), false);
+		for (uint32_t i = 0; i < images.size(); i++) {
+			needed[i] = images[i].imported;
+		}
+
+		std::vector<bool> kept(passes.size(), false);
+		for (uint32_t pass = static_cast<uint32_t>(passes.size()); pass-- > 0;) {
+			for (const ImageUse& use : passes[pass].uses) {
+				if (use.write && needed[use.image]) {
+					kept[pass] = true;
+				}
+			}
+			if (!kept[pass]) {
+				continue;
+			}
+			//a write replaces the contents, passes before only matter if this one reads them
+			for (const ImageUse& use : passes[pass].uses) {
+				needed[use.image] = !use.write;
+			}
+		}
+		//imported images can still be needed from before the first pass, anything else read there was never written
+		for (uint32_t i = 0; i < images.size(); i++) {
+			assert(!needed[i] || images[i].imported);
+		}
+
+		order.clear();
+		for (uint32_t pass = 0; pass < passes.size(); pass++) {
+			if (kept[pass]) {
+				order.push_back(pass);
+			}
+			else {
+				std::cerr << "render graph: pass " << passes[pass].name << " is not needed, culled \n";
+			}
+		}
+
+		for (Image& image : images) {
+			image.firstUse = UINT32_MAX;
+			image.lastUse = UINT32_MAX;
+			image.useStages = 0;
+			image.usage = 0;
+			image.transientAttachment = false;
+		}
+		for (uint32_t position = 0; position < order.size(); position++) {
+			for (const ImageUse& use : passes[order[position]].uses) {
+				Image& image = images[use.image];
+				if (image.firstUse == UINT32_MAX) {
+					image.firstUse = position;
+				}
+				image.lastUse = position;
+				UsageAccess access = getUsageAccess(use.usage, image.aspectMask);
+				image.useStages |= access.stageMask;
+				image.usage |= access.imageUsage;
+			}
+		}
+
+		//a render pass is one pass, anything a second pass touches has to be stored
+		const VkImageUsageFlags attachmentUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		for (Image& image : images) {
+			image.transientAttachment = !image.imported && image.firstUse != UINT32_MAX && image.firstUse == image.lastUse &&
+				(image.usage & ~attachmentUsage) == 0;
+		}
+	}
+
+	void RenderGraph::allocateTransients() {
+		//transients no kept pass uses are never created
+		std::vector<uint32_t> transients;
+		std::vector<VkMemoryRequirements> requirements(images.size());
+		for (uint32_t i = 0; i < images.size(); i++) {
+			Image& image = images[i];
+			if (image.imported || image.firstUse == UINT32_MAX) {
+				continue;
+			}
+			VkImageCreateInfo imageInfo{};
+			imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageInfo.format = image.description.format;
+			imageInfo.extent.width = image.description.extent.width;
+			imageInfo.extent.height = image.description.extent.height;
+			imageInfo.extent.depth = 1;
+			imageInfo.mipLevels = 1;
+			imageInfo.arrayLayers = 1;
+			imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			//tile based gpus can keep transient attachments in tile memory and never back them
+			imageInfo.usage = image.transientAttachment ? image.usage | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : image.usage;
+			//graphs run on one queue
+			imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+			if (vkCreateImage(_device, &imageInfo, nullptr, &image.image) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create render graph image!");
+			}
+			vkGetImageMemoryRequirements(_device, image.image, &requirements[i]);
+			transients.push_back(i);
+		}
+
+		//biggest first so smaller images fill the slots they make
+		std::sort(transients.begin(), transients.end(), [&requirements](uint32_t a, uint32_t b) {
+			return requirements[a].size > requirements[b].size;
+		});
+
+		std::vector<VkMemoryRequirements> slotRequirements;
+		std::vector<std::vector<uint32_t>> slotImages;
+		//only transient attachments can live in lazily allocated memory
+		std::vector<bool> slotLazy;
+		for (uint32_t i : transients) {
+			const Image& image = images[i];
+			uint32_t slot = 0;
+			for (; slot < slotImages.size(); slot++) {
+				if (slotLazy[slot] != image.transientAttachment || (slotRequirements[slot].memoryTypeBits & requirements[i].memoryTypeBits) == 0) {
+					continue;
+				}
+				bool overlaps = false;
+				for (uint32_t other : slotImages[slot]) {
+					overlaps = overlaps || (image.firstUse <= images[other].lastUse && images[other].firstUse <= image.lastUse);
+				}
+				if (!overlaps) {
+					break;
+				}
+			}
+			if (slot == slotImages.size()) {
+				slotRequirements.push_back(requirements[i]);
+				slotImages.push_back({});
+				slotLazy.push_back(image.transientAttachment);
+			}
+			VkMemoryRequirements& merged = slotRequirements[slot];
+			merged.size = std::max(merged.size, requirements[i].size);
+			merged.alignment = std::max(merged.alignment, requirements[i].alignment);
+			merged.memoryTypeBits &= requirements[i].memoryTypeBits;
+			slotImages[slot].push_back(i);
+		}
+
+		uint32_t lazyCount = 0;
+		for (uint32_t slot = 0; slot < slotImages.size(); slot++) {
+			//gpus without lazily allocated memory(most desktop ones) back them like any other image
+			MemoryAllocator::Allocation allocation = pDevice->getMemoryAllocator()->allocate(slotRequirements[slot],
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, slotLazy[slot] ? VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT : 0, true, MemoryAllocator::STRATEGY_BUDDY);
+			slotMemory.push_back(allocation);
+			if (pDevice->getMemoryAllocator()->isLazilyAllocated(allocation)) {
+				lazyCount++;
+			}
+
+			//in the order they are used, each one waits on the stages of the one before(the first on the last of the previous execution)
+			std::vector<uint32_t>& sharing = slotImages[slot];
+			std::sort(sharing.begin(), sharing.end(), [this](uint32_t a, uint32_t b) {
+				return images[a].firstUse < images[b].firstUse;
+			});
+			for (uint32_t j = 0; j < sharing.size(); j++) {
+				Image& image = images[sharing[j]];
+				if (vkBindImageMemory(_device, image.image, allocation.memory, allocation.offset) != VK_SUCCESS) {
+					throw std::runtime_error("failed to bind render graph image memory!");
+				}
+				image.pImageView = new ImageView(_device, image.image, image.description.format, image.description.aspectMask);
+
+				const Image& previous = images[sharing[(j + sharing.size() - 1) % sharing.size()]];
+				image.initialState = { previous.useStages, 0, VK_IMAGE_LAYOUT_UNDEFINED };
+			}
+		}
+
+		if (!transients.empty()) {
+			std::cerr << "render graph: " << transients.size() << " transient images in " << slotImages.size() << " memory slots(" << lazyCount <<
+				" lazily allocated) \n";
+		}
+	}
+
+	void RenderGraph::buildBarriers() {
+		//what has happened to every image so far while walking the passes in order
+		struct Tracked {
+			VkImageLayout layout;
+			//last write(or layout transition) and the access it needs made available
+			VkPipelineStageFlags writeStages;
+			VkAccessFlags writeAccess;
+			//reads since then, the next write has to wait for them
+			VkPipelineStageFlags readStages;
+			//stages the last write is already visible to
+			VkPipelineStageFlags visibleStages;
+		};
+		std::vector<Tracked> tracked(images.size());
+		for (uint32_t i = 0; i < images.size(); i++) {
+			tracked[i] = { images[i].initialState.layout, images[i].initialState.stageMask, images[i].initialState.accessMask, 0, 0 };
+		}
+
+		passBarriers.assign(order.size(), Barrier());
+		for (uint32_t position = 0; position < order.size(); position++) {
+			Barrier& barrier = passBarriers[position];
+			for (const ImageUse& use : passes[order[position]].uses) {
+				const Image& image = images[use.image];
+				Tracked& state = tracked[use.image];
+				UsageAccess access = getUsageAccess(use.usage, image.aspectMask);
+				VkAccessFlags dstAccess = use.write ? access.readAccess | access.writeAccess : access.readAccess;
+
+				//reads of something already visible to their stage in the right layout run as they are
+				bool layoutChange = state.layout != access.layout;
+				if (!use.write && !layoutChange && (access.stageMask & ~state.visibleStages) == 0) {
+					state.readStages |= access.stageMask;
+					continue;
+				}
+
+				VkImageMemoryBarrier imageBarrier{};
+				imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+				imageBarrier.srcAccessMask = state.writeAccess;
+				imageBarrier.dstAccessMask = dstAccess;
+				imageBarrier.oldLayout = state.layout;
+				imageBarrier.newLayout = access.layout;
+				imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				imageBarrier.image = image.image;
+				imageBarrier.subresourceRange.aspectMask = image.aspectMask;
+				imageBarrier.subresourceRange.baseMipLevel = 0;
+				imageBarrier.subresourceRange.levelCount = image.levelCount;
+				imageBarrier.subresourceRange.baseArrayLayer = 0;
+				imageBarrier.subresourceRange.layerCount = 1;
+				barrier.imageBarriers.push_back(imageBarrier);
+				//writes and transitions wait for the reads before them too, reads only for the write
+				barrier.srcStageMask |= (use.write || layoutChange) ? state.writeStages | state.readStages : state.writeStages;
+				barrier.dstStageMask |= access.stageMask;
+
+				if (use.write) {
+					state = { access.layout, access.stageMask, access.writeAccess, 0, 0 };
+				}
+				else if (layoutChange) {
+					//the transition is the last write now, the one before it has been made available already
+					state = { access.layout, access.stageMask, 0, access.stageMask, access.stageMask };
+				}
+				else {
+					state.readStages |= access.stageMask;
+					state.visibleStages |= access.stageMask;
+				}
+			}
+		}
+
+		//hand offs in the same layout are ordered by the submit and its semaphores, only transitions are recorded
+		finalBarrier = Barrier();
+		for (uint32_t i = 0; i < images.size(); i++) {
+			const Image& image = images[i];
+			const Tracked& state = tracked[i];
+			if (!image.imported || image.finalState.layout == state.layout) {
+				continue;
+			}
+			VkImageMemoryBarrier imageBarrier{};
+			imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			imageBarrier.srcAccessMask = state.writeAccess;
+			imageBarrier.dstAccessMask = image.finalState.accessMask;
+			imageBarrier.oldLayout = state.layout;
+			imageBarrier.newLayout = image.finalState.layout;
+			imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageBarrier.image = image.image;
+			imageBarrier.subresourceRange.aspectMask = image.aspectMask;
+			imageBarrier.subresourceRange.baseMipLevel = 0;
+			imageBarrier.subresourceRange.levelCount = image.levelCount;
+			imageBarrier.subresourceRange.baseArrayLayer = 0;
+			imageBarrier.subresourceRange.layerCount = 1;
+			finalBarrier.imageBarriers.push_back(imageBarrier);
+			finalBarrier.srcStageMask |= state.writeStages | state.readStages;
+			finalBarrier.dstStageMask |= image.finalState.stageMask;
+		}
+	}
+
+	void RenderGraph::execute(VkCommandBuffer commandBuffer) const {
+		assert(compiled);
+		for (uint32_t position = 0; position < order.size(); position++) {
+			recordBarrier(commandBuffer, passBarriers[position]);
+			passes[order[position]].record(commandBuffer);
+		}
+		recordBarrier(commandBuffer, finalBarrier);
+	}
+
+	void RenderGraph::recordBarrier(VkCommandBuffer commandBuffer, const Barrier& barrier) const {
+		if (barrier.imageBarriers.empty()) {
+			return;
+		}
+		//nothing to wait on(first use of a discarded image) still needs a stage
+		VkPipelineStageFlags srcStageMask = barrier.srcStageMask != 0 ? barrier.srcStageMask : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		VkPipelineStageFlags dstStageMask = barrier.dstStageMask != 0 ? barrier.dstStageMask : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, 0, 0, nullptr, 0, nullptr,
+			static_cast<uint32_t>(barrier.imageBarriers.size()), barrier.imageBarriers.data());
+	}
+
+	bool RenderGraph::isTransientAttachment(uint32_t image) const {
+		assert(compiled);
+		return images[image].transientAttachment;
+	}
+
+	VkImage RenderGraph::getImage(uint32_t image) const {
+		return images[image].image;
+	}
+
+	VkImageView RenderGraph::getImageView(uint32_t image) const {
+		return images[image].pImageView != nullptr ? images[image].pImageView->getImageView() : VK_NULL_HANDLE;
+	}
+
+	VkFormat RenderGraph::chooseDepthFormat(VkPhysicalDevice physicalDevice) {
+		//unorm formats only come after every float one, they still work with reversed depth but lose the far precision
+		const VkFormat candidates[] = { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_X8_D24_UNORM_PACK32, VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D16_UNORM };
+		//drawn to, then sampled by the Hi-Z build
+		const VkFormatFeatureFlags features = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+		for (VkFormat candidate : candidates) {
+			VkFormatProperties properties;
+			vkGetPhysicalDeviceFormatProperties(physicalDevice, candidate, &properties);
+			if ((properties.optimalTilingFeatures & features) == features) {
+				return candidate;
+			}
+		}
+		throw std::runtime_error("failed to find a supported depth format!");
+	}
+
+	void RenderGraph::destroy() {
+		//owner makes sure no execution is still on the gpu
+		for (Image& image : images) {
+			if (image.imported) {
+				continue;
+			}
+			if (image.pImageView != nullptr) {
+				image.pImageView->destroy(_device);
+				delete image.pImageView;
+				image.pImageView = nullptr;
+			}
+			if (image.image != VK_NULL_HANDLE) {
+				vkDestroyImage(_device, image.image, nullptr);
+				image.image = VK_NULL_HANDLE;
+			}
+		}
+		for (MemoryAllocator::Allocation& allocation : slotMemory) {
+			pDevice->getMemoryAllocator()->free(allocation);
+		}
+		slotMemory.clear();
+		images.clear();
+		passes.clear();
+		order.clear();
+		passBarriers.clear();
+		finalBarrier = Barrier();
+		compiled = false;
+	}
+
+	RenderGraph::~RenderGraph() {
+		destroy();
+	}
+}
@@ -0,0 +1,153 @@
+#pragma once
+#include "UtilHeader.h"
+#include <functional>
+#include "Device.h"
+#include "ImageView.h"
+
+namespace one {
+	//a frame described as passes that declare which images they read and write
+	//compile leaves out passes nothing needs, works out one barrier before every pass(layout transitions included)
+	//and lets transient images whose passes do not overlap share memory
+	//built once per render target(swapchain image or frame slot) and executed every time its frame is recorded
+	class RenderGraph : NonCopyable
+	{
+	public:
+
+		//how a pass uses an image, gives the stages, access and layout it needs
+		enum Usage {
+			USAGE_COLOR_ATTACHMENT,
+			USAGE_DEPTH_ATTACHMENT,
+			//sampled or fetched, depth images are read in DEPTH_STENCIL_READ_ONLY_OPTIMAL, others in SHADER_READ_ONLY_OPTIMAL
+			USAGE_SAMPLED_COMPUTE,
+			USAGE_SAMPLED_FRAGMENT,
+			USAGE_STORAGE_COMPUTE,
+			USAGE_TRANSFER_SOURCE,
+			USAGE_TRANSFER_DESTINATION
+		};
+
+		//use of an imported image outside the graph, before(initial) or after(final) it
+		struct ImageState {
+			VkPipelineStageFlags stageMask;
+			VkAccessFlags accessMask;
+			//an UNDEFINED initial layout throws the contents away
+			VkImageLayout layout;
+		};
+
+		//image the graph creates and owns, only its passes use it and its contents do not outlive an execution
+		//its usage flags come from the passes that use it
+		struct ImageDescription {
+			VkFormat format;
+			VkExtent2D extent;
+			VkImageAspectFlags aspectMask;
+		};
+
+		//records the commands of a pass, the barriers before it are already recorded
+		typedef std::function<void(VkCommandBuffer commandBuffer)> Record;
+
+		RenderGraph(Device* pDevice);
+		~RenderGraph();
+
+		void initialize();
+		void destroy();
+
+		//images, passes and their uses can only be added before compile
+		//imported images are outputs of the graph, passes that lead to one of them are never left out
+		uint32_t importImage(VkImage image, VkImageAspectFlags aspectMask, uint32_t levelCount, const ImageState& initialState, const ImageState& finalState);
+		uint32_t createImage(const ImageDescription& description);
+
+		//passes run in the order they were added, a pass uses an image at most once
+		uint32_t addPass(const char* name, Record record);
+		void read(uint32_t pass, uint32_t image, Usage usage);
+		//the previous contents are not needed, a pass that keeps them has to be the one writing
+		void write(uint32_t pass, uint32_t image, Usage usage);
+
+		//culls passes, creates the transient images and their memory and works out every barrier
+		void compile();
+
+		//barriers and passes in order, then the transitions of imported images to their final state
+		void execute(VkCommandBuffer commandBuffer) const;
+
+		VkImage getImage(uint32_t image) const;
+		//transient images only, VK_NULL_HANDLE before compile or if no pass uses it
+		VkImageView getImageView(uint32_t image) const;
+
+		//transient image that only one pass uses and only as an attachment, created TRANSIENT_ATTACHMENT in lazily allocated memory when the gpu has it
+		//its contents never leave the render pass, so the pass has to use STORE_OP_DONT_CARE for it(valid after compile)
+		bool isTransientAttachment(uint32_t image) const;
+
+		inline uint32_t getExecutedPassCount(void) const {
+			return static_cast<uint32_t>(order.size());
+		}
+
+		//best depth format the gpu can draw to and sample, float ones first(reversed depth needs them for its precision)
+		static VkFormat chooseDepthFormat(VkPhysicalDevice physicalDevice);
+
+	private:
+
+		struct Image {
+			VkImage image;
+			VkImageAspectFlags aspectMask;
+			uint32_t levelCount;
+			bool imported;
+			ImageState initialState;
+			ImageState finalState;
+			//transient images only
+			ImageDescription description;
+			ImageView* pImageView;
+			//positions in the executed order of its first and last pass, UINT32_MAX if no pass uses it
+			uint32_t firstUse;
+			uint32_t lastUse;
+			//stages of every use, the next image placed in the same memory waits on them
+			VkPipelineStageFlags useStages;
+			//usage flags of every use
+			VkImageUsageFlags usage;
+			bool transientAttachment;
+		};
+
+		struct ImageUse {
+			uint32_t image;
+			Usage usage;
+			bool write;
+		};
+
+		struct Pass {
+			const char* name;
+			Record record;
+			std::vector<ImageUse> uses;
+		};
+
+		//one vkCmdPipelineBarrier, nothing is recorded if it has no image barriers
+		struct Barrier {
+			VkPipelineStageFlags srcStageMask = 0;
+			VkPipelineStageFlags dstStageMask = 0;
+			std::vector<VkImageMemoryBarrier> imageBarriers;
+		};
+
+		void addUse(uint32_t pass, uint32_t image, Usage usage, bool write);
+		//keeps the passes that write an imported image or something a kept pass reads
+		void cullPasses();
+		//transients are placed in the first memory slot none of its images overlaps with
+		//transient attachments only share slots with each other, those slots prefer lazily allocated memory
+		void allocateTransients();
+		void buildBarriers();
+		void recordBarrier(VkCommandBuffer commandBuffer, const Barrier& barrier) const;
+
+		Device* pDevice;
+		VkDevice _device;
+
+		std::vector<Image> images;
+		std::vector<Pass> passes;
+
+		//passes left after culling, in order, and the barrier recorded before each of them
+		std::vector<uint32_t> order;
+		std::vector<Barrier> passBarriers;
+		//imported images whose final layout differs from their last use
+		Barrier finalBarrier;
+
+		//one allocation per memory slot, shared by the transient images placed in it
+		std::vector<MemoryAllocator::Allocation> slotMemory;
+
+		bool compiled = false;
+
+	};
+}
@@ -1,8 +1,8 @@
 #include "RenderPass.h"
 
 namespace one {
-	RenderPass::RenderPass(VkDevice _device, VkFormat _swapchainImageFormat) : _device(_device) {
-		initialize(_swapchainImageFormat);
+	RenderPass::RenderPass(VkDevice _device, VkFormat _swapchainImageFormat, VkFormat depthFormat, VkAttachmentStoreOp depthStoreOp) : _device(_device) {
+		initialize(_swapchainImageFormat, depthFormat, depthStoreOp);
 	}
 
 	//frameBuffer and renderring recommendations:
@@ -17,7 +17,7 @@ namespace one {
 	//			SubPass1 read from depth buffer and wrote to color buffer
 	//			Subpass2 read from color buffer and wrote to framebuffer
 	//The renderpass just specifies the states you need each attachment to be before Subpasses
-	void RenderPass::initialize(VkFormat _swapchainImageFormat) {
+	void RenderPass::initialize(VkFormat _swapchainImageFormat, VkFormat depthFormat, VkAttachmentStoreOp depthStoreOp) {
 		//one color buffer attachment to one image
 		VkAttachmentDescription colorAttachment{};
 		colorAttachment.format = _swapchainImageFormat;
@@ -31,45 +31,54 @@ namespace one {
 		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 		//how pixels of the images aresupposed to be arranged. matches the operation being made at stage
 		//as: color attachments ; present to swapchain ; destination for copy operations
-		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;//before render pass
-		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;//right after render finishes
+		//the render graph moves the image in and out of it(see RenderGraph), the pass itself never transitions
+		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;//before render pass
+		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;//right after render finishes
 
+		//depth is cleared every frame, kept only if it is read after the pass(the Hi-Z pyramid is built from it)
+		//with DONT_CARE it never has to leave tile memory on tile based gpus
+		VkAttachmentDescription depthAttachment{};
+		depthAttachment.format = depthFormat;
+		depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		depthAttachment.storeOp = depthStoreOp;
+		depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		depthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
 		//Subpasses -  rendering operations that depend on frambuffer previous passes(for now just 1)
 		//putting in a single render pass allows vulkan to optimize it
 		VkAttachmentReference colorAttachmentRef{};
 		colorAttachmentRef.attachment = 0;//index in attachment description array(for now just one so index 0)
 		colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;//layout during subpass
+		VkAttachmentReference depthAttachmentRef{};
+		depthAttachmentRef.attachment = 1;
+		depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 		VkSubpassDescription subpass{};
 		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
 		subpass.colorAttachmentCount = 1;
 		//this is the index used in "location": layout(location = 0) out vec4 outColor
 		subpass.pColorAttachments = &colorAttachmentRef;
+		//the depth prepass and the color pass share the subpass, they only switch pipelines
+		subpass.pDepthStencilAttachment = &depthAttachmentRef;
 		//other ones needed in the future: 
 		// pInputAttachments(read from shader) 
 		// pResolveAttachments(multisampling color)
-		// pDepthStencilAttachment(depth and Stencil data)
 		// pPreserveAttachments(not used for this subpass but has to be passed on)
 
+		VkAttachmentDescription attachments[] = { colorAttachment, depthAttachment };
 		VkRenderPassCreateInfo renderPassInfo{};
 		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-		renderPassInfo.attachmentCount = 1;
-		renderPassInfo.pAttachments = &colorAttachment;
+		renderPassInfo.attachmentCount = 2;
+		renderPassInfo.pAttachments = attachments;
 		renderPassInfo.subpassCount = 1;
 		renderPassInfo.pSubpasses = &subpass;
 
-		//dependencies are the info about which subpass needs which to be done so the tasks cna be executed and who needs them
-		VkSubpassDependency dependency{};
-		//src must be bigger than dst
-		dependency.srcSubpass = VK_SUBPASS_EXTERNAL;//source - where it is coming from
-		dependency.dstSubpass = 0;//destination - where it is referring to (we just have one so 0)
-		dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;//pass where they occur
-		dependency.srcAccessMask = 0;//operations to wait on(we are waiting on whole stage itself so imgae to finish being read from on swapchain)
-		dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;//pass where they occur
-		dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;//operations waiting(in this case waiting to write)
-
-		renderPassInfo.dependencyCount = 1;
-		renderPassInfo.pDependencies = &dependency;
+		//no dependencies, the render graph's barriers before and after the pass order it against the rest of the frame
+		//(the attachments are already in their layouts so the implicit external dependencies have nothing to transition)
+		renderPassInfo.dependencyCount = 0;
+		renderPassInfo.pDependencies = nullptr;
 
 		if (vkCreateRenderPass(_device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create render pass!");
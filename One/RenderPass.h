@@ -6,10 +6,13 @@ namespace one {
 	{
 	public:
 
-		RenderPass(VkDevice _device, VkFormat _swapchainImageFormat);
+		//attachment 0 is color, attachment 1 depth
+		//depth is only stored if something reads it after the pass, DONT_CARE for a transient attachment(see RenderGraph::isTransientAttachment)
+		//attachments start and end in their attachment layouts, the render graph transitions and synchronizes them around the pass
+		RenderPass(VkDevice _device, VkFormat _swapchainImageFormat, VkFormat depthFormat, VkAttachmentStoreOp depthStoreOp);
 		~RenderPass();
 
-		void initialize(VkFormat _swapchainImageFormat);
+		void initialize(VkFormat _swapchainImageFormat, VkFormat depthFormat, VkAttachmentStoreOp depthStoreOp);
 		void destroy();
 
 		inline VkRenderPass getRenderPass(void) const {
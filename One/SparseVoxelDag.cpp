@@ -0,0 +1,141 @@
+#include "SparseVoxelDag.h"
+#include <algorithm>
+#include <cassert>
+
+namespace one {
+	//children in the order the representative is looked for, the upper half first(terrain is seen from above)
+	static const uint32_t REPRESENTATIVE_ORDER[8] = { 2, 3, 6, 7, 0, 1, 4, 5 };
+
+	SparseVoxelDag::SparseVoxelDag() {
+		initialize();
+	}
+
+	void SparseVoxelDag::initialize() {
+		//an empty cube until setRoot
+		words.assign(HEADER_SIZE, 0);
+	}
+
+	uint32_t SparseVoxelDag::addBlocks(const BlockId* pBlocks, uint32_t level) {
+		assert(level >= 1);
+		return addCube(pBlocks, 1u << level, 0, 0, 0, level);
+	}
+
+	uint32_t SparseVoxelDag::addCube(const BlockId* pBlocks, uint32_t side, uint32_t x, uint32_t y, uint32_t z, uint32_t level) {
+		if (level == 1) {
+			uint32_t leaf[LEAF_SIZE] = { 0, 0 };
+			for (uint32_t i = 0; i < 8; i++) {
+				uint32_t blockX = x + (i & 1);
+				uint32_t blockY = y + ((i >> 1) & 1);
+				uint32_t blockZ = z + ((i >> 2) & 1);
+				BlockId block = pBlocks[(static_cast<size_t>(blockY) * side + blockZ) * side + blockX];
+				leaf[i >> 2] |= static_cast<uint32_t>(block) << ((i & 3) * 8);
+			}
+			if (leaf[0] == 0 && leaf[1] == 0) {
+				return 0;
+			}
+			return addUnique(leaves, leaf, LEAF_SIZE);
+		}
+		uint32_t half = 1u << (level - 1);
+		std::array<uint32_t, 8> children;
+		for (uint32_t i = 0; i < 8; i++) {
+			children[i] = addCube(pBlocks, side, x + (i & 1) * half, y + ((i >> 1) & 1) * half, z + ((i >> 2) & 1) * half, level - 1);
+		}
+		return addNode(children, level);
+	}
+
+	uint32_t SparseVoxelDag::addNode(const std::array<uint32_t, 8>& children, uint32_t level) {
+		assert(level >= 2);
+		uint32_t node[NODE_SIZE];
+		node[0] = BLOCK_AIR;
+		for (uint32_t i : REPRESENTATIVE_ORDER) {
+			if (children[i] != 0) {
+				node[0] = getRepresentative(children[i], level - 1);
+				break;
+			}
+		}
+		if (node[0] == BLOCK_AIR) {
+			return 0;
+		}
+		std::copy(children.begin(), children.end(), node + 1);
+		return addUnique(nodes, node, NODE_SIZE);
+	}
+
+	BlockId SparseVoxelDag::getRepresentative(uint32_t node, uint32_t level) const {
+		if (level > 1) {
+			return static_cast<BlockId>(words[node]);
+		}
+		for (uint32_t i : REPRESENTATIVE_ORDER) {
+			BlockId block = static_cast<BlockId>(words[node + (i >> 2)] >> ((i & 3) * 8));
+			if (block != BLOCK_AIR) {
+				return block;
+			}
+		}
+		return BLOCK_AIR;
+	}
+
+	uint32_t SparseVoxelDag::merge(const SparseVoxelDag& other, uint32_t node, uint32_t level) {
+		//other is a dag too, every shared subtree of it is only walked once
+		std::unordered_map<uint32_t, uint32_t> merged;
+		return mergeNode(other, node, level, merged);
+	}
+
+	uint32_t SparseVoxelDag::mergeNode(const SparseVoxelDag& other, uint32_t node, uint32_t level, std::unordered_map<uint32_t, uint32_t>& merged) {
+		if (node == 0) {
+			return 0;
+		}
+		auto entry = merged.find(node);
+		if (entry != merged.end()) {
+			return entry->second;
+		}
+		uint32_t result;
+		if (level == 1) {
+			result = addUnique(leaves, other.words.data() + node, LEAF_SIZE);
+		}
+		else {
+			std::array<uint32_t, 8> children;
+			for (uint32_t i = 0; i < 8; i++) {
+				children[i] = mergeNode(other, other.words[node + 1 + i], level - 1, merged);
+			}
+			result = addNode(children, level);
+		}
+		merged[node] = result;
+		return result;
+	}
+
+	uint32_t SparseVoxelDag::addUnique(std::unordered_multimap<uint64_t, uint32_t>& index, const uint32_t* pNode, uint32_t size) {
+		//fnv-1a over the words
+		uint64_t hash = 14695981039346656037ull;
+		for (uint32_t i = 0; i < size; i++) {
+			hash = (hash ^ pNode[i]) * 1099511628211ull;
+		}
+		auto range = index.equal_range(hash);
+		for (auto candidate = range.first; candidate != range.second; candidate++) {
+			if (std::equal(pNode, pNode + size, words.begin() + candidate->second)) {
+				return candidate->second;
+			}
+		}
+		uint32_t offset = static_cast<uint32_t>(words.size());
+		words.insert(words.end(), pNode, pNode + size);
+		index.emplace(hash, offset);
+		return offset;
+	}
+
+	void SparseVoxelDag::setRoot(uint32_t node, uint32_t levels, glm::ivec3 minimum) {
+		words[0] = node;
+		words[1] = levels;
+		words[2] = static_cast<uint32_t>(minimum.x);
+		words[3] = static_cast<uint32_t>(minimum.y);
+		words[4] = static_cast<uint32_t>(minimum.z);
+	}
+
+	void SparseVoxelDag::destroy() {
+		words.clear();
+		words.shrink_to_fit();
+		leaves.clear();
+		nodes.clear();
+	}
+
+	SparseVoxelDag::~SparseVoxelDag() {
+		destroy();
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "UtilHeader.h"
+#include <array>
+#include <unordered_map>
+#include "BlockStorage.h"
+
+namespace one {
+	//sparse voxel octree of blocks with identical subtrees stored once(a directed acyclic graph), flat in 32 bit words so it can be uploaded as is
+	//layout: HEADER_SIZE words(root offset, levels, minimum x, y, z as signed ints), then the nodes, a node is referenced by the offset of its first word
+	//a node of level l covers a cube of 2^l blocks, its children are numbered x + 2y + 4z(1 for the upper half of the axis)
+	//level 1 is a leaf: LEAF_SIZE words holding its 8 blocks, a byte each in child order
+	//above it a node is NODE_SIZE words: its representative block(what it looks like from afar) and the offsets of its children
+	//offset 0 is the header, a child of 0 is all air and has no node at all
+	//farfield.frag walks the same layout
+	class SparseVoxelDag : NonCopyable
+	{
+	public:
+
+		static const uint32_t HEADER_SIZE = 8;
+		static const uint32_t LEAF_SIZE = 2;
+		static const uint32_t NODE_SIZE = 9;
+
+		//only the header, no nodes
+		SparseVoxelDag();
+		~SparseVoxelDag();
+
+		void initialize();
+		void destroy();
+
+		//adds the nodes of a cube of 2^level blocks laid out like a chunk(x fastest, then z, then y), returns its node, 0 if it is all air
+		uint32_t addBlocks(const BlockId* pBlocks, uint32_t level);
+		//adds a node of level over children of the level below(0 for air), returns 0 if every child is air
+		uint32_t addNode(const std::array<uint32_t, 8>& children, uint32_t level);
+		//adds node of other(of level) and everything under it, returns where it ended up in this one
+		//subtrees this one already has are shared, not copied
+		uint32_t merge(const SparseVoxelDag& other, uint32_t node, uint32_t level);
+
+		//root of a cube of 2^levels blocks whose first block is at minimum, written to the header
+		void setRoot(uint32_t node, uint32_t levels, glm::ivec3 minimum);
+
+		inline const std::vector<uint32_t>& getWords(void) const {
+			return words;
+		}
+
+		inline size_t getByteSize(void) const {
+			return words.size() * sizeof(uint32_t);
+		}
+
+		//unique leaves and nodes
+		inline size_t getNodeCount(void) const {
+			return leaves.size() + nodes.size();
+		}
+
+	private:
+
+		//leaf or node of level 1 + level and x, y, z(in blocks) of a cube side blocks wide
+		uint32_t addCube(const BlockId* pBlocks, uint32_t side, uint32_t x, uint32_t y, uint32_t z, uint32_t level);
+		uint32_t mergeNode(const SparseVoxelDag& other, uint32_t node, uint32_t level, std::unordered_map<uint32_t, uint32_t>& merged);
+		//offset of a node with the same size words, appended if there is none
+		uint32_t addUnique(std::unordered_multimap<uint64_t, uint32_t>& index, const uint32_t* pNode, uint32_t size);
+		//topmost block that is not air(the upper children first), what the node is drawn as once it is smaller than a pixel
+		BlockId getRepresentative(uint32_t node, uint32_t level) const;
+
+		std::vector<uint32_t> words;
+
+		//hash of the words to the offsets with that hash, leaves and nodes apart since they differ in size
+		std::unordered_multimap<uint64_t, uint32_t> leaves;
+		std::unordered_multimap<uint64_t, uint32_t> nodes;
+
+	};
+}
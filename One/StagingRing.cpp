@@ -0,0 +1,254 @@
+#include "StagingRing.h"
+#include <algorithm>
+#include <cstring>
+
+namespace one {
+	//flushes that can be in flight before the oldest one has to be waited on
+	static const uint32_t MAX_SUBMISSIONS = 4;
+	//copy source offsets are kept aligned for the copy engine
+	static const VkDeviceSize RING_ALIGNMENT = 16;
+
+	StagingRing::StagingRing(Device* pDevice, Queue* pTransferQueue, Queue* pGraphicsQueue, VkDeviceSize size) :
+		pDevice(pDevice), _device(pDevice->getDevice()), pTransferQueue(pTransferQueue), pGraphicsQueue(pGraphicsQueue) {
+		initialize(size);
+	}
+
+	void StagingRing::initialize(VkDeviceSize size) {
+		ringSize = size;
+		//written by the cpu, read once by the copy, coherent so no flush of mapped ranges is needed
+		pRingBuffer = new Buffer(pDevice, ringSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0);
+		pRing = static_cast<uint8_t*>(pRingBuffer->getMapped());
+
+		ownershipTransfer = pTransferQueue->getFamilyIndex() != pGraphicsQueue->getFamilyIndex();
+
+		submissions.resize(MAX_SUBMISSIONS);
+		for (auto& submission : submissions) {
+			submission.pTransferCommands = new CommandBuffer(_device, pTransferQueue->getCommandPool());
+			submission.pAcquireCommands = ownershipTransfer ? new CommandBuffer(_device, pGraphicsQueue->getCommandPool()) : nullptr;
+			//with timelines the acquire waits on the transfer queue value instead
+			submission.pTransferFinished = (ownershipTransfer && !pTransferQueue->hasTimeline()) ? new Semaphore(_device) : nullptr;
+			submission.value = 0;
+			submission.bytes = 0;
+		}
+
+		std::cerr << "vulkan stagingring has initiated" << (ownershipTransfer ? " on a dedicated transfer queue \n" : " on the graphics queue \n");
+	}
+
+	void StagingRing::retireSubmissions(bool wait) {
+		while (!pendingSubmissions.empty()) {
+			Submission& submission = submissions[pendingSubmissions.front()];
+			Queue* pCompletionQueue = getCompletionQueue();
+			if (wait) {
+				if (!pCompletionQueue->waitForValue(submission.value, UINT64_MAX)) {
+					throw std::runtime_error("failed to wait for upload!");
+				}
+			}
+			else if (pCompletionQueue->getCompletedValue() < submission.value) {
+				return;
+			}
+			outstanding -= submission.bytes;
+			pendingSubmissions.pop_front();
+			if (wait) {
+				//only wait for as much as the caller needs, one at a time
+				return;
+			}
+		}
+	}
+
+	VkDeviceSize StagingRing::reserve(VkDeviceSize size) {
+		retireSubmissions(false);
+		while (true) {
+			//nothing in use, start from the beginning so anything up to the ring size fits
+			if (outstanding == 0 && recordedBytes == 0) {
+				head = 0;
+			}
+			VkDeviceSize offset = (head + RING_ALIGNMENT - 1) & ~(RING_ALIGNMENT - 1);
+			VkDeviceSize padding = offset - head;
+			//doesnt fit before the end, skip the rest and wrap to the beginning
+			if (offset + size > ringSize) {
+				padding = ringSize - head;
+				offset = 0;
+			}
+			if (outstanding + recordedBytes + padding + size <= ringSize) {
+				recordedBytes += padding + size;
+				head = offset + size;
+				return offset;
+			}
+
+			//ring is full, copies recorded so far have to go out before their space can come back
+			if (recording) {
+				flush();
+			}
+			retireSubmissions(true);
+		}
+	}
+
+	void StagingRing::beginRecording() {
+		Submission& submission = submissions[currentSubmission];
+		//the slot may still be in flight from MAX_SUBMISSIONS flushes ago
+		while (std::find(pendingSubmissions.begin(), pendingSubmissions.end(), currentSubmission) != pendingSubmissions.end()) {
+			retireSubmissions(true);
+		}
+
+		submission.pTransferCommands->reset();
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		if (vkBeginCommandBuffer(submission.pTransferCommands->getCommandBuffer(), &beginInfo) != VK_SUCCESS) {
+			throw std::runtime_error("failed to begin recording upload command buffer!");
+		}
+		recording = true;
+	}
+
+	void StagingRing::upload(VkBuffer destination, VkDeviceSize destinationOffset, const void* pData, VkDeviceSize size,
+		VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) {
+		const uint8_t* pSource = static_cast<const uint8_t*>(pData);
+		VkDeviceSize uploaded = 0;
+		while (uploaded < size) {
+			VkDeviceSize pieceSize = std::min(size - uploaded, ringSize);
+			VkDeviceSize offset = reserve(pieceSize);
+			//reserve may have flushed, so start recording after it
+			if (!recording) {
+				beginRecording();
+			}
+
+			std::memcpy(pRing + offset, pSource + uploaded, pieceSize);
+
+			VkBufferCopy copyRegion{};
+			copyRegion.srcOffset = offset;
+			copyRegion.dstOffset = destinationOffset + uploaded;
+			copyRegion.size = pieceSize;
+			vkCmdCopyBuffer(submissions[currentSubmission].pTransferCommands->getCommandBuffer(), pRingBuffer->getBuffer(), destination, 1, &copyRegion);
+
+			//with a dedicated family this is the release half of the ownership transfer, otherwise a plain barrier
+			VkBufferMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			//dstAccessMask is ignored by a release, the acquire copy below uses it
+			barrier.dstAccessMask = dstAccess;
+			barrier.srcQueueFamilyIndex = ownershipTransfer ? pTransferQueue->getFamilyIndex() : VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = ownershipTransfer ? pGraphicsQueue->getFamilyIndex() : VK_QUEUE_FAMILY_IGNORED;
+			barrier.buffer = destination;
+			barrier.offset = copyRegion.dstOffset;
+			barrier.size = pieceSize;
+			releaseBarriers.push_back(barrier);
+			dstStages |= dstStage;
+
+			uploaded += pieceSize;
+		}
+	}
+
+	void StagingRing::flush() {
+		if (!recording) {
+			return;
+		}
+		Submission& submission = submissions[currentSubmission];
+		VkCommandBuffer transferCommands = submission.pTransferCommands->getCommandBuffer();
+
+		//release(or make visible) everything copied in this flush at once
+		vkCmdPipelineBarrier(transferCommands, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			ownershipTransfer ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : dstStages,
+			0, 0, nullptr, static_cast<uint32_t>(releaseBarriers.size()), releaseBarriers.data(), 0, nullptr);
+
+		if (vkEndCommandBuffer(transferCommands) != VK_SUCCESS) {
+			throw std::runtime_error("failed to record upload command buffer!");
+		}
+
+		VkSubmitInfo transferSubmitInfo{};
+		transferSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		transferSubmitInfo.commandBufferCount = 1;
+		transferSubmitInfo.pCommandBuffers = submission.pTransferCommands->getCommandBufferPointer();
+
+		if (!ownershipTransfer) {
+			//same queue as the frames, submission order and the barrier are enough
+			submission.value = pTransferQueue->submit(transferSubmitInfo);
+		}
+		else {
+			VkSemaphore transferFinished = VK_NULL_HANDLE;
+			if (submission.pTransferFinished != nullptr) {
+				transferFinished = submission.pTransferFinished->getSemaphore();
+				transferSubmitInfo.signalSemaphoreCount = 1;
+				transferSubmitInfo.pSignalSemaphores = &transferFinished;
+			}
+			uint64_t transferValue = pTransferQueue->submit(transferSubmitInfo);
+
+			//acquire half: same barriers recorded on the graphics family, waits for the copies through the semaphore(or value)
+			std::vector<VkBufferMemoryBarrier> acquireBarriers = releaseBarriers;
+			for (size_t i = 0; i < acquireBarriers.size(); i++) {
+				acquireBarriers[i].srcAccessMask = 0;
+			}
+
+			VkCommandBuffer acquireCommands = submission.pAcquireCommands->getCommandBuffer();
+			submission.pAcquireCommands->reset();
+			VkCommandBufferBeginInfo beginInfo{};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			if (vkBeginCommandBuffer(acquireCommands, &beginInfo) != VK_SUCCESS) {
+				throw std::runtime_error("failed to begin recording acquire command buffer!");
+			}
+			vkCmdPipelineBarrier(acquireCommands, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dstStages,
+				0, 0, nullptr, static_cast<uint32_t>(acquireBarriers.size()), acquireBarriers.data(), 0, nullptr);
+			if (vkEndCommandBuffer(acquireCommands) != VK_SUCCESS) {
+				throw std::runtime_error("failed to record acquire command buffer!");
+			}
+
+			VkSubmitInfo acquireSubmitInfo{};
+			acquireSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			acquireSubmitInfo.commandBufferCount = 1;
+			acquireSubmitInfo.pCommandBuffers = submission.pAcquireCommands->getCommandBufferPointer();
+			//acquire waits for the transfer, so its value covers both submissions
+			if (submission.pTransferFinished != nullptr) {
+				acquireSubmitInfo.waitSemaphoreCount = 1;
+				acquireSubmitInfo.pWaitSemaphores = &transferFinished;
+				acquireSubmitInfo.pWaitDstStageMask = &dstStages;
+				submission.value = pGraphicsQueue->submit(acquireSubmitInfo);
+			}
+			else {
+				submission.value = pGraphicsQueue->submit(acquireSubmitInfo, { { pTransferQueue, transferValue, dstStages } });
+			}
+		}
+
+		submission.bytes = recordedBytes;
+		outstanding += recordedBytes;
+		pendingSubmissions.push_back(currentSubmission);
+		currentSubmission = (currentSubmission + 1) % MAX_SUBMISSIONS;
+
+		recording = false;
+		recordedBytes = 0;
+		releaseBarriers.clear();
+		dstStages = 0;
+	}
+
+	void StagingRing::waitIdle() {
+		flush();
+		while (!pendingSubmissions.empty()) {
+			retireSubmissions(true);
+		}
+	}
+
+	void StagingRing::destroy() {
+		if (pRingBuffer == nullptr) {
+			return;
+		}
+		waitIdle();
+		//command buffers are freed with their pools
+		for (auto& submission : submissions) {
+			delete submission.pTransferCommands;
+			delete submission.pAcquireCommands;
+			if (submission.pTransferFinished != nullptr) {
+				submission.pTransferFinished->destroy();
+				delete submission.pTransferFinished;
+			}
+		}
+		submissions.clear();
+
+		pRingBuffer->destroy();
+		delete pRingBuffer;
+		pRingBuffer = nullptr;
+	}
+
+	StagingRing::~StagingRing() {
+		destroy();
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include "UtilHeader.h"
+#include <deque>
+#include "Buffer.h"
+#include "CommandBuffer.h"
+#include "Queue.h"
+#include "Semaphore.h"
+
+namespace one {
+	//host visible ring buffer that data is written to before being copied into device local buffers
+	//copies run on the transfer queue(a dedicated transfer family if the gpu has one, so big uploads dont stall graphics)
+	//space is reused once the queue value of the submission that read it has been reached
+	class StagingRing : NonCopyable
+	{
+	public:
+
+		//pTransferQueue can be the same family as pGraphicsQueue, then no ownership transfer is needed
+		StagingRing(Device* pDevice, Queue* pTransferQueue, Queue* pGraphicsQueue, VkDeviceSize size);
+		~StagingRing();
+
+		void initialize(VkDeviceSize size);
+		void destroy();
+
+		//copies pData into the ring and records a copy to destination, dstStage/dstAccess is how graphics will use it
+		//bigger than the ring is split in pieces, may flush and wait when the ring is full
+		void upload(VkBuffer destination, VkDeviceSize destinationOffset, const void* pData, VkDeviceSize size,
+			VkPipelineStageFlags dstStage, VkAccessFlags dstAccess);
+		//submits the recorded copies, anything submitted to the graphics queue afterwards sees the data
+		void flush();
+		//blocks until every submitted copy is done
+		void waitIdle();
+
+	private:
+
+		//one flush, transfer commands and(with a dedicated transfer family) the graphics side acquire
+		struct Submission {
+			CommandBuffer* pTransferCommands;
+			CommandBuffer* pAcquireCommands;
+			//binary fallback of the transfer to graphics wait, nullptr with timeline semaphores
+			Semaphore* pTransferFinished;
+			//value on the completion queue(graphics with an ownership transfer, transfer otherwise)
+			uint64_t value;
+			//ring bytes it holds(including the piece skipped when wrapping)
+			VkDeviceSize bytes;
+		};
+
+		//offset in the ring for size bytes, waits for old submissions if needed
+		VkDeviceSize reserve(VkDeviceSize size);
+		//gives back the space of every finished submission
+		void retireSubmissions(bool wait);
+		void beginRecording();
+
+		//queue whose value tells when a submission is completely done
+		inline Queue* getCompletionQueue(void) const {
+			return ownershipTransfer ? pGraphicsQueue : pTransferQueue;
+		}
+
+		Device* pDevice;
+		VkDevice _device;
+
+		Queue* pTransferQueue;
+		Queue* pGraphicsQueue;
+		bool ownershipTransfer = false;
+
+		Buffer* pRingBuffer{ nullptr };
+		uint8_t* pRing = nullptr;
+		VkDeviceSize ringSize = 0;
+		VkDeviceSize head = 0;
+		//bytes written but not yet released by a finished submission
+		VkDeviceSize outstanding = 0;
+
+		std::vector<Submission> submissions;
+		uint32_t currentSubmission = 0;
+		//submission indices in flight, oldest first
+		std::deque<uint32_t> pendingSubmissions;
+
+		//copies recorded since the last flush
+		bool recording = false;
+		VkDeviceSize recordedBytes = 0;
+		std::vector<VkBufferMemoryBarrier> releaseBarriers;
+		VkPipelineStageFlags dstStages = 0;
+
+	};
+}
@@ -8,6 +8,26 @@ namespace one {
 
 
 	void SwapChain::initialize(VkDevice _device, VkPhysicalDevice physicalGraphicsDevice /*uint32_t queueFamilyIndices[]*/) {
+		create(_device, physicalGraphicsDevice, VK_NULL_HANDLE);
+
+		std::cerr << "vulkan KHR swapchain has initiated \n";
+	}
+
+	void SwapChain::recreate(VkDevice _device, VkPhysicalDevice physicalGraphicsDevice) {
+		//the old swapchain is not destroyed here, the frames in flight may still be rendering to
+		//or presenting its images, so we retire it and let the owner destroy it later(no waiting on the device)
+		RetiredSwapChain retired{};
+		retired.swapChain = swapChain;
+		retired.pImageViews = std::move(pSwapChainImageViews);
+		retiredSwapChains.push_back(std::move(retired));
+		pSwapChainImageViews.clear();
+
+		create(_device, physicalGraphicsDevice, retiredSwapChains.back().swapChain);
+
+		std::cerr << "vulkan KHR swapchain has been recreated \n";
+	}
+
+	void SwapChain::create(VkDevice _device, VkPhysicalDevice physicalGraphicsDevice, VkSwapchainKHR oldSwapChain) {
 		//get supported by graphics device and surface
 		SwapChainSupportDetails swapChainSupport = querySwapChainSupport(physicalGraphicsDevice);
 
@@ -51,7 +71,8 @@ namespace one {
 		createInfo.clipped = VK_TRUE;
 		//if swapchain becames obsolete(like we changed the window size)
 		//we must create a new one and the old one needs to be referenced here;
-		createInfo.oldSwapchain = VK_NULL_HANDLE;
+		//lets the driver reuse its resources and keeps presenting the old images until the new ones are ready
+		createInfo.oldSwapchain = oldSwapChain;
 
 		if (vkCreateSwapchainKHR(_device, &createInfo, nullptr, &swapChain) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create swap-chain!");
@@ -64,8 +85,6 @@ namespace one {
 		swapChainExtent = extent;
 
 		initializeImageViews(_device);
-
-		std::cerr << "vulkan KHR swapchain has initiated \n";
 	}
 
 	SwapChain::SwapChainSupportDetails SwapChain::querySwapChainSupport(const VkPhysicalDevice graphicsDevice) {
@@ -156,13 +175,28 @@ namespace one {
 		}
 	}
 
-	uint32_t SwapChain::nextImage(VkDevice _device, VkSemaphore _semaphore) {
-		uint32_t imageIndex;
-		vkAcquireNextImageKHR(_device, swapChain, UINT64_MAX,_semaphore, VK_NULL_HANDLE, &imageIndex);
-		return imageIndex;
+	VkResult SwapChain::nextImage(VkDevice _device, VkSemaphore _semaphore, uint32_t& imageIndex) {
+		VkResult result = vkAcquireNextImageKHR(_device, swapChain, UINT64_MAX,_semaphore, VK_NULL_HANDLE, &imageIndex);
+		if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR && result != VK_ERROR_OUT_OF_DATE_KHR) {
+			throw std::runtime_error("failed to acquire swap chain image!");
+		}
+		return result;
+	}
+
+	void SwapChain::destroyRetired(VkDevice _device) {
+		for (auto& retired : retiredSwapChains) {
+			for (auto imageView : retired.pImageViews) {
+				imageView->destroy(_device);
+				delete imageView;
+			}
+			vkDestroySwapchainKHR(_device, retired.swapChain, nullptr);
+		}
+		retiredSwapChains.clear();
 	}
 
 	void SwapChain::destroy(VkDevice _device) {
+		destroyRetired(_device);
+
 		for (auto imageView : pSwapChainImageViews) {
 			imageView->destroy(_device);
 			delete imageView;
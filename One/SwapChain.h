@@ -12,6 +12,11 @@ namespace one {
 		~SwapChain();
 
 		void initialize(VkDevice _device, VkPhysicalDevice physicalGraphicsDevice);
+		//creates a new swapchain handing the current one over as oldSwapchain, 
+		//the old one is kept retired until destroyRetired is called
+		void recreate(VkDevice _device, VkPhysicalDevice physicalGraphicsDevice);
+		//only call once the gpu is done with every frame that used the retired swapchains
+		void destroyRetired(VkDevice _device);
 		void destroy(VkDevice _device);
 
 		struct SwapChainSupportDetails {
@@ -21,7 +26,8 @@ namespace one {
 		};
 		SwapChainSupportDetails querySwapChainSupport(const VkPhysicalDevice graphicsDevice);
 
-		uint32_t nextImage(VkDevice _device, VkSemaphore _semaphore);
+		//returns VK_SUCCESS, VK_SUBOPTIMAL_KHR(image acquired but should recreate) or VK_ERROR_OUT_OF_DATE_KHR(no image, must recreate)
+		VkResult nextImage(VkDevice _device, VkSemaphore _semaphore, uint32_t& imageIndex);
 
 		inline VkSurfaceKHR getSurface() const {
 			return  surface;
@@ -39,6 +45,10 @@ namespace one {
 			return swapChainImages.size();
 		}
 
+		inline VkImage getImage(int index) const {
+			return swapChainImages[index];
+		}
+
 		inline VkImageView getImageViews(int index) const {
 			return pSwapChainImageViews[index]->getImageView();
 		}
@@ -47,8 +57,13 @@ namespace one {
 			return swapChain;
 		}
 
+		inline bool hasRetired() const {
+			return !retiredSwapChains.empty();
+		}
+
 
 	private:
+		void create(VkDevice _device, VkPhysicalDevice physicalGraphicsDevice, VkSwapchainKHR oldSwapChain);
 		void initializeImageViews(VkDevice _device);
 
 		//swapchain(handles images from vulkan to surface)
@@ -65,6 +80,13 @@ namespace one {
 		//Image views(kind of like perspectives of image), depth, volumetric(?), etc.
 		std::vector<ImageView*> pSwapChainImageViews;
 
+		//swapchains replaced by recreate, their images may still be in use by frames in flight or the presentation engine
+		struct RetiredSwapChain {
+			VkSwapchainKHR swapChain;
+			std::vector<ImageView*> pImageViews;
+		};
+		std::vector<RetiredSwapChain> retiredSwapChains;
+
 		//SwapChain details
 		std::vector<VkImage> swapChainImages;
 		VkExtent2D swapChainExtent;
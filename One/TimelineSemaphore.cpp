@@ -0,0 +1,69 @@
+#include "TimelineSemaphore.h"
+
+namespace one {
+	TimelineSemaphore::TimelineSemaphore(VkDevice _device, uint64_t initialValue) : _device(_device) {
+		initialize(initialValue);
+	}
+
+	void TimelineSemaphore::initialize(uint64_t initialValue) {
+		pWaitSemaphores = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(vkGetDeviceProcAddr(_device, "vkWaitSemaphoresKHR"));
+		pSignalSemaphore = reinterpret_cast<PFN_vkSignalSemaphoreKHR>(vkGetDeviceProcAddr(_device, "vkSignalSemaphoreKHR"));
+		pGetSemaphoreCounterValue = reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(vkGetDeviceProcAddr(_device, "vkGetSemaphoreCounterValueKHR"));
+		if (pWaitSemaphores == nullptr || pSignalSemaphore == nullptr || pGetSemaphoreCounterValue == nullptr) {
+			throw std::runtime_error("failed to load timeline semaphore functions!");
+		}
+
+		VkSemaphoreTypeCreateInfoKHR typeInfo{};
+		typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+		typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+		typeInfo.initialValue = initialValue;
+
+		VkSemaphoreCreateInfo semaphoreInfo{};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphoreInfo.pNext = &typeInfo;
+
+		if (vkCreateSemaphore(_device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create timeline semaphore!");
+		}
+
+		std::cerr << "vulkan timeline semaphore has initiated \n";
+	}
+
+	bool TimelineSemaphore::wait(uint64_t value, uint64_t timeout) {
+		VkSemaphoreWaitInfoKHR waitInfo{};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &semaphore;
+		waitInfo.pValues = &value;
+		return pWaitSemaphores(_device, &waitInfo, timeout) == VK_SUCCESS;
+	}
+
+	void TimelineSemaphore::signal(uint64_t value) {
+		VkSemaphoreSignalInfoKHR signalInfo{};
+		signalInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO_KHR;
+		signalInfo.semaphore = semaphore;
+		signalInfo.value = value;
+		if (pSignalSemaphore(_device, &signalInfo) != VK_SUCCESS) {
+			throw std::runtime_error("failed to signal timeline semaphore!");
+		}
+	}
+
+	uint64_t TimelineSemaphore::getValue(void) {
+		uint64_t value = 0;
+		if (pGetSemaphoreCounterValue(_device, semaphore, &value) != VK_SUCCESS) {
+			throw std::runtime_error("failed to read timeline semaphore value!");
+		}
+		return value;
+	}
+
+	void TimelineSemaphore::destroy() {
+		if (semaphore != VK_NULL_HANDLE) {
+			vkDestroySemaphore(_device, semaphore, nullptr);
+			semaphore = VK_NULL_HANDLE;
+		}
+	}
+
+	TimelineSemaphore::~TimelineSemaphore() {
+		destroy();
+	}
+}
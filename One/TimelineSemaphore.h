@@ -0,0 +1,40 @@
+#pragma once
+#include "UtilHeader.h"
+
+namespace one {
+	//semaphore holding a 64 bit counter instead of signaled/unsignaled(VK_KHR_timeline_semaphore)
+	//the gpu signals increasing values, the cpu and other queues wait for a value to be reached
+	//one of them replaces a fence per frame slot and never has to be reset
+	class TimelineSemaphore : NonCopyable
+	{
+	public:
+
+		TimelineSemaphore(VkDevice _device, uint64_t initialValue);
+		~TimelineSemaphore();
+
+		void initialize(uint64_t initialValue);
+		void destroy();
+
+		//false on timeout
+		bool wait(uint64_t value, uint64_t timeout);
+		//sets the counter from the cpu
+		void signal(uint64_t value);
+		uint64_t getValue(void);
+
+		inline VkSemaphore getSemaphore(void) const {
+			return semaphore;
+		}
+
+	private:
+
+		VkDevice _device;
+
+		VkSemaphore semaphore = VK_NULL_HANDLE;
+
+		//extension entry points, the loader only exports core functions
+		PFN_vkWaitSemaphoresKHR pWaitSemaphores = nullptr;
+		PFN_vkSignalSemaphoreKHR pSignalSemaphore = nullptr;
+		PFN_vkGetSemaphoreCounterValueKHR pGetSemaphoreCounterValue = nullptr;
+
+	};
+}
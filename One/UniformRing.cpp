@@ -0,0 +1,152 @@
+#include "UniformRing.h"
+#include <algorithm>
+
+namespace one {
+	UniformRing::UniformRing(Device* pDevice, Queue* pQueue, uint32_t regionCount, VkDeviceSize regionSize) :
+		pDevice(pDevice), _device(pDevice->getDevice()), pQueue(pQueue) {
+		initialize(regionCount, regionSize);
+	}
+
+	void UniformRing::initialize(uint32_t regionCount, VkDeviceSize size) {
+		regionSize = size;
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(pDevice->getPhysicalGraphicsDevice(), &properties);
+		alignment = properties.limits.minUniformBufferOffsetAlignment;
+
+		//*************************************************************************************
+		//the offset comes with the bind, so the same set serves every allocation of its region
+		VkDescriptorSetLayoutBinding binding{};
+		binding.binding = UNIFORM_BINDING;
+		binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		binding.descriptorCount = 1;
+		binding.stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS;
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.bindingCount = 1;
+		layoutInfo.pBindings = &binding;
+
+		if (vkCreateDescriptorSetLayout(_device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create uniform ring descriptor set layout!");
+		}
+
+		//*************************************************************************************
+		//dynamic descriptors can't be updated after bind, so they are not in the bindless table
+		VkDescriptorPoolSize poolSize{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, MAX_REGIONS };
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.maxSets = MAX_REGIONS;
+		poolInfo.poolSizeCount = 1;
+		poolInfo.pPoolSizes = &poolSize;
+
+		if (vkCreateDescriptorPool(_device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create uniform ring descriptor pool!");
+		}
+
+		resize(regionCount);
+		currentRegion = static_cast<uint32_t>(regions.size());
+
+		std::cerr << "uniform ring has initiated \n";
+	}
+
+	void UniformRing::resize(uint32_t regionCount) {
+		assert(regionCount <= MAX_REGIONS);
+		while (regions.size() < regionCount) {
+			Region region{};
+			//written by the cpu every frame and read straight from there, device local if the gpu has such memory(resizable bar/uma)
+			region.pBuffer = new Buffer(pDevice, regionSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			region.pMapped = static_cast<uint8_t*>(region.pBuffer->getMapped());
+			region.value = 0;
+
+			VkDescriptorSetAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			allocInfo.descriptorPool = descriptorPool;
+			allocInfo.descriptorSetCount = 1;
+			allocInfo.pSetLayouts = &descriptorSetLayout;
+
+			if (vkAllocateDescriptorSets(_device, &allocInfo, &region.descriptorSet) != VK_SUCCESS) {
+				throw std::runtime_error("failed to allocate uniform ring descriptor set!");
+			}
+
+			//the range is what a shader sees past the dynamic offset
+			VkDescriptorBufferInfo bufferInfo{};
+			bufferInfo.buffer = region.pBuffer->getBuffer();
+			bufferInfo.offset = 0;
+			bufferInfo.range = std::min(regionSize, MAX_UNIFORM_RANGE);
+
+			VkWriteDescriptorSet write{};
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = region.descriptorSet;
+			write.dstBinding = UNIFORM_BINDING;
+			write.dstArrayElement = 0;
+			write.descriptorCount = 1;
+			write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+			write.pBufferInfo = &bufferInfo;
+			vkUpdateDescriptorSets(_device, 1, &write, 0, nullptr);
+
+			regions.push_back(region);
+		}
+	}
+
+	void UniformRing::begin(uint32_t region) {
+		assert(region < regions.size());
+		//usually long done, the caller already waited for the frame that used region last
+		if (!pQueue->waitForValue(regions[region].value, UINT64_MAX)) {
+			throw std::runtime_error("failed to wait for uniform ring region!");
+		}
+		currentRegion = region;
+		head = 0;
+	}
+
+	UniformRing::Allocation UniformRing::allocate(VkDeviceSize size) {
+		assert(currentRegion < regions.size());
+		assert(size <= MAX_UNIFORM_RANGE);
+		VkDeviceSize offset = (head + alignment - 1) / alignment * alignment;
+		if (offset + size > regionSize) {
+			throw std::runtime_error("failed to allocate from uniform ring, region is full!");
+		}
+		head = offset + size;
+		return { currentRegion, static_cast<uint32_t>(offset), regions[currentRegion].pMapped + offset };
+	}
+
+	void UniformRing::end(uint64_t submitValue) {
+		assert(currentRegion < regions.size());
+		//coherent memory, the submit makes the writes visible without a flush
+		regions[currentRegion].value = submitValue;
+		currentRegion = static_cast<uint32_t>(regions.size());
+	}
+
+	void UniformRing::bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout, uint32_t firstSet,
+		uint32_t region, uint32_t offset) const {
+		vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout, firstSet, 1, &regions[region].descriptorSet, 1, &offset);
+	}
+
+	void UniformRing::destroy() {
+		if (descriptorPool == VK_NULL_HANDLE) {
+			return;
+		}
+		//nothing may still read a region
+		for (const Region& region : regions) {
+			if (!pQueue->waitForValue(region.value, UINT64_MAX)) {
+				throw std::runtime_error("failed to wait for uniform ring region!");
+			}
+			region.pBuffer->destroy();
+			delete region.pBuffer;
+		}
+		regions.clear();
+
+		//frees the sets
+		vkDestroyDescriptorPool(_device, descriptorPool, nullptr);
+		descriptorPool = VK_NULL_HANDLE;
+		if (descriptorSetLayout != VK_NULL_HANDLE) {
+			vkDestroyDescriptorSetLayout(_device, descriptorSetLayout, nullptr);
+			descriptorSetLayout = VK_NULL_HANDLE;
+		}
+	}
+
+	UniformRing::~UniformRing() {
+		destroy();
+	}
+}
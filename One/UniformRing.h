@@ -0,0 +1,85 @@
+#pragma once
+#include "UtilHeader.h"
+#include "Buffer.h"
+#include "Queue.h"
+
+namespace one {
+	//per frame data(camera, time, ...) written by the cpu every frame and read by the shaders as a dynamic uniform buffer
+	//one persistently mapped, host coherent region per frame, filled by bump allocation from its start
+	//a region is reused once the queue value of the submission that read it has been reached
+	//every region has its own set, the allocation offset is the dynamic offset it is bound with
+	class UniformRing : NonCopyable
+	{
+	public:
+
+		//binding 0 of the set the ring is bound as
+		static const uint32_t UNIFORM_BINDING = 0;
+		//every gpu supports uniform ranges this big(maxUniformBufferRange), an allocation can't be larger
+		static const VkDeviceSize MAX_UNIFORM_RANGE = 16384;
+		//descriptor pool capacity, regions can be added up to this
+		static const uint32_t MAX_REGIONS = 16;
+
+		//a piece of one region, pData stays valid until the region is begun again
+		struct Allocation {
+			uint32_t region;
+			uint32_t offset;
+			void* pData;
+		};
+
+		//pQueue is the queue whose submissions read the ring
+		UniformRing(Device* pDevice, Queue* pQueue, uint32_t regionCount, VkDeviceSize regionSize);
+		~UniformRing();
+
+		void initialize(uint32_t regionCount, VkDeviceSize regionSize);
+		void destroy();
+
+		//adds regions up to regionCount, existing ones(and command buffers bound to them) are kept
+		void resize(uint32_t regionCount);
+
+		//waits for the last submission that read region, then starts allocating from its start
+		void begin(uint32_t region);
+		//size bytes of the begun region, offsets are aligned to minUniformBufferOffsetAlignment
+		Allocation allocate(VkDeviceSize size);
+		//value of the submission that reads what was allocated since begin
+		void end(uint64_t submitValue);
+
+		//binds the set of region as set firstSet of pipelineLayout with offset as its dynamic offset
+		void bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout, uint32_t firstSet,
+			uint32_t region, uint32_t offset) const;
+
+		inline VkDescriptorSetLayout getDescriptorSetLayout(void) const {
+			return descriptorSetLayout;
+		}
+
+		inline uint32_t getRegionCount(void) const {
+			return static_cast<uint32_t>(regions.size());
+		}
+
+	private:
+
+		struct Region {
+			Buffer* pBuffer;
+			uint8_t* pMapped;
+			VkDescriptorSet descriptorSet;
+			//queue value of the last submission reading it
+			uint64_t value;
+		};
+
+		Device* pDevice;
+		VkDevice _device;
+
+		Queue* pQueue;
+
+		VkDescriptorSetLayout descriptorSetLayout{ VK_NULL_HANDLE };
+		VkDescriptorPool descriptorPool{ VK_NULL_HANDLE };
+
+		std::vector<Region> regions;
+		VkDeviceSize regionSize = 0;
+		VkDeviceSize alignment = 0;
+
+		//region being allocated from, regions.size() between end and begin
+		uint32_t currentRegion = 0;
+		VkDeviceSize head = 0;
+
+	};
+}
@@ -3,6 +3,10 @@
 #include <vector>
 #define GLFW_INCLUDE_VULKAN //GLFW has its own definitions for vulkan and will call it
 #include <GLFW/glfw3.h>
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE //vulkan depth range is 0 to 1(opengl is -1 to 1)
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 #include <stdexcept>
 #include <iostream>
 #include <cassert>
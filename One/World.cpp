@@ -0,0 +1,439 @@
+#include "World.h"
+#include <algorithm>
+
+namespace one {
+	//vertices and indices every loaded chunk mesh has to fit in(16MB and 24MB)
+	static const uint32_t ARENA_VERTEX_CAPACITY = 4u * 1024 * 1024;
+	static const uint32_t ARENA_INDEX_CAPACITY = 6u * 1024 * 1024;
+	//saved chunks kept in memory before a job appends them to their regions, a few hundred chunks of terrain
+	static const size_t FLUSH_BYTES = 256 * 1024;
+
+	World::World(Device* pDevice, StagingRing* pStagingRing, JobSystem* pJobSystem, BindlessTable* pBindlessTable, Queue* pGraphicsQueue,
+		const std::string& savePath) :
+		pDevice(pDevice), pStagingRing(pStagingRing), pJobSystem(pJobSystem), pBindlessTable(pBindlessTable), pGraphicsQueue(pGraphicsQueue),
+		savePath(savePath) {
+		initialize();
+	}
+
+	void World::initialize() {
+		pMeshArena = new MeshArena(pDevice, ARENA_VERTEX_CAPACITY, ARENA_INDEX_CAPACITY);
+
+		//4KB written once, mapped memory is simpler than a staging copy
+		//ids without a block of their own stay magenta so they stand out
+		const uint32_t materialCount = 256;
+		static_assert(sizeof(BlockId) == 1, "one material per possible block id");
+		pMaterialBuffer = new Buffer(pDevice, materialCount * sizeof(Material), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		Material* pMaterials = static_cast<Material*>(pMaterialBuffer->getMapped());
+		for (uint32_t i = 0; i < materialCount; i++) {
+			pMaterials[i].color = glm::vec4(1.0f, 0.0f, 1.0f, 1.0f);
+		}
+		pMaterials[BLOCK_GRASS].color = glm::vec4(0.35f, 0.65f, 0.25f, 1.0f);
+		pMaterials[BLOCK_DIRT].color = glm::vec4(0.5f, 0.35f, 0.2f, 1.0f);
+		pMaterials[BLOCK_STONE].color = glm::vec4(0.5f, 0.5f, 0.5f, 1.0f);
+		materialBuffer = pBindlessTable->addBuffer(pMaterialBuffer->getBuffer(), 0, pMaterialBuffer->getSize());
+
+		if (!savePath.empty()) {
+			pRegionStorage = new RegionStorage(savePath);
+		}
+
+		std::cerr << "world has initiated \n";
+	}
+
+	void World::generate(int32_t radius) {
+		//every chunk is created before a job is submitted, so meshing can depend on the generation of the neighbours
+		std::vector<ChunkCoordinate> newChunks;
+		std::unordered_map<ChunkCoordinate, JobSystem::Job*, ChunkCoordinateHash> pGenerateJobs;
+		for (int32_t z = -radius; z < radius; z++) {
+			for (int32_t y = 0; y < HEIGHT_IN_CHUNKS; y++) {
+				for (int32_t x = -radius; x < radius; x++) {
+					ChunkCoordinate coordinate{ x, y, z };
+					if (getChunk(coordinate) != nullptr) {
+						continue;
+					}
+					pGenerateJobs[coordinate] = createChunk(coordinate);
+					newChunks.push_back(coordinate);
+				}
+			}
+		}
+
+		//a chunk is meshed once it and its neighbours are generated so borders between chunks are culled too
+		//chunks on the edge of the square are meshed without the neighbours that were not loaded
+		for (const ChunkCoordinate& coordinate : newChunks) {
+			JobSystem::Job* pMeshJob = createMeshJob(chunks[coordinate], 0);
+			pJobSystem->addDependency(pMeshJob, pGenerateJobs[coordinate]);
+			for (const ChunkCoordinate& neighbourCoordinate : getNeighbourCoordinates(coordinate)) {
+				auto generateJob = pGenerateJobs.find(neighbourCoordinate);
+				if (generateJob != pGenerateJobs.end()) {
+					pJobSystem->addDependency(pMeshJob, generateJob->second);
+				}
+			}
+			pJobSystem->submit(pMeshJob);
+		}
+
+		//dependencies are all wired up, the generation jobs can start
+		for (auto& generateJob : pGenerateJobs) {
+			pJobSystem->submit(generateJob.second);
+		}
+	}
+
+	bool World::loadChunk(ChunkCoordinate coordinate) {
+		//the save job may not have written it yet, its region would give the old blocks
+		if (getChunk(coordinate) != nullptr || savingChunks.count(coordinate) > 0) {
+			return false;
+		}
+		pJobSystem->submit(createChunk(coordinate));
+		return true;
+	}
+
+	bool World::meshChunk(ChunkCoordinate coordinate, uint32_t level) {
+		auto chunk = chunks.find(coordinate);
+		if (chunk == chunks.end()) {
+			return false;
+		}
+		ChunkState state = chunk->second.state;
+		if (state != CHUNK_GENERATED && (state != CHUNK_MESHED || chunk->second.level == level)) {
+			return false;
+		}
+		//neighbours above and below the world never exist, every other one has to be generated first
+		for (const ChunkCoordinate& neighbourCoordinate : getNeighbourCoordinates(coordinate)) {
+			if (neighbourCoordinate.y < 0 || neighbourCoordinate.y >= HEIGHT_IN_CHUNKS) {
+				continue;
+			}
+			auto neighbour = chunks.find(neighbourCoordinate);
+			if (neighbour == chunks.end() || neighbour->second.state == CHUNK_GENERATING) {
+				return false;
+			}
+		}
+		pJobSystem->submit(createMeshJob(chunk->second, level));
+		return true;
+	}
+
+	bool World::unloadChunk(ChunkCoordinate coordinate) {
+		auto chunk = chunks.find(coordinate);
+		if (chunk == chunks.end()) {
+			return false;
+		}
+		ChunkEntry& entry = chunk->second;
+		//a worker still writes or reads the blocks
+		if (entry.state == CHUNK_GENERATING || entry.state == CHUNK_MESHING || entry.readers > 0) {
+			return false;
+		}
+
+		if (entry.pMesh != nullptr) {
+			retireMesh(entry);
+		}
+
+		loadedBytes -= entry.blockBytes;
+		if (pRegionStorage != nullptr && !entry.stored) {
+			//encoding takes a while, the blocks are freed by the job once they are written
+			Chunk* pChunk = entry.pChunk;
+			savingChunks.insert(coordinate);
+			JobSystem::Job* pSaveJob = pJobSystem->create([this, pChunk, coordinate]() {
+				pRegionStorage->write(pChunk);
+				pChunk->destroy();
+				delete pChunk;
+				savedChunks.push(coordinate);
+			});
+			pJobs.push_back(pSaveJob);
+			pJobSystem->submit(pSaveJob);
+		}
+		else {
+			entry.pChunk->destroy();
+			delete entry.pChunk;
+		}
+		chunks.erase(chunk);
+		return true;
+	}
+
+	void World::retireMesh(ChunkEntry& entry) {
+		//order does not matter here, sortMeshes runs again for the new version
+		auto mesh = std::find(pMeshes.begin(), pMeshes.end(), entry.pMesh);
+		*mesh = pMeshes.back();
+		pMeshes.pop_back();
+		meshVersion++;
+		loadedBytes -= getMeshBytes(entry.pMesh);
+		triangleCount -= entry.pMesh->getIndexCount() / 3;
+		//every frame submitted so far may still draw it
+		retiredMeshes.push_back({ entry.pMesh, pGraphicsQueue->getSubmittedValue() });
+		entry.pMesh = nullptr;
+	}
+
+	std::array<ChunkCoordinate, 6> World::getNeighbourCoordinates(ChunkCoordinate coordinate) {
+		return { {
+			{ coordinate.x - 1, coordinate.y, coordinate.z },
+			{ coordinate.x + 1, coordinate.y, coordinate.z },
+			{ coordinate.x, coordinate.y - 1, coordinate.z },
+			{ coordinate.x, coordinate.y + 1, coordinate.z },
+			{ coordinate.x, coordinate.y, coordinate.z - 1 },
+			{ coordinate.x, coordinate.y, coordinate.z + 1 }
+		} };
+	}
+
+	JobSystem::Job* World::createChunk(ChunkCoordinate coordinate) {
+		Chunk* pChunk = new Chunk(coordinate);
+		ChunkEntry& entry = chunks[coordinate];
+		entry.pChunk = pChunk;
+		entry.state = CHUNK_GENERATING;
+		//a worker packs the blocks, update counts them again once it is done
+		entry.blockBytes = pChunk->getByteSize();
+		loadedBytes += entry.blockBytes;
+
+		JobSystem::Job* pGenerateJob = pJobSystem->create([this, pChunk]() {
+			//a saved chunk is a lookup in the mapped region and a decode, the generator only runs for new ones
+			bool stored = pRegionStorage != nullptr && pRegionStorage->read(pChunk);
+			if (!stored) {
+				pChunk->generateTerrain();
+			}
+			generatedChunks.push({ pChunk, stored });
+		});
+		//the handle is kept until the job has finished(see releaseFinishedJobs)
+		pJobs.push_back(pGenerateJob);
+		return pGenerateJob;
+	}
+
+	JobSystem::Job* World::createMeshJob(ChunkEntry& entry, uint32_t level) {
+		std::array<ChunkCoordinate, 6> neighbourCoordinates = getNeighbourCoordinates(entry.pChunk->getCoordinate());
+		std::array<const Chunk*, 6> neighbours;
+		for (size_t i = 0; i < neighbours.size(); i++) {
+			auto neighbour = chunks.find(neighbourCoordinates[i]);
+			neighbours[i] = neighbour != chunks.end() ? neighbour->second.pChunk : nullptr;
+			if (neighbours[i] != nullptr) {
+				neighbour->second.readers++;
+			}
+		}
+		entry.state = CHUNK_MESHING;
+		entry.level = level;
+
+		const Chunk* pChunk = entry.pChunk;
+		JobSystem::Job* pMeshJob = pJobSystem->create([this, pChunk, neighbours, level]() {
+			buildMesh(pChunk, neighbours, level);
+		});
+		pJobs.push_back(pMeshJob);
+		meshJobsInFlight++;
+		return pMeshJob;
+	}
+
+	Chunk* World::getChunk(ChunkCoordinate coordinate) const {
+		auto chunk = chunks.find(coordinate);
+		return chunk != chunks.end() ? chunk->second.pChunk : nullptr;
+	}
+
+	ChunkState World::getChunkState(ChunkCoordinate coordinate) const {
+		auto chunk = chunks.find(coordinate);
+		assert(chunk != chunks.end());
+		return chunk->second.state;
+	}
+
+	uint32_t World::getChunkLevel(ChunkCoordinate coordinate) const {
+		auto chunk = chunks.find(coordinate);
+		assert(chunk != chunks.end());
+		return chunk->second.level;
+	}
+
+	void World::buildMesh(const Chunk* pChunk, const std::array<const Chunk*, 6>& neighbours, uint32_t level) {
+		//the mesher keeps scratch memory, one per worker avoids sharing it
+		static thread_local ChunkMesher mesher;
+
+		MeshResult* pResult = new MeshResult();
+		pResult->pChunk = pChunk;
+		pResult->neighbours = neighbours;
+		if (!pChunk->isEmpty()) {
+			pResult->statistics = mesher.mesh(*pChunk, neighbours, level, pResult->vertices, pResult->indices);
+		}
+		//empty results are queued too so the render thread can count finished jobs
+		completedMeshes.push(pResult);
+	}
+
+	void World::releaseFinishedJobs() {
+		size_t kept = 0;
+		for (JobSystem::Job* pJob : pJobs) {
+			if (pJobSystem->isFinished(pJob)) {
+				pJobSystem->release(pJob);
+			}
+			else {
+				pJobs[kept++] = pJob;
+			}
+		}
+		pJobs.resize(kept);
+	}
+
+	uint32_t World::update(uint32_t maxMeshes) {
+		//arena ranges of unloaded meshes, in the order they were retired
+		uint64_t completedValue = pGraphicsQueue->getCompletedValue();
+		while (!retiredMeshes.empty() && retiredMeshes.front().value <= completedValue) {
+			retiredMeshes.front().pMesh->destroy();
+			delete retiredMeshes.front().pMesh;
+			retiredMeshes.pop_front();
+		}
+
+		//a chunk meshed by generate is already past this
+		GeneratedChunk generatedChunk;
+		while (generatedChunks.pop(generatedChunk)) {
+			ChunkEntry& entry = chunks[generatedChunk.pChunk->getCoordinate()];
+			entry.stored = generatedChunk.stored;
+			loadedBytes = loadedBytes - entry.blockBytes + generatedChunk.pChunk->getByteSize();
+			entry.blockBytes = generatedChunk.pChunk->getByteSize();
+			if (entry.state == CHUNK_GENERATING) {
+				entry.state = CHUNK_GENERATED;
+			}
+		}
+
+		ChunkCoordinate savedChunk;
+		while (savedChunks.pop(savedChunk)) {
+			savingChunks.erase(savedChunk);
+		}
+		//one flush at a time, the regions are locked while it appends
+		if (pRegionStorage != nullptr && !flushing.load(std::memory_order_acquire) && pRegionStorage->getPendingBytes() >= FLUSH_BYTES) {
+			flushing.store(true, std::memory_order_relaxed);
+			JobSystem::Job* pFlushJob = pJobSystem->create([this]() {
+				pRegionStorage->flush();
+				flushing.store(false, std::memory_order_release);
+			});
+			pJobs.push_back(pFlushJob);
+			pJobSystem->submit(pFlushJob);
+		}
+
+		uint32_t uploaded = 0;
+		MeshResult* pResult = nullptr;
+		while (uploaded < maxMeshes && completedMeshes.pop(pResult)) {
+			meshJobsInFlight--;
+			statistics.visibleFaces += pResult->statistics.visibleFaces;
+			statistics.quads += pResult->statistics.quads;
+			//neither the chunk nor the neighbours it read can have been unloaded meanwhile
+			for (const Chunk* pNeighbour : pResult->neighbours) {
+				if (pNeighbour != nullptr) {
+					chunks[pNeighbour->getCoordinate()].readers--;
+				}
+			}
+			ChunkEntry& entry = chunks[pResult->pChunk->getCoordinate()];
+			entry.state = CHUNK_MESHED;
+			//the mesh of the chunk's previous level was drawn until now
+			if (entry.pMesh != nullptr) {
+				retireMesh(entry);
+				if (pResult->indices.empty()) {
+					uploaded++;
+				}
+			}
+			if (!pResult->indices.empty()) {
+				entry.pMesh = new ChunkMesh(pMeshArena, pStagingRing, pResult->vertices, pResult->indices, pResult->pChunk->getOrigin());
+				pMeshes.push_back(entry.pMesh);
+				loadedBytes += getMeshBytes(entry.pMesh);
+				triangleCount += entry.pMesh->getIndexCount() / 3;
+				uploaded++;
+			}
+			delete pResult;
+
+			if (meshJobsInFlight == 0) {
+				std::cerr << "world: " << chunks.size() << " chunks, " << pMeshes.size() << " meshes, " << triangleCount << " triangles drawn, "
+					<< statistics.quads * 2 << " triangles meshed(" << statistics.visibleFaces * 2 << " without greedy merging) \n";
+			}
+		}
+		releaseFinishedJobs();
+		if (uploaded > 0) {
+			meshVersion++;
+		}
+		return uploaded;
+	}
+
+	void World::sortMeshes(glm::vec3 viewPosition) {
+		glm::ivec3 chunk = glm::ivec3(glm::floor(viewPosition / static_cast<float>(Chunk::SIZE)));
+		ChunkCoordinate viewChunk{ chunk.x, chunk.y, chunk.z };
+		if (sortedVersion == meshVersion && sortedFrom == viewChunk) {
+			return;
+		}
+
+		//chunk centers, the order only has to be right between chunks(the faces inside one are drawn as they were meshed)
+		glm::vec3 halfSize = glm::vec3(static_cast<float>(Chunk::SIZE) * 0.5f);
+		std::sort(pMeshes.begin(), pMeshes.end(), [viewPosition, halfSize](const ChunkMesh* pA, const ChunkMesh* pB) {
+			glm::vec3 a = glm::vec3(pA->getOrigin()) + halfSize - viewPosition;
+			glm::vec3 b = glm::vec3(pB->getOrigin()) + halfSize - viewPosition;
+			return glm::dot(a, a) < glm::dot(b, b);
+		});
+
+		//the culler writes its bounds again in the new order
+		meshVersion++;
+		sortedVersion = meshVersion;
+		sortedFrom = viewChunk;
+	}
+
+	void World::finishLoading() {
+		//a finished job has already pushed its result
+		for (JobSystem::Job* pJob : pJobs) {
+			pJobSystem->wait(pJob);
+		}
+		update(UINT32_MAX);
+	}
+
+	void World::destroy() {
+		//workers may still write into chunks or the queues
+		for (JobSystem::Job* pJob : pJobs) {
+			pJobSystem->wait(pJob);
+			pJobSystem->release(pJob);
+		}
+		pJobs.clear();
+		MeshResult* pResult = nullptr;
+		while (completedMeshes.pop(pResult)) {
+			delete pResult;
+		}
+		GeneratedChunk generatedChunk;
+		while (generatedChunks.pop(generatedChunk)) {
+		}
+		ChunkCoordinate savedChunk;
+		while (savedChunks.pop(savedChunk)) {
+		}
+		savingChunks.clear();
+		meshJobsInFlight = 0;
+
+		//every job is done, what is still loaded is saved right here
+		if (pRegionStorage != nullptr) {
+			uint32_t savedCount = 0;
+			for (auto& chunk : chunks) {
+				if (!chunk.second.stored) {
+					pRegionStorage->write(chunk.second.pChunk);
+					savedCount++;
+				}
+			}
+			//flushes the regions
+			pRegionStorage->destroy();
+			delete pRegionStorage;
+			pRegionStorage = nullptr;
+			std::cerr << "world: saved " << savedCount << " chunks to " << savePath << "\n";
+		}
+
+		//the device is idle, retired meshes are not drawn anymore either
+		for (auto& retiredMesh : retiredMeshes) {
+			retiredMesh.pMesh->destroy();
+			delete retiredMesh.pMesh;
+		}
+		retiredMeshes.clear();
+		for (auto pMesh : pMeshes) {
+			pMesh->destroy();
+			delete pMesh;
+		}
+		pMeshes.clear();
+		triangleCount = 0;
+		for (auto& chunk : chunks) {
+			chunk.second.pChunk->destroy();
+			delete chunk.second.pChunk;
+		}
+		chunks.clear();
+		loadedBytes = 0;
+
+		if (pMeshArena != nullptr) {
+			pMeshArena->destroy();
+			delete pMeshArena;
+			pMeshArena = nullptr;
+		}
+		if (pMaterialBuffer != nullptr) {
+			pBindlessTable->removeBuffer(materialBuffer);
+			pMaterialBuffer->destroy();
+			delete pMaterialBuffer;
+			pMaterialBuffer = nullptr;
+		}
+	}
+
+	World::~World() {
+		destroy();
+	}
+}
@@ -0,0 +1,232 @@
+#pragma once
+#include "UtilHeader.h"
+#include <unordered_map>
+#include <deque>
+#include <atomic>
+#include <unordered_set>
+#include "JobSystem.h"
+#include "LockFreeQueue.h"
+#include "Chunk.h"
+#include "ChunkMesher.h"
+#include "ChunkMesh.h"
+#include "BindlessTable.h"
+#include "Buffer.h"
+#include "RegionStorage.h"
+
+namespace one {
+	//how a block looks, one per block id in the material buffer(std430, shader.vert reads it)
+	struct Material {
+		glm::vec4 color;
+	};
+
+	//where a loaded chunk is on its way to being drawn
+	enum ChunkState : uint8_t {
+		CHUNK_GENERATING = 0,
+		CHUNK_GENERATED = 1,
+		CHUNK_MESHING = 2,
+		//has its mesh(or nothing to mesh)
+		CHUNK_MESHED = 3
+	};
+
+	//owns the chunks of the world and their meshes
+	//chunks are loaded and unloaded one by one(see ChunkStreamer), or a whole square at once with generate
+	//with a save path chunks are read from its region files before they are generated, and saved there when they are unloaded
+	class World : NonCopyable
+	{
+	public:
+
+		//chunks stacked on every column, the terrain height stays below this
+		static const int32_t HEIGHT_IN_CHUNKS = 2;
+
+		//pGraphicsQueue draws the meshes, an unloaded mesh's arena ranges are freed once its frames are done
+		//savePath: directory of the region files, empty to always generate and never save
+		World(Device* pDevice, StagingRing* pStagingRing, JobSystem* pJobSystem, BindlessTable* pBindlessTable, Queue* pGraphicsQueue,
+			const std::string& savePath);
+		~World();
+
+		void initialize();
+		void destroy();
+
+		//queues generation and meshing jobs for a square of (2 * radius)^2 chunk columns around the origin
+		//returns right away, finished meshes are picked up by update
+		void generate(int32_t radius);
+
+		//queues the loading(or generation) of one chunk, false if it is already loaded or still being saved
+		bool loadChunk(ChunkCoordinate coordinate);
+		//queues the meshing of a generated chunk at level(see ChunkMesher) once every neighbour that can exist is generated too
+		//a meshed chunk is meshed again when level is not the one it has, its old mesh is drawn until the new one replaces it
+		//false if it was not queued(not generated yet, being meshed, already at that level or a neighbour is missing)
+		bool meshChunk(ChunkCoordinate coordinate, uint32_t level);
+		//removes the chunk and its mesh, false while a job still works on it or reads it as a neighbour
+		//the mesh is no longer drawn, its arena ranges are freed once the frames already submitted are done
+		//a chunk that is not saved yet is handed to a job that writes it to its region
+		bool unloadChunk(ChunkCoordinate coordinate);
+
+		//uploads up to maxMeshes finished meshes through the staging ring and returns how many it took
+		//a mesh of another level replaces the chunk's old one, dropping the old one counts too when the new level has nothing to draw
+		//also picks up finished generations and saves, flushes the regions once enough was saved and frees the arena ranges of unloaded meshes the gpu is done with
+		//call on the render thread, the ring has to be flushed before the new meshes are drawn
+		uint32_t update(uint32_t maxMeshes);
+
+		//blocks until every queued chunk is meshed and uploaded(helps the workers meanwhile)
+		void finishLoading();
+
+		inline bool isLoading(void) const {
+			return meshJobsInFlight > 0;
+		}
+
+		//nullptr if the chunk is not loaded
+		Chunk* getChunk(ChunkCoordinate coordinate) const;
+
+		//only valid for a loaded chunk(getChunk is not nullptr)
+		ChunkState getChunkState(ChunkCoordinate coordinate) const;
+		//level of the chunk's mesh, or of the one being built while it is meshing, only valid for a loaded chunk
+		uint32_t getChunkLevel(ChunkCoordinate coordinate) const;
+
+		inline size_t getChunkCount(void) const {
+			return chunks.size();
+		}
+
+		//blocks of every loaded chunk plus the vertices and indices of their meshes
+		inline uint64_t getLoadedBytes(void) const {
+			return loadedBytes;
+		}
+
+		inline const std::vector<ChunkMesh*>& getMeshes(void) const {
+			return pMeshes;
+		}
+
+		//of every mesh in getMeshes
+		inline uint64_t getTriangleCount(void) const {
+			return triangleCount;
+		}
+
+		//every mesh's vertices and indices, bound once to draw all of them
+		inline const MeshArena* getMeshArena(void) const {
+			return pMeshArena;
+		}
+
+		//orders the meshes front to back from viewPosition so early depth testing rejects what is behind the first ones drawn
+		//only sorts again after the viewer moved into another chunk or meshes were added, the mesh version changes when it does
+		void sortMeshes(glm::vec3 viewPosition);
+
+		//index of the material buffer in the bindless table, every block id has an entry
+		inline uint32_t getMaterialBuffer(void) const {
+			return materialBuffer;
+		}
+
+		//changes every time update adds meshes, unloadChunk removes one or sortMeshes reorders them
+		inline uint64_t getMeshVersion(void) const {
+			return meshVersion;
+		}
+
+	private:
+
+		//a loaded chunk
+		struct ChunkEntry {
+			Chunk* pChunk = nullptr;
+			ChunkState state = CHUNK_GENERATING;
+			//meshing jobs reading it as a neighbour, it stays loaded until they reported back
+			uint32_t readers = 0;
+			//nullptr until meshed, and for chunks with nothing to draw
+			ChunkMesh* pMesh = nullptr;
+			//level of pMesh, or of the mesh being built
+			uint32_t level = 0;
+			//the region has the same blocks, unloading does not have to save it
+			bool stored = false;
+			//what the blocks took when they were counted in loadedBytes, they shrink once generated
+			uint64_t blockBytes = 0;
+		};
+
+		//a chunk whose generation job is done
+		struct GeneratedChunk {
+			Chunk* pChunk;
+			//read from its region instead of generated
+			bool stored;
+		};
+
+		//mesh of an unloaded chunk, its ranges can be reused once the graphics queue reached value
+		struct RetiredMesh {
+			ChunkMesh* pMesh;
+			uint64_t value;
+		};
+
+		//cpu side mesh built by a worker, handed to the render thread through the completion queue
+		struct MeshResult {
+			const Chunk* pChunk;
+			//the neighbours it read, they get their reader back
+			std::array<const Chunk*, 6> neighbours;
+			std::vector<Vertex> vertices;
+			std::vector<uint32_t> indices;
+			ChunkMesher::Statistics statistics;
+		};
+
+		//runs on a worker, neighbours are only read(their generation jobs are dependencies)
+		void buildMesh(const Chunk* pChunk, const std::array<const Chunk*, 6>& neighbours, uint32_t level);
+		//same order as Faces
+		static std::array<ChunkCoordinate, 6> getNeighbourCoordinates(ChunkCoordinate coordinate);
+		//creates the entry and the generation job(not submitted)
+		JobSystem::Job* createChunk(ChunkCoordinate coordinate);
+		//creates the meshing job of a chunk at level(not submitted) and marks its neighbours as read
+		JobSystem::Job* createMeshJob(ChunkEntry& entry, uint32_t level);
+		//stops drawing the chunk's mesh, its arena ranges are freed once the frames already submitted are done
+		void retireMesh(ChunkEntry& entry);
+		//handles of finished jobs are released
+		void releaseFinishedJobs();
+
+		static inline uint64_t getMeshBytes(const ChunkMesh* pMesh) {
+			return static_cast<uint64_t>(pMesh->getVertexCount()) * sizeof(Vertex) + static_cast<uint64_t>(pMesh->getIndexCount()) * sizeof(uint32_t);
+		}
+
+		Device* pDevice;
+
+		StagingRing* pStagingRing;
+
+		JobSystem* pJobSystem;
+
+		BindlessTable* pBindlessTable;
+
+		Queue* pGraphicsQueue;
+
+		std::string savePath;
+		//nullptr without a save path
+		RegionStorage* pRegionStorage{ nullptr };
+		//unloaded, but their save job has not reported back, they can't be loaded again until it did
+		std::unordered_set<ChunkCoordinate, ChunkCoordinateHash> savingChunks;
+		//a flush job is queued or running
+		std::atomic<bool> flushing{ false };
+
+		Buffer* pMaterialBuffer{ nullptr };
+		uint32_t materialBuffer = 0;
+
+		LockFreeQueue<MeshResult*> completedMeshes;
+		LockFreeQueue<GeneratedChunk> generatedChunks;
+		//unloaded chunks written to their region by a save job
+		LockFreeQueue<ChunkCoordinate> savedChunks;
+
+		//handles of the queued generation and meshing jobs, released once they are finished
+		std::vector<JobSystem::Job*> pJobs;
+
+		//only touched by the render thread
+		uint32_t meshJobsInFlight = 0;
+
+		ChunkMesher::Statistics statistics;
+
+		std::unordered_map<ChunkCoordinate, ChunkEntry, ChunkCoordinateHash> chunks;
+		uint64_t loadedBytes = 0;
+
+		MeshArena* pMeshArena{ nullptr };
+
+		std::vector<ChunkMesh*> pMeshes;
+		uint64_t meshVersion = 1;
+		uint64_t triangleCount = 0;
+
+		//oldest first
+		std::deque<RetiredMesh> retiredMeshes;
+
+		//chunk the viewer was in and the mesh version after the last sort
+		ChunkCoordinate sortedFrom{ 0, 0, 0 };
+		uint64_t sortedVersion = 0;
+
+	};
+}
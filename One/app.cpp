@@ -6,111 +6,479 @@
 //Ctrl + M, then O to collapse all functions
 
 namespace one {
-
-	App::App(Window* pWindow): pWindow(pWindow) {
+	//host visible memory used for uploads, bigger uploads are split and wait on earlier ones
+	static const VkDeviceSize STAGING_RING_SIZE = 8ull * 1024 * 1024;
+	//uniform ring space of one frame, the frame uniforms are the first allocation of it
+	static const VkDeviceSize UNIFORM_REGION_SIZE = 64ull * 1024;
+	//horizontal distance of the camera from the point it looks at
+	static const int32_t CAMERA_DISTANCE = 4 * Chunk::SIZE;
+	//finished chunk meshes uploaded per frame, keeps streaming from stalling a frame
+	static const uint32_t MESH_UPLOADS_PER_FRAME = 16;
+	//region files of the streamed world, next to the pipeline cache
+	static const char* SAVE_DIRECTORY = "world";
+	//the far field is 2^11 = 2048 blocks wide
+	static const uint32_t FAR_FIELD_LEVELS = 11;
+
+	App::App(Window* pWindow, uint32_t framesInFlight, bool parallelRecording, bool cachedCommands, const ChunkStreamer::Settings& streamingSettings):
+		framesInFlight(framesInFlight), parallelRecording(parallelRecording), cachedCommands(cachedCommands), streamingSettings(streamingSettings),
+		pWindow(pWindow) {
+		assert(framesInFlight > 0);
 		initialize();
 	}
 
 	void App::initialize() {
-		pInstance = new Instance();
+		//one worker per core besides this thread
+		pJobSystem = new JobSystem(0);
+
+		pInstance = new Instance(false);
 
 		pSwapChain = new SwapChain(pWindow, pInstance->getInstance());
 
 		pGraphicsQueue = new Queue(-1, 1.0f);
 		pPresentationQueue = new Queue(-1, 1.0f);
+		pTransferQueue = new Queue(-1, 1.0f);
+		pComputeQueue = new Queue(-1, 1.0f);
 
-		pDevice = new Device(pInstance->getInstance(), pInstance->getValidationLayers(), pSwapChain, pGraphicsQueue, pPresentationQueue);
+		pDevice = new Device(pInstance->getInstance(), pInstance->getValidationLayers(), pSwapChain, pGraphicsQueue, pPresentationQueue, pTransferQueue,
+							pComputeQueue, pInstance->hasPhysicalDeviceProperties2());
 		_device = pDevice->getDevice();
 
-		assert(pGraphicsQueue->initialize(_device));
-		assert(pPresentationQueue->initialize(_device));
+		//frames and uploads are tracked by queue values, timeline semaphores when the device has them
+		pGraphicsQueue->initialize(_device, pDevice->hasTimelineSemaphores());
+		//only presents, never submits
+		pPresentationQueue->initialize(_device, false);
+		pTransferQueue->initialize(_device, pDevice->hasTimelineSemaphores());
+		pComputeQueue->initialize(_device, pDevice->hasTimelineSemaphores());
+
+		pStagingRing = new StagingRing(pDevice, pTransferQueue, pGraphicsQueue, STAGING_RING_SIZE);
 
 		pSwapChain->initialize(_device, pDevice->getPhysicalGraphicsDevice());
 		
-		pRenderPass = new RenderPass(_device, pSwapChain->getImageFormat());
+		depthFormat = RenderGraph::chooseDepthFormat(pDevice->getPhysicalGraphicsDevice());
+		//depth is stored, the Hi-Z build samples it after the scene
+		pRenderPass = new RenderPass(_device, pSwapChain->getImageFormat(), depthFormat, VK_ATTACHMENT_STORE_OP_STORE);
+
+		pPipelineCache = new PipelineCache(_device, pDevice->getPhysicalGraphicsDevice(), "pipeline.cache");
 
-		pPipeline = new Pipeline(_device, pRenderPass->getRenderPass());
+		pBindlessTable = new BindlessTable(pDevice);
+		pUniformRing = new UniformRing(pDevice, pGraphicsQueue, pSwapChain->getSwapChainImagesSize(), UNIFORM_REGION_SIZE);
+		pPipeline = new Pipeline(_device, pRenderPass->getRenderPass(), pBindlessTable->getDescriptorSetLayout(),
+			pUniformRing->getDescriptorSetLayout(), pPipelineCache);
+
+		//one set per level of every pyramid, retired pyramids keep theirs until they are released
+		pHiZPipeline = new ComputePipeline(_device, "hiz.comp.spv", { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE },
+			sizeof(HiZPyramid::BuildConstants), 2 * ChunkCuller::MAX_TARGETS * HiZPyramid::MAX_LEVELS, pPipelineCache);
 
 		initializeFrameBuffers();
 
-		initializeCommandBuffer();
+		initializeWorld();
+
+		//draws straight out of the world's mesh arena
+		pChunkCuller = new ChunkCuller(pDevice, pComputeQueue, pGraphicsQueue, pPipelineCache, pWorld->getMeshArena(), pSwapChain->getSwapChainImagesSize());
+		for (uint32_t i = 0; i < pHiZPyramids.size(); i++) {
+			pChunkCuller->setHiZPyramid(i, pHiZPyramids[i]);
+		}
+
+		initializeCommandBuffers();
 
 		//recordCommandBuffer();
 		
 		initializeSyncObjects();
 
+		startTime = std::chrono::high_resolution_clock::now();
+
 		std::cerr << "app has initiated \n";
 	}
 
 
 	void App::initializeFrameBuffers() {
-		int swapChainImageSize = pSwapChain->getSwapChainImagesSize();
+		uint32_t swapChainImageSize = static_cast<uint32_t>(pSwapChain->getSwapChainImagesSize());
+		VkExtent2D extent = pSwapChain->getExtent();
 		pSwapChainFramebuffers.resize(swapChainImageSize);
-
-		for (size_t i = 0; i < swapChainImageSize; i++) {
+		pRenderGraphs.resize(swapChainImageSize);
+		pHiZPyramids.resize(swapChainImageSize);
+
+		for (uint32_t i = 0; i < swapChainImageSize; i++) {
+			HiZPyramid* pHiZPyramid = new HiZPyramid(pDevice, pComputeQueue, pGraphicsQueue, pHiZPipeline, extent);
+			pHiZPyramids[i] = pHiZPyramid;
+
+			RenderGraph* pRenderGraph = new RenderGraph(pDevice);
+			pRenderGraphs[i] = pRenderGraph;
+			//the acquired contents are thrown away, the acquire semaphore is waited on at color output
+			uint32_t color = pRenderGraph->importImage(pSwapChain->getImage(i), VK_IMAGE_ASPECT_COLOR_BIT, 1,
+				{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED },
+				{ VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR });
+			//each image has its own depth, frames in flight draw to different images at once
+			uint32_t depth = pRenderGraph->createImage({ depthFormat, extent, VK_IMAGE_ASPECT_DEPTH_BIT });
+			//last read by a culling on the compute queue, the submit waits on it at the indirect stage
+			uint32_t hiZ = pRenderGraph->importImage(pHiZPyramid->getImage(), VK_IMAGE_ASPECT_COLOR_BIT, pHiZPyramid->getLevelCount(),
+				{ VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL },
+				{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL });
+
+			uint32_t scene = pRenderGraph->addPass("scene", [this, i](VkCommandBuffer commandBuffer) {
+				recordScene(commandBuffer, i);
+			});
+			pRenderGraph->write(scene, color, RenderGraph::USAGE_COLOR_ATTACHMENT);
+			pRenderGraph->write(scene, depth, RenderGraph::USAGE_DEPTH_ATTACHMENT);
+
+			uint32_t hiZBuild = pRenderGraph->addPass("hi-z build", [pHiZPyramid](VkCommandBuffer commandBuffer) {
+				pHiZPyramid->recordBuild(commandBuffer);
+			});
+			pRenderGraph->read(hiZBuild, depth, RenderGraph::USAGE_SAMPLED_COMPUTE);
+			pRenderGraph->write(hiZBuild, hiZ, RenderGraph::USAGE_STORAGE_COMPUTE);
+
+			pRenderGraph->compile();
+			//read after the scene, so the render pass has to store it
+			assert(!pRenderGraph->isTransientAttachment(depth));
+
+			pHiZPyramid->setDepthView(pRenderGraph->getImageView(depth));
 			VkImageView attachments[] = {
-				pSwapChain->getImageViews(i)
+				pSwapChain->getImageViews(i),
+				pRenderGraph->getImageView(depth)
 			};
 			//allocating to heap
-			pSwapChainFramebuffers[i] = new Framebuffer(_device, attachments, pRenderPass->getRenderPass(), pSwapChain->getExtent());
+			pSwapChainFramebuffers[i] = new Framebuffer(_device, attachments, 2, pRenderPass->getRenderPass(), extent);
+		}
+	}
+
+	void App::recordScene(VkCommandBuffer commandBuffer, uint32_t target) {
+		if (pSceneSecondaryCommandBuffers != nullptr) {
+			CommandBuffer::recordScene(commandBuffer, pSwapChainFramebuffers[target]->getFrameBuffer(), pRenderPass->getRenderPass(),
+										pSwapChain->getExtent(), *pSceneSecondaryCommandBuffers);
+		}
+		else {
+			CommandBuffer::recordScene(commandBuffer, pSwapChainFramebuffers[target]->getFrameBuffer(), pRenderPass->getRenderPass(),
+										pPipeline->getDepthPrepassPipeline(), pPipeline->getPipeline(), pPipeline->getFarFieldPipeline(), pPipeline->getPipelineLayout(),
+										pBindlessTable, pUniformRing, frameUniforms.region, frameUniforms.offset, pSwapChain->getExtent(), getPushConstants(),
+										pChunkCuller, target);
 		}
 	}
 
-	void App::initializeCommandBuffer() {
-		pCommandBuffer = new CommandBuffer(_device, pGraphicsQueue->getCommandPool());
+	PushConstants App::getPushConstants(void) const {
+		return { pWorld->getMaterialBuffer(), pFarField->isReady() ? pFarField->getBuffer() : NO_FAR_FIELD };
+	}
+
+	void App::recreateSwapChain() {
+		//minimized windows have a 0 sized framebuffer, a swapchain can't be made until it comes back
+		int width = 0, height = 0;
+		pWindow->getFramebufferSize(width, height);
+		while (width == 0 || height == 0) {
+			glfwWaitEvents();
+			pWindow->getFramebufferSize(width, height);
+		}
+		pWindow->resetResized();
+
+		//no vkDeviceWaitIdle here, frames in flight keep using the old swapchain/framebuffers
+		//they are retired and only destroyed once every slot has been waited on again
+		pSwapChain->recreate(_device, pDevice->getPhysicalGraphicsDevice());
+		pRetiredFramebuffers.insert(pRetiredFramebuffers.end(), pSwapChainFramebuffers.begin(), pSwapChainFramebuffers.end());
+		pRetiredRenderGraphs.insert(pRetiredRenderGraphs.end(), pRenderGraphs.begin(), pRenderGraphs.end());
+		pRetiredHiZPyramids.insert(pRetiredHiZPyramids.end(), pHiZPyramids.begin(), pHiZPyramids.end());
+		pSwapChainFramebuffers.clear();
+		pRenderGraphs.clear();
+		pHiZPyramids.clear();
+		retiredOnFrame = frameNumber;
+
+		//surface format stays the same for the surface so render pass and pipeline can be kept
+		//(viewport and scissor are dynamic so the new extent does not need a new pipeline)
+		initializeFrameBuffers();
+
+		//new images are not being used by any frame yet
+		imageSubmitValues.assign(pSwapChain->getSwapChainImagesSize(), 0);
+		//regions are only added like the targets, a cached buffer keeps binding the region of its image
+		pUniformRing->resize(pSwapChain->getSwapChainImagesSize());
+		//targets are only added, the ones kept were last culled for frames that have been waited on
+		pChunkCuller->resize(pSwapChain->getSwapChainImagesSize());
+		//the old pyramids are still bound until each target is culled again, they are retired not destroyed
+		for (uint32_t i = 0; i < pHiZPyramids.size(); i++) {
+			pChunkCuller->setHiZPyramid(i, pHiZPyramids[i]);
+		}
+
+		//cached buffers point at the old framebuffers and extent
+		if (cachedCommands) {
+			initializeImageCommandBuffers();
+		}
+		markCommandsDirty();
+	}
+
+	void App::releaseRetiredSwapChain() {
+		for (auto framebuffer : pRetiredFramebuffers) {
+			framebuffer->destroy();
+			delete framebuffer;
+		}
+		pRetiredFramebuffers.clear();
+		for (auto pHiZPyramid : pRetiredHiZPyramids) {
+			pHiZPyramid->destroy();
+			delete pHiZPyramid;
+		}
+		pRetiredHiZPyramids.clear();
+		for (auto pRenderGraph : pRetiredRenderGraphs) {
+			pRenderGraph->destroy();
+			delete pRenderGraph;
+		}
+		pRetiredRenderGraphs.clear();
+
+		pSwapChain->destroyRetired(_device);
+	}
+
+	void App::initializeWorld() {
+		pWorld = new World(pDevice, pStagingRing, pJobSystem, pBindlessTable, pGraphicsQueue, SAVE_DIRECTORY);
+		//chunks are requested by the ticks, meshes arrive over the next frames as the workers finish them
+		pChunkStreamer = new ChunkStreamer(pWorld, streamingSettings);
+		//built from the same terrain on the workers a few tiles at a time, shows up once all of it is uploaded
+		pFarField = new FarField(pDevice, pStagingRing, pJobSystem, pBindlessTable, FAR_FIELD_LEVELS);
+
+		//looking at the origin from above
+		float distance = static_cast<float>(CAMERA_DISTANCE);
+		pCamera = new Camera(glm::vec3(-distance, 2.0f * distance, -distance), glm::vec3(0.0f, 24.0f, 0.0f), glm::radians(60.0f));
+	}
+
+	void App::initializeCommandBuffers() {
+		pCommandBuffers.resize(framesInFlight);
+		for (uint32_t i = 0; i < framesInFlight; i++) {
+			pCommandBuffers[i] = new CommandBuffer(_device, pGraphicsQueue->getCommandPool());
+		}
+		//cached buffers are recorded once and replayed, secondary buffers from the recorder only live for one frame
+		if (parallelRecording && !cachedCommands) {
+			pParallelRecorder = new ParallelRecorder(_device, pGraphicsQueue->getFamilyIndex(), pJobSystem, framesInFlight);
+		}
+		if (cachedCommands) {
+			pTimestampCommandBuffers.resize(framesInFlight);
+			for (uint32_t i = 0; i < framesInFlight; i++) {
+				pTimestampCommandBuffers[i] = new CommandBuffer(_device, pGraphicsQueue->getCommandPool());
+			}
+			initializeImageCommandBuffers();
+		}
+	}
+
+	void App::initializeImageCommandBuffers() {
+		//kept across swapchain recreations, only grows if the new swapchain has more images
+		size_t imageCount = pSwapChain->getSwapChainImagesSize();
+		while (pImageCommandBuffers.size() < imageCount) {
+			pImageCommandBuffers.push_back(new CommandBuffer(_device, pGraphicsQueue->getCommandPool()));
+			imageCommandValues.push_back(0);
+		}
+		imageRecordedVersions.assign(pImageCommandBuffers.size(), 0);
+	}
+
+	void App::markCommandsDirty() {
+		//every cached buffer is older than this now
+		sceneVersion++;
 	}
 
 	void App::initializeSyncObjects(){
-		pImageAvailableSemaphore = new Semaphore(_device);
-		pRenderFinishedSemaphore = new Semaphore(_device);
-		pInFlightFence = new Fence(_device);
+		//acquire and present only take binary semaphores, frame completion is a graphics queue value
+		pImageAvailableSemaphores.resize(framesInFlight);
+		pRenderFinishedSemaphores.resize(framesInFlight);
+		slotSubmitValues.assign(framesInFlight, 0);
+		for (uint32_t i = 0; i < framesInFlight; i++) {
+			pImageAvailableSemaphores[i] = new Semaphore(_device);
+			pRenderFinishedSemaphores[i] = new Semaphore(_device);
+		}
+		//no swapchain image is being used by a frame yet
+		imageSubmitValues.assign(pSwapChain->getSwapChainImagesSize(), 0);
 	}
 
 
+	void App::update() {
+		//unloaded chunks are no longer drawn, crossing a chunk border only queues a few jobs per tick
+		if (pChunkStreamer->update(pCamera->getPosition(), pCamera->getPixelSpread(pSwapChain->getExtent().height)) > 0) {
+			markCommandsDirty();
+		}
+
+		//meshes finished by the workers since last tick, flushed before the next frame's submit so it can draw them
+		if (pWorld->update(MESH_UPLOADS_PER_FRAME) > 0) {
+			pStagingRing->flush();
+			markCommandsDirty();
+		}
+
+		//the far field draw is only recorded once its buffer is in the table
+		if (pFarField->update()) {
+			pStagingRing->flush();
+			markCommandsDirty();
+		}
+	}
+
 	void App::drawFrame() {
 		//rendering a frame consits of these steps:
-		//wait for previous frame to finish
+		//wait for the frame slot to be free(the frame that used it framesInFlight frames ago)
 		//acquire an image from swapchain - gpu
 		//record a command buffer which draws the scene onto that image 
 		//submit the recorded command buffer(execute) - gpu
 		//present the swap chain image - gpu
 
-		//wait for previous frame draw sequence
-		//array of fences waits for one or all, also has timeout but max int basically disables it
-		assert(pInFlightFence->waitForFence(UINT64_MAX));
-		//reset it
-		assert(pInFlightFence->resetFence());
+		//every slot owns its own command buffer and semaphores
+		CommandBuffer* pCommandBuffer = pCommandBuffers[currentFrame];
+		Semaphore* pImageAvailableSemaphore = pImageAvailableSemaphores[currentFrame];
+		Semaphore* pRenderFinishedSemaphore = pRenderFinishedSemaphores[currentFrame];
+
+		if (pFrameProfiler != nullptr) {
+			pFrameProfiler->beginPhase(FrameProfiler::PHASE_FRAME);
+			pFrameProfiler->beginPhase(FrameProfiler::PHASE_FENCE_WAIT);
+		}
+
+		//wait for this slot's previous draw sequence, only blocks when the cpu laps the ring
+		//timeout to max int basically disables it
+		if (!pGraphicsQueue->waitForValue(slotSubmitValues[currentFrame], UINT64_MAX)) {
+			throw std::runtime_error("failed to wait for in flight frame!");
+		}
+
+		if (pFrameProfiler != nullptr) {
+			pFrameProfiler->endPhase(FrameProfiler::PHASE_FENCE_WAIT);
+			//slot is done on the gpu so its timestamps are ready
+			pFrameProfiler->collectGpuTime(currentFrame);
+			pFrameProfiler->beginPhase(FrameProfiler::PHASE_ACQUIRE);
+		}
+
+		//once every slot has been waited on since the last recreation nothing on the gpu uses the retired swapchain
+		if (pSwapChain->hasRetired() && frameNumber - retiredOnFrame >= framesInFlight) {
+			releaseRetiredSwapChain();
+		}
 
 		//acquire image from swapchain - gpu
 		//timeout to maxint to disable, it will sugnal the image available semaphore
-		uint32_t imageIndex = pSwapChain->nextImage(_device, pImageAvailableSemaphore->getSemaphore());
+		uint32_t imageIndex;
+		VkResult acquireResult = pSwapChain->nextImage(_device, pImageAvailableSemaphore->getSemaphore(), imageIndex);
+		if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR) {
+			//no image was acquired and the semaphore wont be signaled, nothing was submitted so the slot is still free
+			recreateSwapChain();
+			return;
+		}
+		//VK_SUBOPTIMAL_KHR still gives us an image, draw it and recreate after presenting
 
-		//record a command buffer which draws the scene onto that image 
-		//reset it to make sure can be drawn
-		pCommandBuffer->reset();
-		//starts pipeline and renderpass aiming at framebuffer[imageIndex] and adds draw command to buffer
-		pCommandBuffer->recordCommandBuffer(pSwapChainFramebuffers[imageIndex]->getFrameBuffer(), 
-											pRenderPass->getRenderPass(), pPipeline->getPipeline(), 
-											pSwapChain->getExtent());
+		if (pFrameProfiler != nullptr) {
+			pFrameProfiler->endPhase(FrameProfiler::PHASE_ACQUIRE);
+		}
+
+		//the image can come back out of order, if a different slot is still drawing to it we must wait for that frame
+		if (!pGraphicsQueue->waitForValue(imageSubmitValues[imageIndex], UINT64_MAX)) {
+			throw std::runtime_error("failed to wait for in flight frame!");
+		}
+
+		//a cached buffer can still be pending from another slot's frame(recreation keeps buffers but forgets image values)
+		if (cachedCommands && !pGraphicsQueue->waitForValue(imageCommandValues[imageIndex], UINT64_MAX)) {
+			throw std::runtime_error("failed to wait for in flight frame!");
+		}
+
+		if (pFrameProfiler != nullptr) {
+			pFrameProfiler->beginPhase(FrameProfiler::PHASE_RECORD);
+		}
+
+		VkExtent2D extent = pSwapChain->getExtent();
+		glm::mat4 viewProjection = pCamera->getViewProjection(static_cast<float>(extent.width) / static_cast<float>(extent.height));
+		//the image's region is free since its last frame is done, the uniforms are its first allocation so they always land at the same
+		//offset and a cached buffer replays with the new camera without being recorded again
+		pUniformRing->begin(imageIndex);
+		frameUniforms = pUniformRing->allocate(sizeof(FrameUniforms));
+		FrameUniforms* pFrameUniforms = static_cast<FrameUniforms*>(frameUniforms.pData);
+		pFrameUniforms->viewProjection = viewProjection;
+		pFrameUniforms->cameraPosition = glm::vec4(pCamera->getPosition(), 1.0f);
+		pFrameUniforms->time = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - startTime).count();
+		pFrameUniforms->pixelSpread = pCamera->getPixelSpread(extent.height);
+		pFrameUniforms->inverseViewProjection = glm::inverse(viewProjection);
+
+		//the image's last frame is done, so are its draw commands, cull into them on the compute queue
+		//it runs while this thread records(and next to the previous frame with async compute)
+		pWorld->sortMeshes(pCamera->getPosition());
+		const std::vector<ChunkMesh*>& pMeshes = pWorld->getMeshes();
+		pChunkCuller->cull(imageIndex, pMeshes, pWorld->getMeshVersion(), viewProjection);
+		VkQueryPool timestampQueryPool = pFrameProfiler != nullptr ? pFrameProfiler->getQueryPool() : VK_NULL_HANDLE;
+		uint32_t firstQuery = pFrameProfiler != nullptr ? pFrameProfiler->getFirstQuery(currentFrame) : 0;
+
+		//command buffers submitted this frame, in order
+		VkCommandBuffer submitCommandBuffers[3];
+		uint32_t submitCommandBufferCount = 0;
+
+		if (cachedCommands) {
+			//resubmitted as is unless something it recorded changed since
+			CommandBuffer* pImageCommandBuffer = pImageCommandBuffers[imageIndex];
+			if (imageRecordedVersions[imageIndex] != sceneVersion) {
+				pImageCommandBuffer->reset();
+				pImageCommandBuffer->recordGraph(pRenderGraphs[imageIndex], VK_NULL_HANDLE, 0);
+				imageRecordedVersions[imageIndex] = sceneVersion;
+			}
+
+			//timestamp queries belong to the slot not the image, they are written by small buffers around the cached one
+			if (timestampQueryPool != VK_NULL_HANDLE) {
+				pCommandBuffer->reset();
+				pCommandBuffer->recordTimestampBegin(timestampQueryPool, firstQuery);
+				submitCommandBuffers[submitCommandBufferCount++] = pCommandBuffer->getCommandBuffer();
+			}
+			submitCommandBuffers[submitCommandBufferCount++] = pImageCommandBuffer->getCommandBuffer();
+			if (timestampQueryPool != VK_NULL_HANDLE) {
+				pTimestampCommandBuffers[currentFrame]->reset();
+				pTimestampCommandBuffers[currentFrame]->recordTimestampEnd(timestampQueryPool, firstQuery);
+				submitCommandBuffers[submitCommandBufferCount++] = pTimestampCommandBuffers[currentFrame]->getCommandBuffer();
+			}
+		}
+		else {
+			//record a command buffer which draws the scene onto that image 
+			//reset it to make sure can be drawn
+			pCommandBuffer->reset();
+			//runs the image's render graph: the render pass aiming at framebuffer[imageIndex] with the draws, then the Hi-Z build
+			if (pParallelRecorder != nullptr) {
+				//draws are recorded by the workers, the primary only wraps them in the render pass
+				const std::vector<VkCommandBuffer>& secondaryCommandBuffers = pParallelRecorder->record(currentFrame,
+					pSwapChainFramebuffers[imageIndex]->getFrameBuffer(), pRenderPass->getRenderPass(), pPipeline->getDepthPrepassPipeline(),
+					pPipeline->getPipeline(), pPipeline->getFarFieldPipeline(), pPipeline->getPipelineLayout(), pBindlessTable, pUniformRing,
+					frameUniforms.region, frameUniforms.offset, extent, getPushConstants(), pChunkCuller, imageIndex);
+				pSceneSecondaryCommandBuffers = &secondaryCommandBuffers;
+				pCommandBuffer->recordGraph(pRenderGraphs[imageIndex], timestampQueryPool, firstQuery);
+				pSceneSecondaryCommandBuffers = nullptr;
+			}
+			else {
+				pCommandBuffer->recordGraph(pRenderGraphs[imageIndex], timestampQueryPool, firstQuery);
+			}
+			submitCommandBuffers[submitCommandBufferCount++] = pCommandBuffer->getCommandBuffer();
+		}
+
+		if (pFrameProfiler != nullptr) {
+			pFrameProfiler->endPhase(FrameProfiler::PHASE_RECORD);
+		}
 
 		//submit the recorded command buffer(execute) - gpu
 		VkSubmitInfo submitInfo{};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		VkSemaphore waitSemaphores[] = { pImageAvailableSemaphore->getSemaphore() };//which semaphore to wait on
-		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };//which stage of pipeline to wait on
+		VkSemaphore waitSemaphores[2] = { pImageAvailableSemaphore->getSemaphore() };//which semaphore to wait on
+		VkPipelineStageFlags waitStages[2] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };//which stage of pipeline to wait on
 		submitInfo.waitSemaphoreCount = 1;
+		//draws read the culled commands, only the indirect stage waits for the compute queue
+		std::vector<Queue::TimelineWait> timelineWaits;
+		if (pComputeQueue->hasTimeline()) {
+			timelineWaits.push_back(pChunkCuller->getTimelineWait(imageIndex));
+		}
+		else {
+			waitSemaphores[submitInfo.waitSemaphoreCount] = pChunkCuller->getCullFinished(imageIndex);
+			waitStages[submitInfo.waitSemaphoreCount++] = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+		}
 		//each index of each array corresponds to each other
 		submitInfo.pWaitSemaphores = waitSemaphores;
 		submitInfo.pWaitDstStageMask = waitStages;	
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = pCommandBuffer->getCommandBufferPointer();
+		submitInfo.commandBufferCount = submitCommandBufferCount;
+		submitInfo.pCommandBuffers = submitCommandBuffers;
 		//which semaphores to signal when done
 		VkSemaphore signalSemaphores[] = { pRenderFinishedSemaphore->getSemaphore() };
 		submitInfo.signalSemaphoreCount = 1;
 		submitInfo.pSignalSemaphores = signalSemaphores;
 
-		//ended here(add queue submit to queue object and fix queue structure thingy
-		pGraphicsQueue->submit(submitInfo, pInFlightFence);
+		if (pFrameProfiler != nullptr) {
+			pFrameProfiler->beginPhase(FrameProfiler::PHASE_SUBMIT);
+		}
+
+		//the value signaled by this frame is what the slot, the image and its cached buffer wait on next time
+		uint64_t frameValue = pGraphicsQueue->submit(submitInfo, timelineWaits);
+		slotSubmitValues[currentFrame] = frameValue;
+		imageSubmitValues[imageIndex] = frameValue;
+		pUniformRing->end(frameValue);
+		if (cachedCommands) {
+			imageCommandValues[imageIndex] = frameValue;
+		}
+
+		if (pFrameProfiler != nullptr) {
+			pFrameProfiler->endPhase(FrameProfiler::PHASE_SUBMIT);
+			pFrameProfiler->markSubmitted(currentFrame);
+			pFrameProfiler->beginPhase(FrameProfiler::PHASE_PRESENT);
+		}
 
 		//present the swap chain image - gpu
 		VkPresentInfoKHR presentInfo{};
@@ -124,19 +492,96 @@ namespace one {
 		presentInfo.pImageIndices = &imageIndex;//image we drew framebuffer to(index sync)
 		presentInfo.pResults = nullptr;
 
-		pPresentationQueue->present(presentInfo);
-		
+		VkResult presentResult = pPresentationQueue->present(presentInfo);
+
+		if (pFrameProfiler != nullptr) {
+			pFrameProfiler->endPhase(FrameProfiler::PHASE_PRESENT);
+			pFrameProfiler->endPhase(FrameProfiler::PHASE_FRAME);
+		}
+
+		//move on to the next slot of the ring
+		currentFrame = (currentFrame + 1) % framesInFlight;
+		frameNumber++;
+
+		if (presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR || 
+			acquireResult == VK_SUBOPTIMAL_KHR || pWindow->wasResized()) {
+			recreateSwapChain();
+		}
+	}
+
+	void App::startProfiling() {
+		if (pFrameProfiler == nullptr) {
+			pFrameProfiler = new FrameProfiler(_device, pDevice->getPhysicalGraphicsDevice(), pGraphicsQueue->getFamilyIndex(), framesInFlight);
+		}
+	}
+
+	void App::finishProfiling(const std::string& reportPath) {
+		if (pFrameProfiler == nullptr) {
+			return;
+		}
+		//every frame must be done so the last timestamps can be read
+		if (!pGraphicsQueue->waitForValue(pGraphicsQueue->getSubmittedValue(), UINT64_MAX)) {
+			throw std::runtime_error("failed to wait for in flight frame!");
+		}
+		pFrameProfiler->collectAllGpuTimes();
+		pFrameProfiler->writeReport(reportPath);
+
+		pFrameProfiler->destroy();
+		delete pFrameProfiler;
+		pFrameProfiler = nullptr;
 	}
 
 	void App::destroy() {
-		pImageAvailableSemaphore->destroy();
-		delete pImageAvailableSemaphore;
-		pRenderFinishedSemaphore->destroy();
-		delete pRenderFinishedSemaphore;
-		pInFlightFence->destroy();
-		delete pInFlightFence;
+		if (pFrameProfiler != nullptr) {
+			pFrameProfiler->destroy();
+			delete pFrameProfiler;
+			pFrameProfiler = nullptr;
+		}
 
-		pGraphicsQueue->destroy();
+		pChunkStreamer->destroy();
+		delete pChunkStreamer;
+		//waits for its jobs still running on the workers
+		pWorld->destroy();
+		delete pWorld;
+		pFarField->destroy();
+		delete pFarField;
+		delete pCamera;
+		pChunkCuller->destroy();
+		delete pChunkCuller;
+		if (pParallelRecorder != nullptr) {
+			pParallelRecorder->destroy();
+			delete pParallelRecorder;
+			pParallelRecorder = nullptr;
+		}
+		pJobSystem->destroy();
+		delete pJobSystem;
+		//waits for uploads still in flight
+		pStagingRing->destroy();
+		delete pStagingRing;
+
+		for (uint32_t i = 0; i < framesInFlight; i++) {
+			pImageAvailableSemaphores[i]->destroy();
+			delete pImageAvailableSemaphores[i];
+			pRenderFinishedSemaphores[i]->destroy();
+			delete pRenderFinishedSemaphores[i];
+			//freed with the command pool
+			delete pCommandBuffers[i];
+		}
+		for (auto pTimestampCommandBuffer : pTimestampCommandBuffers) {
+			delete pTimestampCommandBuffer;
+		}
+		for (auto pImageCommandBuffer : pImageCommandBuffers) {
+			delete pImageCommandBuffer;
+		}
+		pTimestampCommandBuffers.clear();
+		pImageCommandBuffers.clear();
+		imageCommandValues.clear();
+		imageRecordedVersions.clear();
+		pImageAvailableSemaphores.clear();
+		pRenderFinishedSemaphores.clear();
+		slotSubmitValues.clear();
+		pCommandBuffers.clear();
+		imageSubmitValues.clear();
 
 		for (auto framebuffer : pSwapChainFramebuffers) {
 			framebuffer->destroy();
@@ -144,24 +589,58 @@ namespace one {
 			delete framebuffer;
 		}
 		pSwapChainFramebuffers.clear();
+		//pyramids free their transition buffer to the compute queue's pool
+		for (auto pHiZPyramid : pHiZPyramids) {
+			pHiZPyramid->destroy();
+			delete pHiZPyramid;
+		}
+		pHiZPyramids.clear();
+		for (auto pRenderGraph : pRenderGraphs) {
+			pRenderGraph->destroy();
+			delete pRenderGraph;
+		}
+		pRenderGraphs.clear();
+		releaseRetiredSwapChain();
+
+		pHiZPipeline->destroy();
+		delete pHiZPipeline;
+
+		//waits on the graphics queue values of its regions
+		pUniformRing->destroy();
+		delete pUniformRing;
+
+		pGraphicsQueue->destroy();
+		pTransferQueue->destroy();
+		pComputeQueue->destroy();
 
 		pPipeline->destroy();
 		delete pPipeline;
 
+		pBindlessTable->destroy();
+		delete pBindlessTable;
+
+		//saves the cache to disk before destroying it
+		pPipelineCache->destroy();
+		delete pPipelineCache;
+
 		pRenderPass->destroy();
 		delete pRenderPass;
 
+		//surface outlives the swapchain, it is destroyed with the instance below
+		VkSurfaceKHR surface = pSwapChain->getSurface();
 		pSwapChain->destroy(_device);
 		delete pSwapChain;
 
 		//queue is only deleted close to device and can't be vkDestroyed
 		delete pGraphicsQueue;
 		delete pPresentationQueue;
+		delete pTransferQueue;
+		delete pComputeQueue;
 
 		pDevice->destroy();
 		delete pDevice;
 
-		assert(pWindow->destroySurface(pInstance->getInstance(), pSwapChain->getSurface()));
+		pWindow->destroySurface(pInstance->getInstance(), surface);
 
 		pInstance->destroy();
 		delete pInstance;
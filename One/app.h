@@ -3,13 +3,28 @@
 #include "UtilHeader.h"
 #include "Window.h"
 #include "Framebuffer.h"
+#include "RenderGraph.h"
+#include "HiZPyramid.h"
 #include "Pipeline.h"
+#include "BindlessTable.h"
+#include "UniformRing.h"
+#include "PipelineCache.h"
 #include "CommandBuffer.h"
+#include "ParallelRecorder.h"
+#include "ChunkCuller.h"
 #include "Device.h"
 #include "Instance.h"
 #include "RenderPass.h"
 #include "Semaphore.h"
 #include "Fence.h"
+#include "FrameProfiler.h"
+#include "StagingRing.h"
+#include "World.h"
+#include "ChunkStreamer.h"
+#include "FarField.h"
+#include "Camera.h"
+#include <string>
+#include <chrono>
 
 
 namespace one {
@@ -18,7 +33,11 @@ namespace one {
 
 	public:
 
-		App(Window* pWindow);
+		//parallelRecording records the draws into secondary buffers on the job system workers
+		//cachedCommands keeps one recorded buffer per swapchain image and only records it again when it is dirty
+		//(cached buffers are recorded inline, parallelRecording is ignored with it)
+		//streamingSettings: view distance and cache budget of the chunks streamed around the camera
+		App(Window* pWindow, uint32_t framesInFlight, bool parallelRecording, bool cachedCommands, const ChunkStreamer::Settings& streamingSettings);
 		void initialize();
 		void destroy();
 		~App();
@@ -29,8 +48,20 @@ namespace one {
 
 		
 		//action methods
+		//one tick of the world: requests chunks around the camera, evicts from the cache and uploads finished meshes
+		//never waits for the workers, call before drawFrame
+		void update();
 		void drawFrame();
 
+		//benchmarking: times every phase of drawFrame and the gpu render pass until finishProfiling
+		//writes the json report(stdout if reportPath is empty)
+		void startProfiling();
+		void finishProfiling(const std::string& reportPath);
+
+		inline size_t getProfiledFrameCount(void) const {
+			return pFrameProfiler != nullptr ? pFrameProfiler->getFrameCount() : 0;
+		}
+
 		//this is a manager/helper class it can't pass getters and setters to its objects but rather to its owners
 		inline VkDevice getDevice(void) const {
 			return _device;
@@ -39,9 +70,23 @@ namespace one {
 	private:
 
 		
+		//render graph(with the depth buffer), framebuffer and Hi-Z pyramid of every swapchain image
 		void initializeFrameBuffers();
-		void initializeCommandBuffer();
+		//scene pass of target's render graph, draws inline or executes pSceneSecondaryCommandBuffers
+		void recordScene(VkCommandBuffer commandBuffer, uint32_t target);
+		//table indices of the draws, the far field only once it is uploaded
+		PushConstants getPushConstants(void) const;
+		//rebuilds swapchain, its image views and the framebuffers without waiting on the device
+		void recreateSwapChain();
+		//destroys what recreateSwapChain retired once every frame slot has finished with it
+		void releaseRetiredSwapChain();
+		void initializeCommandBuffers();
+		//grows the cached buffers to the swapchain image count and marks all of them for recording
+		void initializeImageCommandBuffers();
+		//scene, pipeline or extent changed, cached buffers get recorded again before their next submit
+		void markCommandsDirty();
 		void initializeSyncObjects();
+		void initializeWorld();
 
 		Instance* pInstance;
 		Device* pDevice;
@@ -49,18 +94,85 @@ namespace one {
 		SwapChain* pSwapChain;
 		//pipeline ptr
 		Pipeline* pPipeline;
+		//every texture and buffer the graphics shaders read, bound once per command buffer
+		BindlessTable* pBindlessTable;
+		//camera and time of each frame, one region per swapchain image like the cached buffers that bind it
+		UniformRing* pUniformRing;
+		//shared by every pipeline creation and kept on disk between launches
+		PipelineCache* pPipelineCache;
 		RenderPass* pRenderPass;
 		//FrameBuffers(linked to eache image, where data will be written to)
 		std::vector<Framebuffer*> pSwapChainFramebuffers;
-		CommandBuffer* pCommandBuffer;
+		//passes of each swapchain image's frame, its depth is a transient image of the graph
+		std::vector<RenderGraph*> pRenderGraphs;
+		VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+		//farthest depth of each swapchain image's last frame, the culling of that image reads it
+		std::vector<HiZPyramid*> pHiZPyramids;
+		//builds every level of every pyramid
+		ComputePipeline* pHiZPipeline;
+		//framebuffers, render graphs and pyramids of retired swapchains, kept until frames that used them are done
+		std::vector<Framebuffer*> pRetiredFramebuffers;
+		std::vector<RenderGraph*> pRetiredRenderGraphs;
+		std::vector<HiZPyramid*> pRetiredHiZPyramids;
+		//frames drawn so far and frame on which the last swapchain got retired
+		uint64_t frameNumber = 0;
+		uint64_t retiredOnFrame = 0;
+		//Frame slots(each frame in flight owns its own command buffer and sync objects)
+		//cpu only waits when it laps the ring and reaches a slot the gpu hasnt finished yet
+		const uint32_t framesInFlight;
+		uint32_t currentFrame = 0;
+		std::vector<CommandBuffer*> pCommandBuffers;
+		//secondary buffers and per thread pools, only exists with parallel recording
+		const bool parallelRecording;
+		ParallelRecorder* pParallelRecorder{ nullptr };
+		//cached command mode: one buffer per swapchain image, recorded again only when it is older than sceneVersion
+		const bool cachedCommands;
+		std::vector<CommandBuffer*> pImageCommandBuffers;
+		std::vector<uint64_t> imageRecordedVersions;
+		//graphics queue value of the frame that submitted each cached buffer last(0 if never submitted)
+		std::vector<uint64_t> imageCommandValues;
+		//write the end timestamp of each slot in cached mode(the slot's own buffer writes the begin one)
+		std::vector<CommandBuffer*> pTimestampCommandBuffers;
+		uint64_t sceneVersion = 1;
+		//the frame uniforms of the image being recorded
+		UniformRing::Allocation frameUniforms{};
+		//FrameUniforms::time counts from here
+		std::chrono::high_resolution_clock::time_point startTime;
+		//secondary buffers the scene pass executes while a graph is recorded, nullptr draws inline
+		const std::vector<VkCommandBuffer>* pSceneSecondaryCommandBuffers = nullptr;
 		//Sync objects
-		Semaphore* pImageAvailableSemaphore;
-		Semaphore* pRenderFinishedSemaphore;
-		Fence* pInFlightFence;
+		std::vector<Semaphore*> pImageAvailableSemaphores;
+		std::vector<Semaphore*> pRenderFinishedSemaphores;
+		//graphics queue value of each slot's last frame, replaces a fence per slot(waiting never needs a reset)
+		std::vector<uint64_t> slotSubmitValues;
+		//graphics queue value of the last frame drawn to each swapchain image(0 if none)
+		std::vector<uint64_t> imageSubmitValues;
+
+		//only exists while benchmarking
+		FrameProfiler* pFrameProfiler{ nullptr };
+
+		//uploads into device local buffers
+		StagingRing* pStagingRing;
+		//workers for chunk generation and meshing
+		JobSystem* pJobSystem;
+		//chunks drawn every frame
+		World* pWorld;
+		//loads and unloads the chunks of pWorld around the camera
+		ChunkStreamer* pChunkStreamer;
+		const ChunkStreamer::Settings streamingSettings;
+		//terrain beyond the streamed chunks, drawn where they left the sky
+		FarField* pFarField;
+		Camera* pCamera;
+		//frustum culls the chunks on the compute queue into indirect draws, one target per swapchain image
+		ChunkCuller* pChunkCuller;
 			
 		//list of queues
 		Queue* pGraphicsQueue;
 		Queue* pPresentationQueue;
+		//same family as graphics unless the gpu has a transfer only family
+		Queue* pTransferQueue;
+		//same family as graphics unless the gpu has a compute only family(async compute)
+		Queue* pComputeQueue;
 
 
 		//Window pointer
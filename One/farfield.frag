@@ -0,0 +1,107 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+//Fragment shader: raymarches the far field dag(see SparseVoxelDag for the layout) from the camera through the pixel
+//every step walks down from the root to the box around the ray's position: an air box is skipped whole, a leaf block or a node
+//smaller than a pixel(drawn as its representative block) is the hit, no stack is kept between steps
+//pixels that hit nothing within MAX_STEPS boxes are discarded and keep the clear color
+//matches PushConstants in Pipeline.h
+layout(push_constant) uniform PushConstants {
+    uint materialBuffer;
+    uint farFieldBuffer;
+} pushConstants;
+
+//matches FrameUniforms in Pipeline.h
+layout(set = 1, binding = 0) uniform FrameUniforms {
+    mat4 viewProjection;
+    vec4 cameraPosition;
+    float time;
+    float pixelSpread;
+    mat4 inverseViewProjection;
+} frame;
+
+//bindless table(see BindlessTable), the dag and the materials(a vec4 color per block id, see Material in World.h) are both read as words
+layout(set = 0, binding = 1) readonly buffer Words {
+    uint words[];
+} buffers[];
+
+layout(location = 0) in vec2 inClip;
+
+layout(location = 0) out vec4 outColor;
+
+const int MAX_STEPS = 256;
+
+void main() {
+    uint dag = pushConstants.farFieldBuffer;
+    uint root = buffers[dag].words[0];
+    uint levels = buffers[dag].words[1];
+    vec3 minimum = vec3(ivec3(uvec3(buffers[dag].words[2], buffers[dag].words[3], buffers[dag].words[4])));
+    uint cubeSize = 1u << levels;
+
+    //through the near plane(depth 1 reversed), positions are relative to the first block of the cube
+    vec4 nearPoint = frame.inverseViewProjection * vec4(inClip, 1.0, 1.0);
+    vec3 origin = frame.cameraPosition.xyz - minimum;
+    vec3 direction = normalize(nearPoint.xyz * (1.0 / nearPoint.w) - frame.cameraPosition.xyz);
+    //box exits divide by it
+    direction = mix(direction, vec3(1e-6), lessThan(abs(direction), vec3(1e-6)));
+    vec3 inverseDirection = 1.0 / direction;
+
+    //the part of the ray inside the cube
+    vec3 t0 = (vec3(0.0) - origin) * inverseDirection;
+    vec3 t1 = (vec3(float(cubeSize)) - origin) * inverseDirection;
+    vec3 tNear = min(t0, t1);
+    vec3 tFar = max(t0, t1);
+    float t = max(max(max(tNear.x, tNear.y), tNear.z), 0.0);
+    float tExit = min(min(tFar.x, tFar.y), tFar.z);
+    //axis of the last face the ray went through, the face of the block it hits
+    uint axis = tNear.z > max(tNear.x, tNear.y) ? 2u : (tNear.y > tNear.x ? 1u : 0u);
+
+    uint block = 0u;
+    for (int step = 0; step < MAX_STEPS && t < tExit && block == 0u; step++) {
+        uvec3 cell = uvec3(clamp(ivec3(floor(origin + direction * t)), ivec3(0), ivec3(cubeSize - 1u)));
+        //what a pixel covers this far away
+        float lodSize = t * frame.pixelSpread;
+
+        uint node = root;
+        uint level = levels;
+        uint size = cubeSize;
+        while (node != 0u && level > 1u && float(size) > lodSize) {
+            size >>= 1;
+            level--;
+            uint child = ((cell.x & size) != 0u ? 1u : 0u) | ((cell.y & size) != 0u ? 2u : 0u) | ((cell.z & size) != 0u ? 4u : 0u);
+            node = buffers[dag].words[node + 1u + child];
+        }
+
+        if (node != 0u) {
+            if (level > 1u) {
+                block = buffers[dag].words[node];
+            }
+            else {
+                uint child = (cell.x & 1u) | ((cell.y & 1u) << 1) | ((cell.z & 1u) << 2);
+                block = (buffers[dag].words[node + (child >> 2)] >> ((child & 3u) * 8u)) & 255u;
+                //an air block of the leaf is skipped alone
+                size = 1u;
+            }
+        }
+
+        if (block == 0u) {
+            vec3 boxMinimum = vec3(cell & uvec3(0u - size));
+            vec3 boxExit = (boxMinimum + mix(vec3(0.0), vec3(float(size)), greaterThan(direction, vec3(0.0))) - origin) * inverseDirection;
+            float tNext = min(min(boxExit.x, boxExit.y), boxExit.z);
+            axis = boxExit.z < min(boxExit.x, boxExit.y) ? 2u : (boxExit.y < boxExit.x ? 1u : 0u);
+            //a little past the exit so the next step lands in the next box
+            t = tNext * 1.000001 + 0.001;
+        }
+    }
+
+    if (block == 0u) {
+        discard;
+    }
+
+    //same light as shader.vert: x faces 0.8, z faces 0.9, tops 1.0 and bottoms 0.5
+    uint material = block * 4u;
+    vec3 color = uintBitsToFloat(uvec3(buffers[pushConstants.materialBuffer].words[material],
+        buffers[pushConstants.materialBuffer].words[material + 1u], buffers[pushConstants.materialBuffer].words[material + 2u]));
+    float shade = axis == 0u ? 0.8 : (axis == 2u ? 0.9 : (direction.y < 0.0 ? 1.0 : 0.5));
+    outColor = vec4(color * shade, 1.0);
+}
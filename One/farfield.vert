@@ -0,0 +1,12 @@
+#version 450
+
+//Vertex shader: the far field triangle(see FarField), no vertex buffer, the vertex index picks the corner
+//(-1, -1), (3, -1), (-1, 3) cover the whole screen with one triangle
+//it lies on the far plane(depth 0, reversed), the depth test keeps it to the pixels no chunk was drawn to
+layout(location = 0) out vec2 outClip;
+
+void main() {
+    vec2 clip = vec2(float((gl_VertexIndex << 1) & 2), float(gl_VertexIndex & 2)) * 2.0 - 1.0;
+    outClip = clip;
+    gl_Position = vec4(clip, 0.0, 1.0);
+}
@@ -4,14 +4,81 @@
 #include <iostream>
 #include <stdexcept>
 #include <cstdlib>
+#include <string>
 
 
 
-int main() {
+//usage: One [--headless <frames>] [--readback <out.ppm>] [--golden <golden.ppm>]
+//           [--benchmark-frames <frames>] [--benchmark-seconds <seconds>] [--benchmark-output <report.json>]
+//           [--parallel-recording] [--cached-commands] [--view-distance <chunks>] [--chunk-cache-mb <megabytes>]
+//           [--lod-pixel-error <pixels>]
+int main(int argc, char* argv[]) {
     one::One one;
 
+    bool headless = false;
+    uint32_t frameCount = 0;
+    std::string readbackPath;
+    std::string goldenPath;
+    bool benchmark = false;
+    uint32_t benchmarkFrames = 0;
+    double benchmarkSeconds = 0.0;
+    std::string reportPath;
     try {
-        one.run();
+        for (int i = 1; i < argc; i++) {
+            std::string argument = argv[i];
+            if (argument == "--headless" && i + 1 < argc) {
+                headless = true;
+                frameCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (argument == "--readback" && i + 1 < argc) {
+                readbackPath = argv[++i];
+            }
+            else if (argument == "--golden" && i + 1 < argc) {
+                goldenPath = argv[++i];
+            }
+            else if (argument == "--benchmark-frames" && i + 1 < argc) {
+                benchmark = true;
+                benchmarkFrames = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (argument == "--benchmark-seconds" && i + 1 < argc) {
+                benchmark = true;
+                benchmarkSeconds = std::stod(argv[++i]);
+            }
+            else if (argument == "--benchmark-output" && i + 1 < argc) {
+                reportPath = argv[++i];
+            }
+            else if (argument == "--parallel-recording") {
+                one.setParallelRecording(true);
+            }
+            else if (argument == "--cached-commands") {
+                one.setCachedCommands(true);
+            }
+            else if (argument == "--view-distance" && i + 1 < argc) {
+                one.setViewDistance(std::stoi(argv[++i]));
+            }
+            else if (argument == "--chunk-cache-mb" && i + 1 < argc) {
+                one.setChunkCacheBudget(std::stoull(argv[++i]) * 1024 * 1024);
+            }
+            else if (argument == "--lod-pixel-error" && i + 1 < argc) {
+                one.setLodPixelError(std::stof(argv[++i]));
+            }
+            else {
+                std::cerr << "unknown argument: " << argument << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+
+        if (headless) {
+            if (!one.runHeadless(frameCount, readbackPath, goldenPath, reportPath)) {
+                return EXIT_FAILURE;
+            }
+        }
+        else if (benchmark) {
+            one.runBenchmark(benchmarkFrames, benchmarkSeconds, reportPath);
+        }
+        else {
+            one.run();
+        }
     }
     catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
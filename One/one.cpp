@@ -1,34 +1,82 @@
 #include "One.h"
+#include <chrono>
 
 namespace one {
 
     void One::run() {
         initOne();
-        loop();
+        loop(0, 0.0);
         end();
     }
 
+    void One::runBenchmark(uint32_t frameLimit, double secondsLimit, const std::string& reportPath) {
+        initOne();
+        pApp->startProfiling();
+        loop(frameLimit, secondsLimit);
+        pApp->finishProfiling(reportPath);
+        end();
+    }
+
+    bool One::runHeadless(uint32_t frameCount, const std::string& readbackPath, const std::string& goldenPath, const std::string& reportPath) {
+        //no glfw here, the headless app never creates a window or surface
+        HeadlessApp* pHeadlessApp = new HeadlessApp({ WIDTH, HEIGHT }, FRAMES_IN_FLIGHT, parallelRecording, cachedCommands);
+        std::cerr << "one has initiated headless \n";
+
+        pHeadlessApp->renderFrames(frameCount, reportPath);
+
+        bool passed = true;
+        if (!readbackPath.empty()) {
+            pHeadlessApp->readback(readbackPath);
+            if (!goldenPath.empty()) {
+                passed = HeadlessApp::compareWithGolden(readbackPath, goldenPath, GOLDEN_TOLERANCE);
+            }
+        }
+
+        vkDeviceWaitIdle(pHeadlessApp->getDevice());
+        pHeadlessApp->destroy();
+        delete pHeadlessApp;
+
+        std::cerr << "one has terminated \n";
+        return passed;
+    }
+
     void One::initOne() {
         //I probably will set App as a handler of all Vulkan Classes/objects 
         //and separate the bellow functions to other files as well as put everyting in a folder
         //so app can create and get set some items while runtime functions can be sent to each class
         //
         pWindow = new Window(WIDTH, HEIGHT, "One");
-        pApp = new App(pWindow);
+        pApp = new App(pWindow, FRAMES_IN_FLIGHT, parallelRecording, cachedCommands, streamingSettings);
         std::cerr << "one has initiated \n";
     }
 
-    void One::loop() {
+    void One::loop(uint32_t frameLimit, double secondsLimit) {
+        auto start = std::chrono::high_resolution_clock::now();
+        uint32_t frames = 0;
         while (!pWindow->shouldClose()) {//closes window if close
             glfwPollEvents();
+            //streaming only queues work for the workers, the frame is never held up by it
+            pApp->update();
             pApp->drawFrame();
-            
+            frames++;
+
+            //limits are only used when benchmarking
+            if (frameLimit > 0 && frames >= frameLimit) {
+                break;
+            }
+            if (secondsLimit > 0.0 && std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count() >= secondsLimit) {
+                break;
+            }
         }
         //wait until operations in command queue are finished
         vkDeviceWaitIdle(pApp->getDevice());
     };
 
     void One::end() {
+        //app has to go before the window, it saves the pipeline cache and destroys the surface
+        pApp->destroy();
+        delete pApp;
+        delete pWindow;
         std::cerr << "one has terminated \n";
     };
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "UtilHeader.h"
 #include "Window.h"
 #include "App.h"
+#include "HeadlessApp.h"
+#include <string>
 
 namespace one {
 
@@ -10,15 +12,50 @@ namespace one {
 	public:
 		const uint32_t WIDTH = 600;
 		const uint32_t HEIGHT = 600;
+		//how many frames the cpu can record ahead of the gpu(2 is double buffering)
+		const uint32_t FRAMES_IN_FLIGHT = 2;
+		//max difference per color channel allowed against a golden image
+		const uint32_t GOLDEN_TOLERANCE = 2;
 
 		void run();
+		//renders frameCount frames offscreen(no window or display needed) and reports timings,
+		//if readbackPath is set the final frame is saved there and compared to goldenPath when that is set too
+		//returns false if the golden comparison failed
+		bool runHeadless(uint32_t frameCount, const std::string& readbackPath, const std::string& goldenPath, const std::string& reportPath);
+		//runs the windowed render loop for frameLimit frames or secondsLimit seconds(whichever comes first, 0 is no limit)
+		//and writes per phase cpu and gpu timings as json(stdout if reportPath is empty)
+		void runBenchmark(uint32_t frameLimit, double secondsLimit, const std::string& reportPath);
+
+		//records draws into secondary command buffers on worker threads(must be set before running)
+		inline void setParallelRecording(bool enabled) {
+			parallelRecording = enabled;
+		}
+		//keeps recorded command buffers and submits them again until the scene, pipeline or extent changes
+		inline void setCachedCommands(bool enabled) {
+			cachedCommands = enabled;
+		}
+		//chunks meshed in each direction from the camera(windowed only, headless draws a fixed world)
+		inline void setViewDistance(int32_t chunks) {
+			streamingSettings.viewDistance = chunks;
+		}
+		//bytes of chunks and meshes kept loaded before the least recently seen chunks are unloaded
+		inline void setChunkCacheBudget(uint64_t bytes) {
+			streamingSettings.cacheBudget = bytes;
+		}
+		//pixels a distant chunk's coarser mesh may be off by on screen, 0 meshes every chunk at full detail
+		inline void setLodPixelError(float pixels) {
+			streamingSettings.maxPixelError = pixels;
+		}
 
 	private:
 		Window* pWindow;
 		App* pApp;
+		bool parallelRecording = false;
+		bool cachedCommands = false;
+		ChunkStreamer::Settings streamingSettings;
 
 		void initOne();
-		void loop();
+		void loop(uint32_t frameLimit, double secondsLimit);
 		void end();
 	};
 }
@@ -1,10 +1,12 @@
 #include "Pipeline.h"
+#include "ChunkCuller.h"
 #include <fstream>
+#include <chrono>
 
 
 namespace one {
-	Pipeline::Pipeline(VkDevice _device, VkRenderPass _renderPass): _device(_device){
-		initialize(_renderPass);
+	Pipeline::Pipeline(VkDevice _device, VkRenderPass _renderPass, VkDescriptorSetLayout bindlessLayout, VkDescriptorSetLayout frameLayout, PipelineCache* pPipelineCache): _device(_device){
+		initialize(_renderPass, bindlessLayout, frameLayout, pPipelineCache);
 	}
 
 	//read binary data from file
@@ -25,12 +27,16 @@ namespace one {
 		return buffer;
 	}
 
-	void Pipeline::initialize(VkRenderPass _renderPass) {
+	void Pipeline::initialize(VkRenderPass _renderPass, VkDescriptorSetLayout bindlessLayout, VkDescriptorSetLayout frameLayout, PipelineCache* pPipelineCache) {
 		auto vertShaderCode = readFile("shader.vert.spv");
 		auto fragShaderCode = readFile("shader.frag.spv");
+		auto farFieldVertShaderCode = readFile("farfield.vert.spv");
+		auto farFieldFragShaderCode = readFile("farfield.frag.spv");
 
 		VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
 		VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+		VkShaderModule farFieldVertShaderModule = createShaderModule(farFieldVertShaderCode);
+		VkShaderModule farFieldFragShaderModule = createShaderModule(farFieldFragShaderCode);
 
 		//assigns shader to pipeline stage(reference to pipeline diagram)
 		VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
@@ -54,16 +60,31 @@ namespace one {
 		VkPipelineShaderStageCreateInfo shaderStages[] = { 
 			vertShaderStageInfo, fragShaderStageInfo };
 
+		VkPipelineShaderStageCreateInfo farFieldShaderStages[] = {
+			vertShaderStageInfo, fragShaderStageInfo };
+		farFieldShaderStages[0].module = farFieldVertShaderModule;
+		farFieldShaderStages[1].module = farFieldFragShaderModule;
+
 		//*************************************************************************************
 		//Specifies BIndings(or if data is per vertex or per instance)
 		//instance is when a single mesh is duplicated and we refer to each type of duplicate by instance
-		//for now vertexes are hardcoded(change when buffers come in)
+		//vertices come from the mesh arena every chunk shares(see Vertex)
+		//the chunk origin is per instance, read from the culler's bounds at the draw's firstInstance
+		VkVertexInputBindingDescription bindingDescriptions[] = {
+			Vertex::getBindingDescription(), ChunkCuller::getInstanceBindingDescription() };
+		auto vertexAttributeDescriptions = Vertex::getAttributeDescriptions();
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions(vertexAttributeDescriptions.begin(), vertexAttributeDescriptions.end());
+		attributeDescriptions.push_back(ChunkCuller::getInstanceAttributeDescription());
 		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
 		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		vertexInputInfo.vertexBindingDescriptionCount = 0;
-		vertexInputInfo.pVertexBindingDescriptions = nullptr;//array of structs holding detail to load vertex data
-		vertexInputInfo.vertexAttributeDescriptionCount = 0;
-		vertexInputInfo.pVertexAttributeDescriptions = nullptr;//array of structs holding detail to load vertex data
+		vertexInputInfo.vertexBindingDescriptionCount = 2;
+		vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions;//array of structs holding detail to load vertex data
+		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+		vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();//array of structs holding detail to load vertex data
+
+		//the far field triangle is made from the vertex index alone
+		VkPipelineVertexInputStateCreateInfo farFieldVertexInputInfo{};
+		farFieldVertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
 		//*************************************************************************************
 		//What kind of geometry and if primitive restart is enabled
@@ -123,6 +144,9 @@ namespace one {
 		rasterizer.depthBiasConstantFactor = 0.0f;
 		rasterizer.depthBiasClamp = 0.0f;
 		rasterizer.depthBiasSlopeFactor = 0.0f;
+
+		VkPipelineRasterizationStateCreateInfo farFieldRasterizer = rasterizer;
+		farFieldRasterizer.cullMode = VK_CULL_MODE_NONE;
 		//*************************************************************************************
 		//Multisampling:one way to antialising - combining multiple poligon that rasterize to same pixel
 		//makes edges smooth
@@ -136,7 +160,24 @@ namespace one {
 		multisampling.alphaToOneEnable = VK_FALSE;
 		//*************************************************************************************
 		//depth and stencil testing - VkPipelineDepthStencilStateCreateInfo
-		//dont have one so pass nullptr;
+		//the prepass keeps the closest depth of every pixel, the color pass then only shades that exact surface
+		//depth is reversed(see Camera), closer is greater
+		//so every pixel runs the fragment shader once no matter how many faces overlap it
+		VkPipelineDepthStencilStateCreateInfo prepassDepthStencil{};
+		prepassDepthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		prepassDepthStencil.depthTestEnable = VK_TRUE;
+		prepassDepthStencil.depthWriteEnable = VK_TRUE;
+		prepassDepthStencil.depthCompareOp = VK_COMPARE_OP_GREATER;
+		prepassDepthStencil.depthBoundsTestEnable = VK_FALSE;
+		prepassDepthStencil.stencilTestEnable = VK_FALSE;
+
+		VkPipelineDepthStencilStateCreateInfo colorDepthStencil = prepassDepthStencil;
+		colorDepthStencil.depthWriteEnable = VK_FALSE;
+		colorDepthStencil.depthCompareOp = VK_COMPARE_OP_EQUAL;
+
+		//the far field triangle lies on the far plane(depth 0), EQUAL only keeps the pixels still at the clear value
+		//it writes no depth, so the early depth test rejects covered pixels before the raymarch runs
+		VkPipelineDepthStencilStateCreateInfo farFieldDepthStencil = colorDepthStencil;
 		//*************************************************************************************
 		//color blending - either mix old and new - or combine using bitwise operation (check vulkan spec)
 		//for multiple frame buffers, there is per attached state color blend
@@ -183,15 +224,29 @@ namespace one {
 		colorBlending.blendConstants[1] = 0.0f;
 		colorBlending.blendConstants[2] = 0.0f;
 		colorBlending.blendConstants[3] = 0.0f;
+
+		//the prepass has no fragment shader, it must not touch the color attachment
+		VkPipelineColorBlendAttachmentState prepassBlendAttachment = colorBlendAttachment;
+		prepassBlendAttachment.colorWriteMask = 0;
+		VkPipelineColorBlendStateCreateInfo prepassBlending = colorBlending;
+		prepassBlending.pAttachments = &prepassBlendAttachment;
 		//*************************************************************************************
 		//these uniform and push values in shaders are dynamic globals that can be passed
 		//(at drwaing time)to modify shader behavior
+		//push constants are the cheapest way to pass small per draw data(table indices)
+		//per frame data comes from the uniform ring at a dynamic offset, everything else from the bindless table
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(PushConstants);
+
 		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
 		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutInfo.setLayoutCount = 0;
-		pipelineLayoutInfo.pSetLayouts = nullptr;
-		pipelineLayoutInfo.pushConstantRangeCount = 0;
-		pipelineLayoutInfo.pPushConstantRanges = nullptr;
+		VkDescriptorSetLayout setLayouts[] = { bindlessLayout, frameLayout };
+		pipelineLayoutInfo.setLayoutCount = 2;
+		pipelineLayoutInfo.pSetLayouts = setLayouts;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
 		if (vkCreatePipelineLayout(_device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create pipeline layout!");
@@ -207,7 +262,7 @@ namespace one {
 		pipelineInfo.pViewportState = &viewportState;
 		pipelineInfo.pRasterizationState = &rasterizer;
 		pipelineInfo.pMultisampleState = &multisampling;
-		pipelineInfo.pDepthStencilState = nullptr;
+		pipelineInfo.pDepthStencilState = &colorDepthStencil;
 		pipelineInfo.pColorBlendState = &colorBlending;
 		pipelineInfo.pDynamicState = &dynamicState;
 		//
@@ -221,15 +276,39 @@ namespace one {
 		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;//VK_PIPELINE_CREATE_DERIVATIVE_BIT has to be active if so
 		pipelineInfo.basePipelineIndex = -1;
 
-		//null handle here is pipeline cache data to store to file or temporary memory so next pipeline creations are faster
-		if (vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
+		//same state, vertex stage only
+		VkGraphicsPipelineCreateInfo prepassPipelineInfo = pipelineInfo;
+		prepassPipelineInfo.stageCount = 1;
+		prepassPipelineInfo.pDepthStencilState = &prepassDepthStencil;
+		prepassPipelineInfo.pColorBlendState = &prepassBlending;
+
+		//same layout and blending, its own shaders, no vertex input and no culling
+		VkGraphicsPipelineCreateInfo farFieldPipelineInfo = pipelineInfo;
+		farFieldPipelineInfo.pStages = farFieldShaderStages;
+		farFieldPipelineInfo.pVertexInputState = &farFieldVertexInputInfo;
+		farFieldPipelineInfo.pRasterizationState = &farFieldRasterizer;
+		farFieldPipelineInfo.pDepthStencilState = &farFieldDepthStencil;
+
+		//pipeline cache data is stored to file so next pipeline creations(and launches) are faster
+		VkGraphicsPipelineCreateInfo pipelineInfos[] = { prepassPipelineInfo, pipelineInfo, farFieldPipelineInfo };
+		VkPipeline pipelines[3];
+		auto creationStart = std::chrono::high_resolution_clock::now();
+		if (vkCreateGraphicsPipelines(_device, pPipelineCache->getPipelineCache(), 3, pipelineInfos, nullptr, pipelines) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create graphics pipeline!");
 		}
+		depthPrepassPipeline = pipelines[0];
+		pipeline = pipelines[1];
+		farFieldPipeline = pipelines[2];
+		double creationMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - creationStart).count();
+		pPipelineCache->recordCreation(creationMilliseconds);
+		std::cerr << "vulkan pipelines took " << creationMilliseconds << " ms to create \n";
 
 		//*************************************************************************************
 		//we can destroy them as they have been passed to the pipeline and linked to the GPU already
 		vkDestroyShaderModule(_device, fragShaderModule, nullptr);
 		vkDestroyShaderModule(_device, vertShaderModule, nullptr);
+		vkDestroyShaderModule(_device, farFieldFragShaderModule, nullptr);
+		vkDestroyShaderModule(_device, farFieldVertShaderModule, nullptr);
 
 		std::cerr << "vulkan pipeline has initiated \n";
 	}
@@ -252,10 +331,18 @@ namespace one {
 	}
 
 	void Pipeline::destroy() {
+		if (depthPrepassPipeline != VK_NULL_HANDLE) {
+			vkDestroyPipeline(_device, depthPrepassPipeline, nullptr);
+			depthPrepassPipeline = VK_NULL_HANDLE;
+		}
 		if (pipeline != VK_NULL_HANDLE) {
 			vkDestroyPipeline(_device, pipeline, nullptr);
 			pipeline = VK_NULL_HANDLE;
 		}
+		if (farFieldPipeline != VK_NULL_HANDLE) {
+			vkDestroyPipeline(_device, farFieldPipeline, nullptr);
+			farFieldPipeline = VK_NULL_HANDLE;
+		}
 		if (pipelineLayout != VK_NULL_HANDLE) {
 			vkDestroyPipelineLayout(_device, pipelineLayout, nullptr);
 			pipelineLayout = VK_NULL_HANDLE;
@@ -1,18 +1,49 @@
 #pragma once
 #include "UtilHeader.h"
+#include "PipelineCache.h"
+#include "MeshArena.h"
 
 namespace one {
+	//farFieldBuffer when there is no far field to draw
+	static const uint32_t NO_FAR_FIELD = UINT32_MAX;
+
+	//push constants of shader.vert and farfield.frag(128 bytes is the most every gpu has to support)
+	//resources are not bound per draw, the shaders pick them from the bindless table by these indices
+	struct PushConstants {
+		//buffer index of the block materials(see World::getMaterialBuffer)
+		uint32_t materialBuffer;
+		//buffer index of the far field dag(see FarField::getBuffer), NO_FAR_FIELD skips its draw
+		uint32_t farFieldBuffer;
+	};
+
+	//uniforms of shader.vert and farfield.frag(std140), allocated from the uniform ring every frame and bound as set 1
+	struct FrameUniforms {
+		glm::mat4 viewProjection;
+		glm::vec4 cameraPosition;
+		//seconds since the start
+		float time;
+		//angle a pixel covers(radians), far field nodes smaller than a pixel are not walked down
+		float pixelSpread;
+		//std140 aligns the matrix to 16 bytes
+		float padding[2];
+		//clip space back to world space, the far field builds its rays with it
+		glm::mat4 inverseViewProjection;
+	};
+
+	//the chunk pipelines: a depth prepass writing only depth, then the color pass shading what is left(depth EQUAL)
+	//both share the layout(the bindless table as set 0, the uniform ring as set 1 and PushConstants) and vertex input, shader.vert has an invariant position so both passes get the same depth
+	//last the far field pipeline: a fullscreen triangle on the far plane, tested EQUAL against the cleared depth so only pixels no chunk covered raymarch the far field
 	class Pipeline : NonCopyable{
 
 	public:
 		Pipeline(const Pipeline&) = delete;//cant pass by reference
 		Pipeline& operator=(const Pipeline&) = delete;//cant copy by reference;
 		
-		Pipeline(VkDevice _device, VkRenderPass _renderPass);
+		Pipeline(VkDevice _device, VkRenderPass _renderPass, VkDescriptorSetLayout bindlessLayout, VkDescriptorSetLayout frameLayout, PipelineCache* pPipelineCache);
 		~Pipeline();
 
 		//constructors
-		void initialize(VkRenderPass _renderPass);
+		void initialize(VkRenderPass _renderPass, VkDescriptorSetLayout bindlessLayout, VkDescriptorSetLayout frameLayout, PipelineCache* pPipelineCache);
 
 		//destructors
 		void destroy();
@@ -21,12 +52,28 @@ namespace one {
 		inline VkPipeline getPipeline(void) const {
 			return pipeline;
 		}
+
+		inline VkPipeline getDepthPrepassPipeline(void) const {
+			return depthPrepassPipeline;
+		}
+
+		inline VkPipeline getFarFieldPipeline(void) const {
+			return farFieldPipeline;
+		}
+
+		inline VkPipelineLayout getPipelineLayout(void) const {
+			return pipelineLayout;
+		}
 		
 	private:
 		
 		VkDevice _device;
 
-		VkPipeline pipeline;
+		VkPipeline pipeline{ VK_NULL_HANDLE };
+
+		VkPipeline depthPrepassPipeline{ VK_NULL_HANDLE };
+
+		VkPipeline farFieldPipeline{ VK_NULL_HANDLE };
 
 		VkPipelineLayout pipelineLayout;
 
@@ -1,4 +1,5 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 //Vertex shader: proccess incoming vertex(world position, color, normal, texture cordinates)
 //output is the position in clip cordinates(screen) and atributes for fragment shader(color, texture cordinates)
@@ -6,21 +7,49 @@
 //[-1,-1]       [1,-1]
 //
 //[-1, 1]       [1, 1]
+//matches PushConstants in Pipeline.h
+layout(push_constant) uniform PushConstants {
+    //index in the bindless buffer array
+    uint materialBuffer;
+} pushConstants;
+
+//matches FrameUniforms in Pipeline.h, written every frame into the uniform ring(see UniformRing)
+layout(set = 1, binding = 0) uniform FrameUniforms {
+    mat4 viewProjection;
+    vec4 cameraPosition;
+    float time;
+} frame;
+
+//matches Material in World.h
+struct Material {
+    vec4 color;
+};
+
+//bindless table(see BindlessTable), buffers are picked by index and every draw picks the same one(dynamically uniform)
+layout(set = 0, binding = 1) readonly buffer Materials {
+    Material materials[];
+} buffers[];
+
+//packed voxel vertex(see Vertex in MeshArena.h)
+layout(location = 0) in uint inPacked;
+//per instance, the minimum of the chunk's bounds(see ChunkCuller)
+layout(location = 1) in vec3 inChunkOrigin;
+
 layout(location = 0) out vec3 fragColor;
 
-vec2 positions[3] = vec2[](
-    vec2(0.0, -0.5),
-    vec2(0.5, 0.5),
-    vec2(-0.5, 0.5)
-);
+//the depth prepass and the color pass(depth EQUAL) run this shader in different pipelines, both must get the exact same depth
+invariant gl_Position;
 
-vec3 colors[3] = vec3[](
-    vec3(1.0, 0.0, 0.0),
-    vec3(0.0, 1.0, 0.0),
-    vec3(0.0, 0.0, 1.0)
-);
+//cheap directional light, indexed by face(-x, +x, -y, +y, -z, +z)
+const float faceShades[6] = float[](0.8, 0.8, 0.5, 1.0, 0.9, 0.9);
 
 void main() {
-    gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);
-    fragColor = colors[gl_VertexIndex];
-}
\ No newline at end of file
+    vec3 localPosition = vec3(inPacked & 63u, (inPacked >> 6) & 63u, (inPacked >> 12) & 63u);
+    uint face = (inPacked >> 18) & 7u;
+    uint block = (inPacked >> 21) & 255u;
+
+    vec3 worldPosition = inChunkOrigin + localPosition;
+    gl_Position = frame.viewProjection * vec4(worldPosition, 1.0);
+    //every block id has a material(air never gets a face)
+    fragColor = buffers[pushConstants.materialBuffer].materials[block].color.rgb * faceShades[face];
+}
@@ -9,10 +9,13 @@ namespace one {
     void Window::initialize() {
         glfwInit();
         glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-        glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE); //will take out later(needs work)
+        glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
 
         //3rd parameter allas to set a specific monitor to open window on
         window = glfwCreateWindow(WIDTH, HEIGHT, windowName.c_str(), nullptr, nullptr);
+        //lets the static callback find this object
+        glfwSetWindowUserPointer(window, this);
+        glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
 
         std::cerr << "window has initiated \n";
     }
@@ -40,6 +43,12 @@ namespace one {
         return glfwGetFramebufferSize(window, &width, &height);
     }
 
+    void Window::framebufferResizeCallback(GLFWwindow* window, int width, int height) {
+        //not every platform sends out of date on resize so we flag it ourselves
+        auto pWindow = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window));
+        pWindow->framebufferResized = true;
+    }
+
     Window::~Window() {
         glfwDestroyWindow(window);
         glfwTerminate();
@@ -18,6 +18,15 @@ namespace one {
 		bool destroySurface(const VkInstance instance, VkSurfaceKHR surface);
 		void getFramebufferSize(int& width, int& height);
 
+		//true when the framebuffer changed size since last reset(resize, fullscreen toggle, display change)
+		inline bool wasResized() const {
+			return framebufferResized;
+		}
+
+		inline void resetResized() {
+			framebufferResized = false;
+		}
+
 		GLFWwindow* getWindow() const{
 			return window;
 		}
@@ -25,6 +34,10 @@ namespace one {
 	private:
 		void initialize();
 
+		//glfw calls this with the window, we get our object back through the user pointer
+		static void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+		bool framebufferResized = false;
+
 		const uint32_t WIDTH;
 		const uint32_t HEIGHT;
 		std::string windowName;